@@ -172,6 +172,16 @@ extern void (*MEM_reset_peak_memory)(void);
 /** Get the peak memory usage in bytes, including `mmap` allocations. */
 extern size_t (*MEM_get_peak_memory)(void) ATTR_WARN_UNUSED_RESULT;
 
+/**
+ * Memory usage of the calling thread: the size of all blocks it allocated minus the size of all
+ * blocks it freed. This can be negative, when the thread frees memory allocated by other threads.
+ * The difference of two calls measures the memory allocated by the code that ran in between on
+ * the same thread. This is lock-free, unlike #MEM_get_memory_in_use.
+ *
+ * Always zero with the guarded allocator, which does not track memory per thread.
+ */
+extern int64_t (*MEM_get_thread_memory_in_use)(void) ATTR_WARN_UNUSED_RESULT;
+
 #ifdef __GNUC__
 #  define MEM_SAFE_FREE(v) \
     do { \
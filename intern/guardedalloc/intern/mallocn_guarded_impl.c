@@ -1177,6 +1177,12 @@ size_t MEM_guarded_get_memory_in_use(void)
   return _mem_in_use;
 }
 
+int64_t MEM_guarded_get_thread_memory_in_use(void)
+{
+  /* Memory is only counted globally. */
+  return 0;
+}
+
 uint MEM_guarded_get_memory_blocks_in_use(void)
 {
   uint _totblock;
@@ -94,6 +94,7 @@ void memory_usage_block_alloc(size_t size);
 void memory_usage_block_free(size_t size);
 size_t memory_usage_block_num(void);
 size_t memory_usage_current(void);
+int64_t memory_usage_current_thread(void);
 size_t memory_usage_peak(void);
 void memory_usage_peak_reset(void);
 
@@ -136,6 +137,7 @@ size_t MEM_lockfree_get_memory_in_use(void);
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void);
 void MEM_lockfree_reset_peak_memory(void);
 size_t MEM_lockfree_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+int64_t MEM_lockfree_get_thread_memory_in_use(void) ATTR_WARN_UNUSED_RESULT;
 #ifndef NDEBUG
 const char *MEM_lockfree_name_ptr(void *vmemh);
 void MEM_lockfree_name_ptr_set(void *vmemh, const char *str);
@@ -180,6 +182,7 @@ size_t MEM_guarded_get_memory_in_use(void);
 unsigned int MEM_guarded_get_memory_blocks_in_use(void);
 void MEM_guarded_reset_peak_memory(void);
 size_t MEM_guarded_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+int64_t MEM_guarded_get_thread_memory_in_use(void) ATTR_WARN_UNUSED_RESULT;
 #ifndef NDEBUG
 const char *MEM_guarded_name_ptr(void *vmemh);
 void MEM_guarded_name_ptr_set(void *vmemh, const char *str);
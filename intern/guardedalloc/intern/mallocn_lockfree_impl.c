@@ -396,6 +396,11 @@ size_t MEM_lockfree_get_peak_memory(void)
   return memory_usage_peak();
 }
 
+int64_t MEM_lockfree_get_thread_memory_in_use(void)
+{
+  return memory_usage_current_thread();
+}
+
 #ifndef NDEBUG
 const char *MEM_lockfree_name_ptr(void *vmemh)
 {
@@ -250,6 +250,15 @@ size_t memory_usage_current()
   return size_t(mem_in_use);
 }
 
+int64_t memory_usage_current_thread()
+{
+  if (!use_local_counters.load(std::memory_order_relaxed)) {
+    return 0;
+  }
+  /* Only the calling thread modifies its counter, so there is no need to lock the global list. */
+  return get_local_data().mem_in_use.load(std::memory_order_relaxed);
+}
+
 /**
  * Get the approximate peak memory usage since the last call to #memory_usage_peak_reset.
  * This is approximate, because the peak usage is not updated after every allocation (see
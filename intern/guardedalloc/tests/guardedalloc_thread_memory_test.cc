@@ -0,0 +1,36 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <thread>
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "guardedalloc_test_base.h"
+
+TEST_F(LockFreeAllocatorTest, MEM_get_thread_memory_in_use)
+{
+  const int64_t start = MEM_get_thread_memory_in_use();
+  void *mem = MEM_mallocN(1000, __func__);
+  EXPECT_EQ(MEM_get_thread_memory_in_use() - start, 1000);
+
+  /* Allocations of other threads are not counted. */
+  void *other_mem = nullptr;
+  std::thread thread([&]() { other_mem = MEM_mallocN(5000, __func__); });
+  thread.join();
+  EXPECT_EQ(MEM_get_thread_memory_in_use() - start, 1000);
+
+  /* Freeing memory of another thread decreases the usage of the freeing thread. */
+  MEM_freeN(other_mem);
+  EXPECT_EQ(MEM_get_thread_memory_in_use() - start, -4000);
+
+  MEM_freeN(mem);
+  EXPECT_EQ(MEM_get_thread_memory_in_use() - start, -5000);
+}
+
+TEST_F(GuardedAllocatorTest, MEM_get_thread_memory_in_use)
+{
+  void *mem = MEM_mallocN(1000, __func__);
+  EXPECT_EQ(MEM_get_thread_memory_in_use(), 0);
+  MEM_freeN(mem);
+}
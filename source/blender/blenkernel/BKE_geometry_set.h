@@ -31,6 +31,12 @@ void BKE_geometry_set_free(struct GeometrySet *geometry_set);
 
 bool BKE_object_has_geometry_set_instances(const struct Object *ob);
 
+/**
+ * Wait until all geometry cache files that are written in the background are finished.
+ * Called on exit.
+ */
+void BKE_geometry_cache_exit(void);
+
 #ifdef __cplusplus
 }
 #endif
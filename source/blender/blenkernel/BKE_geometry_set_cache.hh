@@ -0,0 +1,76 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Storage of evaluated geometry sets in files on disk, so that expensive procedural results
+ * (e.g. of a geometry nodes modifier) can be reused without evaluating them again.
+ *
+ * The file format is a compact binary dump of the component data and their attributes. It uses
+ * the native byte order and struct layout of the platform, since cache files are only meant to
+ * be read again by the same build that wrote them. Files are memory-mapped when they are read.
+ *
+ * Supported components are meshes, curves, point clouds and instances (including nested
+ * instanced geometry). Anonymous attributes, volumes and edit hints are not stored. Data-blocks
+ * referenced by the geometry (materials, instanced objects and collections) are stored by name.
+ */
+
+#include <optional>
+#include <string>
+
+#include "BLI_function_ref.hh"
+#include "BLI_string_ref.hh"
+
+#include "DNA_ID_enums.h"
+
+struct GeometrySet;
+struct ID;
+
+namespace blender::bke {
+
+/**
+ * Find the data-block that should be referenced by a geometry read from a cache file.
+ * \param name: The name of the data-block, without the ID code prefix.
+ */
+using GeometryCacheIDResolver = FunctionRef<ID *(ID_Type id_type, StringRef name)>;
+
+/**
+ * Check whether all the data in the geometry can be stored in a cache file.
+ */
+bool geometry_cache_supports(const GeometrySet &geometry);
+
+/**
+ * Write the geometry to a cache file. The file is first written to a temporary location and then
+ * moved, so that a partially written file is never read.
+ * \param key: Identifies the state the geometry was computed from, see #geometry_cache_read.
+ * \return False when the geometry is not supported or the file could not be written.
+ */
+bool geometry_cache_write(const GeometrySet &geometry, StringRefNull filepath, uint64_t key);
+
+/**
+ * Same as #geometry_cache_write, but the file is written in the background, so that the caller
+ * does not have to wait for it. The data is still copied from the geometry before returning.
+ * Nothing is written when a file with the same path is still being written.
+ * Pending files are finished in #BKE_geometry_cache_exit.
+ */
+void geometry_cache_write_async(const GeometrySet &geometry, std::string filepath, uint64_t key);
+
+/**
+ * Compute a hash of all the data in the geometry that is stored in cache files, including
+ * anonymous attributes. Can be used to detect changes of a geometry that a cached result is
+ * computed from.
+ */
+uint64_t geometry_cache_hash(const GeometrySet &geometry);
+
+/**
+ * Read a geometry from a cache file written by #geometry_cache_write.
+ * \return None when the file does not exist, is invalid or was written with a different key.
+ * Corrupt or truncated files are detected and treated as invalid.
+ */
+std::optional<GeometrySet> geometry_cache_read(StringRefNull filepath,
+                                               uint64_t key,
+                                               GeometryCacheIDResolver id_resolver);
+
+}  // namespace blender::bke
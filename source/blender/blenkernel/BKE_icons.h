@@ -174,6 +174,17 @@ bool BKE_previewimg_id_supports_jobs(const struct ID *id);
  */
 void BKE_previewimg_id_custom_set(struct ID *id, const char *filepath);
 
+/**
+ * Replace the preview of a linked ID by a deferred one, loaded from its library file when it's
+ * first drawn. Used on file read to avoid keeping the previews of all linked IDs in memory.
+ */
+void BKE_previewimg_id_library_deferred_set(struct ID *id);
+
+/**
+ * Load all sizes of a deferred preview of \a id, e.g. before it becomes local and gets saved.
+ */
+void BKE_previewimg_id_deferred_load(struct ID *id);
+
 /**
  * Free the preview image belonging to the id.
  */
@@ -496,7 +496,10 @@ void BKE_lib_override_library_main_unused_cleanup(struct Main *bmain);
  */
 void BKE_lib_override_library_update(struct Main *bmain, struct ID *local);
 /**
- * Update all overrides from given \a bmain.
+ * Update all overrides from given \a bmain, after it was read from a file.
+ *
+ * Overrides whose reference data did not change since the file was saved are skipped, see
+ * #IDOverrideLibrary.reference_data_hash.
  */
 void BKE_lib_override_library_main_update(struct Main *bmain);
 
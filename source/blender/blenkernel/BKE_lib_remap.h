@@ -158,6 +158,14 @@ void BKE_libblock_relink_multiple(struct Main *bmain,
 void BKE_libblock_relink_to_newid(struct Main *bmain, struct ID *id, int remap_flag)
     ATTR_NONNULL();
 
+/**
+ * Same as #BKE_libblock_relink_to_newid, but for a whole set of IDs at once, so that the
+ * post-processing of the remapping (collections and view-layers resync, etc.) is only done once.
+ */
+void BKE_libblock_relink_to_newid_multiple(struct Main *bmain,
+                                           struct LinkNode *ids,
+                                           int remap_flag) ATTR_NONNULL(1);
+
 typedef void (*BKE_library_free_notifier_reference_cb)(const void *);
 typedef void (*BKE_library_remap_editor_id_reference_cb)(const struct IDRemapper *mappings);
 
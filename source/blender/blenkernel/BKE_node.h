@@ -36,6 +36,7 @@ struct BlendWriter;
 struct FreestyleLineStyle;
 struct GPUMaterial;
 struct GPUNodeStack;
+struct GSet;
 struct ID;
 struct ImBuf;
 struct Light;
@@ -507,6 +508,11 @@ struct bNode *ntreeFindType(struct bNodeTree *ntree, int type);
 bool ntreeHasTree(const struct bNodeTree *ntree, const struct bNodeTree *lookup);
 void ntreeUpdateAllNew(struct Main *main);
 void ntreeUpdateAllUsers(struct Main *main, struct ID *id);
+/**
+ * Same as #ntreeUpdateAllUsers for all IDs in the set, but only loops over the node trees and
+ * updates the main database once.
+ */
+void ntreeUpdateAllUsersMultiple(struct Main *main, const struct GSet *ids);
 
 /**
  * XXX: old trees handle output flags automatically based on special output
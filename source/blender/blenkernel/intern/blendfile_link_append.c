@@ -410,22 +410,28 @@ static bool object_in_any_scene(Main *bmain, Object *ob)
   return false;
 }
 
-static bool object_in_any_collection(Main *bmain, Object *ob)
+/* Gather all objects that are directly in any collection (including scenes' master ones), so
+ * that instantiation of many objects does not have to loop over all collections for each of
+ * them. */
+static GSet *objects_in_any_collection_gset(Main *bmain)
 {
+  GSet *objects = BLI_gset_ptr_new(__func__);
   LISTBASE_FOREACH (Collection *, collection, &bmain->collections) {
-    if (BKE_collection_has_object(collection, ob)) {
-      return true;
+    LISTBASE_FOREACH (CollectionObject *, coll_ob, &collection->gobject) {
+      BLI_gset_add(objects, coll_ob->ob);
     }
   }
 
   LISTBASE_FOREACH (Scene *, scene, &bmain->scenes) {
-    if (scene->master_collection != NULL &&
-        BKE_collection_has_object(scene->master_collection, ob)) {
-      return true;
+    if (scene->master_collection == NULL) {
+      continue;
+    }
+    LISTBASE_FOREACH (CollectionObject *, coll_ob, &scene->master_collection->gobject) {
+      BLI_gset_add(objects, coll_ob->ob);
     }
   }
 
-  return false;
+  return objects;
 }
 
 static bool collection_instantiated_by_any_object(Main *bmain, Collection *collection)
@@ -490,14 +496,10 @@ static void loose_data_instantiate_ensure_active_collection(
   }
 }
 
-static void loose_data_instantiate_object_base_instance_init(Main *bmain,
-                                                             Collection *collection,
-                                                             Object *ob,
-                                                             const Scene *scene,
-                                                             ViewLayer *view_layer,
-                                                             const View3D *v3d,
-                                                             const int flag,
-                                                             bool set_active)
+static void loose_data_instantiate_object_collection_add(Main *bmain,
+                                                         Collection *collection,
+                                                         Object *ob,
+                                                         const int flag)
 {
   /* Auto-select and appending. */
   if ((flag & FILE_AUTOSELECT) && ((flag & FILE_LINK) == 0)) {
@@ -507,6 +509,15 @@ static void loose_data_instantiate_object_base_instance_init(Main *bmain,
   }
 
   BKE_collection_object_add(bmain, collection, ob);
+}
+
+static void loose_data_instantiate_object_base_init(Object *ob,
+                                                    const Scene *scene,
+                                                    ViewLayer *view_layer,
+                                                    const View3D *v3d,
+                                                    const int flag,
+                                                    bool set_active)
+{
   BKE_view_layer_synced_ensure(scene, view_layer);
   Base *base = BKE_view_layer_base_find(view_layer, ob);
 
@@ -529,6 +540,39 @@ static void loose_data_instantiate_object_base_instance_init(Main *bmain,
   BKE_scene_object_base_flag_sync_from_base(base);
 }
 
+static void loose_data_instantiate_object_base_instance_init(Main *bmain,
+                                                             Collection *collection,
+                                                             Object *ob,
+                                                             const Scene *scene,
+                                                             ViewLayer *view_layer,
+                                                             const View3D *v3d,
+                                                             const int flag,
+                                                             bool set_active)
+{
+  loose_data_instantiate_object_collection_add(bmain, collection, ob, flag);
+  loose_data_instantiate_object_base_init(ob, scene, view_layer, v3d, flag, set_active);
+}
+
+/* Initialize the bases of a batch of objects previously added to collections with
+ * #loose_data_instantiate_object_collection_add, while view-layers resync was forbidden. */
+static void loose_data_instantiate_object_base_init_batch(Main *bmain,
+                                                          LinkNode *objects,
+                                                          const Scene *scene,
+                                                          ViewLayer *view_layer,
+                                                          const View3D *v3d,
+                                                          const int flag,
+                                                          bool set_active)
+{
+  if (objects == NULL) {
+    return;
+  }
+
+  BKE_main_collection_sync(bmain);
+  for (LinkNode *link = objects; link != NULL; link = link->next) {
+    loose_data_instantiate_object_base_init(link->link, scene, view_layer, v3d, flag, set_active);
+  }
+}
+
 /* Tag obdata that actually need to be instantiated (those referenced by an object do not, since
  * the object will be instantiated instead if needed. */
 static void loose_data_instantiate_obdata_preprocess(
@@ -738,6 +782,12 @@ static void loose_data_instantiate_object_process(LooseDataInstantiateContext *i
 
   /* NOTE: For objects we only view_layer-instantiate duplicated objects that are not yet used
    * anywhere. */
+  GSet *objects_in_collections = NULL;
+  /* Objects are all added to their collection first, with view-layers resync forbidden, such
+   * that view-layers only get resynced once for the whole batch of instantiated objects. */
+  LinkNode *instantiated_objects = NULL;
+  BKE_layer_collection_resync_forbid();
+
   LinkNode *itemlink;
   for (itemlink = lapp_context->items.list; itemlink; itemlink = itemlink->next) {
     BlendfileLinkAppendContextItem *item = itemlink->link;
@@ -759,7 +809,10 @@ static void loose_data_instantiate_object_process(LooseDataInstantiateContext *i
 
     Object *ob = (Object *)id;
 
-    if (object_in_any_collection(bmain, ob)) {
+    if (objects_in_collections == NULL) {
+      objects_in_collections = objects_in_any_collection_gset(bmain);
+    }
+    if (!BLI_gset_add(objects_in_collections, ob)) {
       continue;
     }
 
@@ -769,14 +822,24 @@ static void loose_data_instantiate_object_process(LooseDataInstantiateContext *i
     CLAMP_MIN(ob->id.us, 0);
     ob->mode = OB_MODE_OBJECT;
 
-    loose_data_instantiate_object_base_instance_init(bmain,
-                                                     active_collection,
-                                                     ob,
-                                                     scene,
-                                                     view_layer,
-                                                     v3d,
-                                                     lapp_context->params->flag,
-                                                     object_set_active);
+    loose_data_instantiate_object_collection_add(
+        bmain, active_collection, ob, lapp_context->params->flag);
+    BLI_linklist_prepend(&instantiated_objects, ob);
+  }
+
+  BKE_layer_collection_resync_allow();
+  BLI_linklist_reverse(&instantiated_objects);
+  loose_data_instantiate_object_base_init_batch(bmain,
+                                                instantiated_objects,
+                                                scene,
+                                                view_layer,
+                                                v3d,
+                                                lapp_context->params->flag,
+                                                object_set_active);
+
+  BLI_linklist_free(instantiated_objects, NULL);
+  if (objects_in_collections != NULL) {
+    BLI_gset_free(objects_in_collections, NULL);
   }
 }
 
@@ -792,6 +855,10 @@ static void loose_data_instantiate_obdata_process(LooseDataInstantiateContext *i
    * if you want it do it at the editor level. */
   const bool object_set_active = false;
 
+  /* See #loose_data_instantiate_object_process. */
+  LinkNode *instantiated_objects = NULL;
+  BKE_layer_collection_resync_forbid();
+
   LinkNode *itemlink;
   for (itemlink = lapp_context->items.list; itemlink; itemlink = itemlink->next) {
     BlendfileLinkAppendContextItem *item = itemlink->link;
@@ -817,19 +884,26 @@ static void loose_data_instantiate_obdata_process(LooseDataInstantiateContext *i
     id_us_plus(id);
     BKE_object_materials_test(bmain, ob, ob->data);
 
-    loose_data_instantiate_object_base_instance_init(bmain,
-                                                     active_collection,
-                                                     ob,
-                                                     scene,
-                                                     view_layer,
-                                                     v3d,
-                                                     lapp_context->params->flag,
-                                                     object_set_active);
+    loose_data_instantiate_object_collection_add(
+        bmain, active_collection, ob, lapp_context->params->flag);
+    BLI_linklist_prepend(&instantiated_objects, ob);
 
     copy_v3_v3(ob->loc, scene->cursor.location);
 
     id->tag &= ~LIB_TAG_DOIT;
   }
+
+  BKE_layer_collection_resync_allow();
+  BLI_linklist_reverse(&instantiated_objects);
+  loose_data_instantiate_object_base_init_batch(bmain,
+                                                instantiated_objects,
+                                                scene,
+                                                view_layer,
+                                                v3d,
+                                                lapp_context->params->flag,
+                                                object_set_active);
+
+  BLI_linklist_free(instantiated_objects, NULL);
 }
 
 static void loose_data_instantiate_object_rigidbody_postprocess(
@@ -1148,7 +1222,10 @@ void BKE_blendfile_append(BlendfileLinkAppendContext *lapp_context, ReportList *
   BKE_main_library_weak_reference_destroy(lapp_context->library_weak_reference_mapping);
   lapp_context->library_weak_reference_mapping = NULL;
 
-  /* Remap IDs as needed. */
+  /* Remap IDs as needed. All local IDs are remapped at once, such that the costly
+   * post-processing of the remapping (collections and view-layers resync...) only happens once,
+   * instead of once per appended ID. */
+  LinkNode *relink_ids = NULL;
   for (itemlink = lapp_context->items.list; itemlink; itemlink = itemlink->next) {
     BlendfileLinkAppendContextItem *item = itemlink->link;
 
@@ -1170,8 +1247,11 @@ void BKE_blendfile_append(BlendfileLinkAppendContext *lapp_context, ReportList *
 
     BLI_assert(!ID_IS_LINKED(id));
 
-    BKE_libblock_relink_to_newid(bmain, id, 0);
+    BLI_linklist_prepend(&relink_ids, id);
   }
+  BLI_linklist_reverse(&relink_ids);
+  BKE_libblock_relink_to_newid_multiple(bmain, relink_ids, 0);
+  BLI_linklist_free(relink_ids, NULL);
 
   /* Remove linked IDs when a local existing data has been reused instead. */
   BKE_main_id_tag_all(bmain, LIB_TAG_DOIT, false);
@@ -0,0 +1,925 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <type_traits>
+
+#ifdef WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_listbase.h"
+#include "BLI_mmap.h"
+#include "BLI_path_util.h"
+#include "BLI_set.hh"
+#include "BLI_string.h"
+#include "BLI_task.h"
+
+#include "DNA_collection_types.h"
+#include "DNA_curves_types.h"
+#include "DNA_material_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "BKE_attribute.h"
+#include "BKE_attribute.hh"
+#include "BKE_curves.hh"
+#include "BKE_customdata.h"
+#include "BKE_geometry_set.h"
+#include "BKE_geometry_set.hh"
+#include "BKE_geometry_set_cache.hh"
+#include "BKE_instances.hh"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_pointcloud.h"
+
+namespace blender::bke {
+
+static const char MAGIC[4] = {'B', 'G', 'S', 'C'};
+/** Increase when the layout of the written data changes, to invalidate existing files. */
+static const uint32_t CURRENT_VERSION = 1;
+
+enum class CacheComponentType : uint8_t {
+  End = 0,
+  Mesh = 1,
+  Curves = 2,
+  PointCloud = 3,
+  Instances = 4,
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Writing
+ * \{ */
+
+class CacheWriter {
+  std::ostream &os_;
+  bool include_anonymous_attributes_;
+
+ public:
+  /**
+   * \param include_anonymous_attributes: Anonymous attributes are not useful in cache files, but
+   * they are needed when the data is written to compute a hash of the geometry.
+   */
+  CacheWriter(std::ostream &os, const bool include_anonymous_attributes = false)
+      : os_(os), include_anonymous_attributes_(include_anonymous_attributes)
+  {
+  }
+
+  bool include_anonymous_attributes() const
+  {
+    return include_anonymous_attributes_;
+  }
+
+  void write_bytes(const void *data, const int64_t size)
+  {
+    os_.write(static_cast<const char *>(data), size);
+  }
+
+  template<typename T> void write(const T &value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    this->write_bytes(&value, sizeof(T));
+  }
+
+  template<typename T> void write_span(const Span<T> span)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    this->write<int64_t>(span.size());
+    this->write_bytes(span.data(), span.size_in_bytes());
+  }
+
+  void write_string(const StringRef str)
+  {
+    this->write<uint32_t>(uint32_t(str.size()));
+    this->write_bytes(str.data(), str.size());
+  }
+};
+
+static void write_attributes(CacheWriter &writer,
+                             const AttributeAccessor &attributes,
+                             const Set<std::string> &names_to_skip)
+{
+  struct AttributeToWrite {
+    AttributeIDRef id;
+    AttributeMetaData meta_data;
+  };
+  Vector<AttributeToWrite> attributes_to_write;
+  attributes.for_all([&](const AttributeIDRef &id, const AttributeMetaData &meta_data) {
+    /* Anonymous attributes can't be referenced by anything after reading the file. */
+    if ((id.is_anonymous() && !writer.include_anonymous_attributes()) ||
+        names_to_skip.contains_as(id.name())) {
+      return true;
+    }
+    const CPPType *type = custom_data_type_to_cpp_type(meta_data.data_type);
+    if (type == nullptr || !type->is_trivial()) {
+      return true;
+    }
+    attributes_to_write.append({id, meta_data});
+    return true;
+  });
+
+  writer.write<uint32_t>(uint32_t(attributes_to_write.size()));
+  for (const AttributeToWrite &attribute : attributes_to_write) {
+    const GVArraySpan data(attributes.lookup(attribute.id).varray);
+    writer.write_string(attribute.id.name());
+    writer.write<int8_t>(int8_t(attribute.meta_data.domain));
+    writer.write<int32_t>(int32_t(attribute.meta_data.data_type));
+    writer.write<int64_t>(data.size());
+    writer.write_bytes(data.data(), data.size() * data.type().size());
+  }
+}
+
+static void write_materials(CacheWriter &writer,
+                            Material *const *materials,
+                            const int materials_num)
+{
+  writer.write<int32_t>(materials_num);
+  for (const int i : IndexRange(materials_num)) {
+    writer.write_string(materials[i] == nullptr ? "" : materials[i]->id.name + 2);
+  }
+}
+
+static void write_mesh(CacheWriter &writer, const Mesh &mesh)
+{
+  writer.write<int32_t>(mesh.totvert);
+  writer.write<int32_t>(mesh.totedge);
+  writer.write<int32_t>(mesh.totpoly);
+  writer.write<int32_t>(mesh.totloop);
+  writer.write_span(mesh.edges());
+  writer.write_span(mesh.polys());
+  writer.write_span(mesh.loops());
+
+  writer.write_string(mesh.active_color_attribute ? mesh.active_color_attribute : "");
+  writer.write_string(mesh.default_color_attribute ? mesh.default_color_attribute : "");
+  const char *active_uv_map = CustomData_get_active_layer_name(&mesh.ldata, CD_PROP_FLOAT2);
+  const char *render_uv_map = CustomData_get_render_layer_name(&mesh.ldata, CD_PROP_FLOAT2);
+  writer.write_string(active_uv_map ? active_uv_map : "");
+  writer.write_string(render_uv_map ? render_uv_map : "");
+
+  /* Vertex groups are exposed as attributes too, but they are stored separately to keep them as
+   * vertex groups when reading the mesh. */
+  Set<std::string> vertex_group_names;
+  writer.write<int32_t>(BLI_listbase_count(&mesh.vertex_group_names));
+  LISTBASE_FOREACH (const bDeformGroup *, group, &mesh.vertex_group_names) {
+    writer.write_string(group->name);
+    vertex_group_names.add(group->name);
+  }
+  const Span<MDeformVert> dverts = mesh.deform_verts();
+  writer.write<uint8_t>(!dverts.is_empty());
+  for (const MDeformVert &dvert : dverts) {
+    writer.write<int32_t>(dvert.totweight);
+    writer.write_bytes(dvert.dw, sizeof(MDeformWeight) * dvert.totweight);
+  }
+
+  write_attributes(writer, mesh.attributes(), vertex_group_names);
+  write_materials(writer, mesh.mat, mesh.totcol);
+}
+
+static void write_curves(CacheWriter &writer, const Curves &curves_id)
+{
+  const CurvesGeometry &curves = CurvesGeometry::wrap(curves_id.geometry);
+  writer.write<int32_t>(curves.points_num());
+  writer.write<int32_t>(curves.curves_num());
+  if (curves.curves_num() > 0) {
+    writer.write_span(curves.offsets());
+  }
+  write_attributes(writer, curves.attributes(), {});
+  write_materials(writer, curves_id.mat, curves_id.totcol);
+}
+
+static void write_pointcloud(CacheWriter &writer, const PointCloud &pointcloud)
+{
+  writer.write<int32_t>(pointcloud.totpoint);
+  write_attributes(writer, pointcloud.attributes(), {});
+  write_materials(writer, pointcloud.mat, pointcloud.totcol);
+}
+
+static void write_geometry(CacheWriter &writer, const GeometrySet &geometry);
+
+static void write_instances(CacheWriter &writer, const Instances &instances)
+{
+  writer.write<int32_t>(instances.references_num());
+  for (const InstanceReference &reference : instances.references()) {
+    writer.write<uint8_t>(uint8_t(reference.type()));
+    switch (reference.type()) {
+      case InstanceReference::Type::None:
+        break;
+      case InstanceReference::Type::Object:
+        writer.write_string(reference.object().id.name + 2);
+        break;
+      case InstanceReference::Type::Collection:
+        writer.write_string(reference.collection().id.name + 2);
+        break;
+      case InstanceReference::Type::GeometrySet:
+        write_geometry(writer, reference.geometry_set());
+        break;
+    }
+  }
+
+  writer.write<int32_t>(instances.instances_num());
+  writer.write_span(instances.reference_handles());
+  writer.write_span(instances.transforms());
+  write_attributes(writer, instances.attributes(), {});
+}
+
+static void write_geometry(CacheWriter &writer, const GeometrySet &geometry)
+{
+  if (const Mesh *mesh = geometry.get_mesh_for_read()) {
+    writer.write(CacheComponentType::Mesh);
+    write_mesh(writer, *mesh);
+  }
+  if (const Curves *curves = geometry.get_curves_for_read()) {
+    writer.write(CacheComponentType::Curves);
+    write_curves(writer, *curves);
+  }
+  if (const PointCloud *pointcloud = geometry.get_pointcloud_for_read()) {
+    writer.write(CacheComponentType::PointCloud);
+    write_pointcloud(writer, *pointcloud);
+  }
+  if (const Instances *instances = geometry.get_instances_for_read()) {
+    writer.write(CacheComponentType::Instances);
+    write_instances(writer, *instances);
+  }
+  writer.write(CacheComponentType::End);
+}
+
+bool geometry_cache_supports(const GeometrySet &geometry)
+{
+  if (geometry.has_volume()) {
+    return false;
+  }
+  if (const Instances *instances = geometry.get_instances_for_read()) {
+    for (const InstanceReference &reference : instances->references()) {
+      if (reference.type() == InstanceReference::Type::GeometrySet &&
+          !geometry_cache_supports(reference.geometry_set())) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static void write_file_contents(CacheWriter &writer,
+                                const GeometrySet &geometry,
+                                const uint64_t key)
+{
+  writer.write_bytes(MAGIC, sizeof(MAGIC));
+  writer.write(CURRENT_VERSION);
+  writer.write(key);
+  write_geometry(writer, geometry);
+}
+
+/**
+ * Write the file with the given contents. The file is first written to a temporary location and
+ * then moved, so that a cache file is never read while being written.
+ */
+static bool write_file(const StringRefNull filepath,
+                       const FunctionRef<void(std::ostream &os)> write_fn)
+{
+  if (!BLI_make_existing_file(filepath.c_str())) {
+    return false;
+  }
+
+  const std::string temp_path = filepath + "@";
+  std::ofstream os;
+  os.open(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+  write_fn(os);
+  os.close();
+
+  if (os.fail() || BLI_rename(temp_path.c_str(), filepath.c_str()) != 0) {
+    BLI_delete(temp_path.c_str(), false, false);
+    return false;
+  }
+  return true;
+}
+
+bool geometry_cache_write(const GeometrySet &geometry,
+                          const StringRefNull filepath,
+                          const uint64_t key)
+{
+  if (!geometry_cache_supports(geometry)) {
+    return false;
+  }
+  return write_file(filepath, [&](std::ostream &os) {
+    CacheWriter writer{os};
+    write_file_contents(writer, geometry, key);
+  });
+}
+
+/**
+ * Files written by #geometry_cache_write_async. The pool is created when it is first needed and
+ * freed in #BKE_geometry_cache_exit.
+ */
+static struct {
+  std::mutex mutex;
+  TaskPool *pool = nullptr;
+  /** Files for which a task is pending, to avoid writing the same file multiple times. */
+  Set<std::string> pending_paths;
+} async_writes;
+
+struct AsyncWriteTask {
+  std::string filepath;
+  std::string contents;
+};
+
+static void async_write_task_run(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  const AsyncWriteTask &task = *static_cast<AsyncWriteTask *>(taskdata);
+  write_file(task.filepath, [&](std::ostream &os) {
+    os.write(task.contents.data(), int64_t(task.contents.size()));
+  });
+
+  std::lock_guard lock{async_writes.mutex};
+  async_writes.pending_paths.remove(task.filepath);
+}
+
+static void async_write_task_free(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  delete static_cast<AsyncWriteTask *>(taskdata);
+}
+
+void geometry_cache_write_async(const GeometrySet &geometry,
+                                std::string filepath,
+                                const uint64_t key)
+{
+  if (!geometry_cache_supports(geometry)) {
+    return;
+  }
+  {
+    std::lock_guard lock{async_writes.mutex};
+    if (!async_writes.pending_paths.add(filepath)) {
+      return;
+    }
+  }
+
+  /* The geometry references data-blocks that may be freed before the file is written, so it is
+   * converted to the file contents right away. Only the file is written in the background. */
+  std::ostringstream stream;
+  CacheWriter writer{stream};
+  write_file_contents(writer, geometry, key);
+
+  AsyncWriteTask *task = new AsyncWriteTask{std::move(filepath), std::move(stream).str()};
+  std::lock_guard lock{async_writes.mutex};
+  if (async_writes.pool == nullptr) {
+    async_writes.pool = BLI_task_pool_create_background(nullptr, TASK_PRIORITY_LOW);
+  }
+  BLI_task_pool_push(async_writes.pool, async_write_task_run, task, false, async_write_task_free);
+}
+
+/** Adds everything written to the stream to a 64 bit hash, made of two 32 bit hashes. */
+class HashStreamBuffer : public std::streambuf {
+  BLI_HashMurmur2A hash_low_;
+  BLI_HashMurmur2A hash_high_;
+
+ public:
+  HashStreamBuffer()
+  {
+    BLI_hash_mm2a_init(&hash_low_, 0);
+    BLI_hash_mm2a_init(&hash_high_, 1);
+  }
+
+  uint64_t hash()
+  {
+    return uint64_t(BLI_hash_mm2a_end(&hash_low_)) |
+           (uint64_t(BLI_hash_mm2a_end(&hash_high_)) << 32);
+  }
+
+ protected:
+  std::streamsize xsputn(const char *data, const std::streamsize size) override
+  {
+    BLI_hash_mm2a_add(&hash_low_, reinterpret_cast<const uchar *>(data), size_t(size));
+    BLI_hash_mm2a_add(&hash_high_, reinterpret_cast<const uchar *>(data), size_t(size));
+    return size;
+  }
+
+  int_type overflow(const int_type c) override
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      const char value = traits_type::to_char_type(c);
+      this->xsputn(&value, 1);
+    }
+    return traits_type::not_eof(c);
+  }
+};
+
+uint64_t geometry_cache_hash(const GeometrySet &geometry)
+{
+  HashStreamBuffer buffer;
+  std::ostream stream(&buffer);
+  CacheWriter writer{stream, true};
+  write_geometry(writer, geometry);
+  stream.flush();
+  return buffer.hash();
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Reading
+ * \{ */
+
+/** Opening and freeing memory-mapped files modifies global state in #BLI_mmap_open. */
+static std::mutex mmap_mutex;
+
+/**
+ * Reads values from the mapped file. Reading past the end of the data sets the failed state, in
+ * which all further reads return zeroed values, so that callers only have to check for failure
+ * once before using the values.
+ */
+class CacheReader {
+  const char *pos_;
+  const char *end_;
+  bool failed_ = false;
+
+ public:
+  CacheReader(const Span<char> data) : pos_(data.begin()), end_(data.end())
+  {
+  }
+
+  bool failed() const
+  {
+    return failed_;
+  }
+
+  /** Mark the data as invalid, e.g. because a read value is out of its valid range. */
+  void fail()
+  {
+    failed_ = true;
+  }
+
+  /** \return A view of the next bytes of the file, or an empty span on failure. */
+  Span<char> read_block(const int64_t size)
+  {
+    if (failed_ || size < 0 || end_ - pos_ < size) {
+      failed_ = true;
+      return {};
+    }
+    const Span<char> block(pos_, size);
+    pos_ += size;
+    return block;
+  }
+
+  bool read_bytes(void *dst, const int64_t size)
+  {
+    const Span<char> block = this->read_block(size);
+    if (failed_) {
+      return false;
+    }
+    if (size > 0) {
+      memcpy(dst, block.data(), size);
+    }
+    return true;
+  }
+
+  template<typename T> T read()
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value{};
+    this->read_bytes(&value, sizeof(T));
+    return value;
+  }
+
+  template<typename T> bool read_span(MutableSpan<T> dst)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (this->read<int64_t>() != dst.size()) {
+      failed_ = true;
+      return false;
+    }
+    return this->read_bytes(dst.data(), dst.size() * sizeof(T));
+  }
+
+  std::string read_string()
+  {
+    const uint32_t size = this->read<uint32_t>();
+    const Span<char> block = this->read_block(size);
+    return std::string(block.data(), block.size());
+  }
+};
+
+static bool read_attributes(CacheReader &reader, MutableAttributeAccessor attributes)
+{
+  const uint32_t attributes_num = reader.read<uint32_t>();
+  for ([[maybe_unused]] const int i : IndexRange(attributes_num)) {
+    const std::string name = reader.read_string();
+    const eAttrDomain domain = eAttrDomain(reader.read<int8_t>());
+    const eCustomDataType data_type = eCustomDataType(reader.read<int32_t>());
+    const int64_t size = reader.read<int64_t>();
+    if (reader.failed() || domain < 0 || domain >= ATTR_DOMAIN_NUM) {
+      return false;
+    }
+    const CPPType *type = custom_data_type_to_cpp_type(data_type);
+    if (type == nullptr) {
+      return false;
+    }
+    const Span<char> data = reader.read_block(size * type->size());
+    if (reader.failed()) {
+      return false;
+    }
+
+    GSpanAttributeWriter attribute = attributes.lookup_or_add_for_write_only_span(
+        name, domain, data_type);
+    if (!attribute) {
+      /* E.g. read-only built-in attributes. */
+      continue;
+    }
+    const bool size_matches = attribute.span.size() == size;
+    if (size_matches) {
+      memcpy(attribute.span.data(), data.data(), data.size());
+    }
+    attribute.finish();
+    if (!size_matches) {
+      return false;
+    }
+  }
+  return !reader.failed();
+}
+
+static bool read_materials(CacheReader &reader,
+                           const GeometryCacheIDResolver id_resolver,
+                           Material ***r_materials,
+                           short *r_materials_num)
+{
+  const int materials_num = reader.read<int32_t>();
+  if (reader.failed() || materials_num < 0 || materials_num > SHRT_MAX) {
+    return false;
+  }
+  BLI_assert(*r_materials == nullptr);
+  if (materials_num > 0) {
+    *r_materials = MEM_cnew_array<Material *>(size_t(materials_num), __func__);
+  }
+  *r_materials_num = short(materials_num);
+  for (const int i : IndexRange(materials_num)) {
+    const std::string name = reader.read_string();
+    if (!name.empty()) {
+      (*r_materials)[i] = reinterpret_cast<Material *>(id_resolver(ID_MA, name));
+    }
+  }
+  return !reader.failed();
+}
+
+/**
+ * Check that all indices stored in the mesh topology are in the range of the elements they refer
+ * to, so that a corrupt file can't cause out of bounds access later on.
+ */
+static bool mesh_topology_is_valid(const Mesh &mesh)
+{
+  for (const MEdge &edge : mesh.edges()) {
+    if (edge.v1 >= uint(mesh.totvert) || edge.v2 >= uint(mesh.totvert)) {
+      return false;
+    }
+  }
+  for (const MPoly &poly : mesh.polys()) {
+    if (poly.loopstart < 0 || poly.totloop < 0 || poly.loopstart > mesh.totloop ||
+        poly.totloop > mesh.totloop - poly.loopstart) {
+      return false;
+    }
+  }
+  for (const MLoop &loop : mesh.loops()) {
+    if (loop.v >= uint(mesh.totvert) || loop.e >= uint(mesh.totedge)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool read_mesh_data(CacheReader &reader,
+                           const GeometryCacheIDResolver id_resolver,
+                           Mesh &mesh)
+{
+  if (!reader.read_span(mesh.edges_for_write()) || !reader.read_span(mesh.polys_for_write()) ||
+      !reader.read_span(mesh.loops_for_write())) {
+    return false;
+  }
+  if (!mesh_topology_is_valid(mesh)) {
+    return false;
+  }
+
+  const std::string active_color = reader.read_string();
+  const std::string default_color = reader.read_string();
+  const std::string active_uv_map = reader.read_string();
+  const std::string render_uv_map = reader.read_string();
+
+  const int vertex_groups_num = reader.read<int32_t>();
+  if (reader.failed() || vertex_groups_num < 0) {
+    return false;
+  }
+  for ([[maybe_unused]] const int i : IndexRange(vertex_groups_num)) {
+    bDeformGroup *group = MEM_cnew<bDeformGroup>(__func__);
+    STRNCPY(group->name, reader.read_string().c_str());
+    BLI_addtail(&mesh.vertex_group_names, group);
+  }
+  if (reader.read<uint8_t>()) {
+    for (MDeformVert &dvert : mesh.deform_verts_for_write()) {
+      const int totweight = reader.read<int32_t>();
+      if (reader.failed() || totweight < 0) {
+        return false;
+      }
+      if (totweight > 0) {
+        dvert.dw = MEM_cnew_array<MDeformWeight>(size_t(totweight), __func__);
+        dvert.totweight = totweight;
+        if (!reader.read_bytes(dvert.dw, sizeof(MDeformWeight) * totweight)) {
+          return false;
+        }
+        for (const MDeformWeight &weight : Span(dvert.dw, totweight)) {
+          if (weight.def_nr >= uint(vertex_groups_num)) {
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  if (!read_attributes(reader, mesh.attributes_for_write())) {
+    return false;
+  }
+  if (!read_materials(reader, id_resolver, &mesh.mat, &mesh.totcol)) {
+    return false;
+  }
+
+  if (!active_color.empty()) {
+    BKE_id_attributes_active_color_set(&mesh.id, active_color.c_str());
+  }
+  if (!default_color.empty()) {
+    BKE_id_attributes_default_color_set(&mesh.id, default_color.c_str());
+  }
+  const int active_uv_index = CustomData_get_named_layer(
+      &mesh.ldata, CD_PROP_FLOAT2, active_uv_map.c_str());
+  if (active_uv_index != -1) {
+    CustomData_set_layer_active(&mesh.ldata, CD_PROP_FLOAT2, active_uv_index);
+  }
+  const int render_uv_index = CustomData_get_named_layer(
+      &mesh.ldata, CD_PROP_FLOAT2, render_uv_map.c_str());
+  if (render_uv_index != -1) {
+    CustomData_set_layer_render(&mesh.ldata, CD_PROP_FLOAT2, render_uv_index);
+  }
+  return true;
+}
+
+static Mesh *read_mesh(CacheReader &reader, const GeometryCacheIDResolver id_resolver)
+{
+  const int verts_num = reader.read<int32_t>();
+  const int edges_num = reader.read<int32_t>();
+  const int polys_num = reader.read<int32_t>();
+  const int loops_num = reader.read<int32_t>();
+  if (reader.failed() || verts_num < 0 || edges_num < 0 || polys_num < 0 || loops_num < 0) {
+    return nullptr;
+  }
+  Mesh *mesh = BKE_mesh_new_nomain(verts_num, edges_num, 0, loops_num, polys_num);
+  if (!read_mesh_data(reader, id_resolver, *mesh)) {
+    BKE_id_free(nullptr, mesh);
+    return nullptr;
+  }
+  return mesh;
+}
+
+static Curves *read_curves(CacheReader &reader, const GeometryCacheIDResolver id_resolver)
+{
+  const int points_num = reader.read<int32_t>();
+  const int curves_num = reader.read<int32_t>();
+  if (reader.failed() || points_num < 0 || curves_num < 0 || (curves_num == 0 && points_num > 0)) {
+    return nullptr;
+  }
+  CurvesGeometry curves(points_num, curves_num);
+  if (curves_num > 0) {
+    MutableSpan<int> offsets = curves.offsets_for_write();
+    if (!reader.read_span(offsets)) {
+      return nullptr;
+    }
+    /* Every curve must have a valid range of points, and together they must use all points. */
+    if (offsets.first() != 0 || offsets.last() != points_num) {
+      return nullptr;
+    }
+    for (const int i : offsets.index_range().drop_back(1)) {
+      if (offsets[i] > offsets[i + 1]) {
+        return nullptr;
+      }
+    }
+  }
+  if (!read_attributes(reader, curves.attributes_for_write())) {
+    return nullptr;
+  }
+  const VArray<int8_t> curve_types = curves.curve_types();
+  for (const int i : curve_types.index_range()) {
+    if (curve_types[i] < 0 || curve_types[i] >= CURVE_TYPES_NUM) {
+      return nullptr;
+    }
+  }
+  curves.update_curve_types();
+
+  Curves *curves_id = curves_new_nomain(std::move(curves));
+  if (!read_materials(reader, id_resolver, &curves_id->mat, &curves_id->totcol)) {
+    BKE_id_free(nullptr, curves_id);
+    return nullptr;
+  }
+  return curves_id;
+}
+
+static PointCloud *read_pointcloud(CacheReader &reader, const GeometryCacheIDResolver id_resolver)
+{
+  const int points_num = reader.read<int32_t>();
+  if (reader.failed() || points_num < 0) {
+    return nullptr;
+  }
+  PointCloud *pointcloud = BKE_pointcloud_new_nomain(points_num);
+  if (!read_attributes(reader, pointcloud->attributes_for_write()) ||
+      !read_materials(reader, id_resolver, &pointcloud->mat, &pointcloud->totcol)) {
+    BKE_id_free(nullptr, pointcloud);
+    return nullptr;
+  }
+  return pointcloud;
+}
+
+static bool read_geometry(CacheReader &reader,
+                          GeometryCacheIDResolver id_resolver,
+                          GeometrySet &r_geometry);
+
+static bool read_instances_data(CacheReader &reader,
+                                const GeometryCacheIDResolver id_resolver,
+                                Instances &instances)
+{
+  const int references_num = reader.read<int32_t>();
+  if (reader.failed() || references_num < 0) {
+    return false;
+  }
+  /* Equal references are merged when they are added, so the handles have to be remapped. */
+  Array<int> handle_map(references_num);
+  for (const int i : IndexRange(references_num)) {
+    InstanceReference reference;
+    switch (InstanceReference::Type(reader.read<uint8_t>())) {
+      case InstanceReference::Type::None:
+        break;
+      case InstanceReference::Type::Object:
+        if (ID *id = id_resolver(ID_OB, reader.read_string())) {
+          reference = InstanceReference(*reinterpret_cast<Object *>(id));
+        }
+        break;
+      case InstanceReference::Type::Collection:
+        if (ID *id = id_resolver(ID_GR, reader.read_string())) {
+          reference = InstanceReference(*reinterpret_cast<Collection *>(id));
+        }
+        break;
+      case InstanceReference::Type::GeometrySet: {
+        GeometrySet geometry;
+        if (!read_geometry(reader, id_resolver, geometry)) {
+          return false;
+        }
+        reference = InstanceReference(std::move(geometry));
+        break;
+      }
+      default:
+        reader.fail();
+        break;
+    }
+    if (reader.failed()) {
+      return false;
+    }
+    handle_map[i] = instances.add_reference(reference);
+  }
+
+  const int instances_num = reader.read<int32_t>();
+  if (reader.failed() || instances_num < 0) {
+    return false;
+  }
+  instances.resize(instances_num);
+  MutableSpan<int> handles = instances.reference_handles();
+  if (!reader.read_span(handles) || !reader.read_span(instances.transforms())) {
+    return false;
+  }
+  for (int &handle : handles) {
+    if (handle < 0 || handle >= references_num) {
+      return false;
+    }
+    handle = handle_map[handle];
+  }
+  return read_attributes(reader, instances.attributes_for_write());
+}
+
+static bool read_geometry(CacheReader &reader,
+                          const GeometryCacheIDResolver id_resolver,
+                          GeometrySet &r_geometry)
+{
+  while (true) {
+    const CacheComponentType type = reader.read<CacheComponentType>();
+    if (reader.failed()) {
+      return false;
+    }
+    switch (type) {
+      case CacheComponentType::End:
+        return true;
+      case CacheComponentType::Mesh: {
+        Mesh *mesh = read_mesh(reader, id_resolver);
+        if (mesh == nullptr) {
+          return false;
+        }
+        r_geometry.replace_mesh(mesh);
+        break;
+      }
+      case CacheComponentType::Curves: {
+        Curves *curves = read_curves(reader, id_resolver);
+        if (curves == nullptr) {
+          return false;
+        }
+        r_geometry.replace_curves(curves);
+        break;
+      }
+      case CacheComponentType::PointCloud: {
+        PointCloud *pointcloud = read_pointcloud(reader, id_resolver);
+        if (pointcloud == nullptr) {
+          return false;
+        }
+        r_geometry.replace_pointcloud(pointcloud);
+        break;
+      }
+      case CacheComponentType::Instances: {
+        Instances *instances = new Instances();
+        r_geometry.replace_instances(instances);
+        if (!read_instances_data(reader, id_resolver, *instances)) {
+          return false;
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+}
+
+std::optional<GeometrySet> geometry_cache_read(const StringRefNull filepath,
+                                               const uint64_t key,
+                                               const GeometryCacheIDResolver id_resolver)
+{
+  const int file = BLI_open(filepath.c_str(), O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return std::nullopt;
+  }
+  const size_t size = BLI_file_descriptor_size(file);
+  BLI_mmap_file *mmap_file = nullptr;
+  if (size != size_t(-1) && size >= sizeof(MAGIC)) {
+    std::lock_guard lock{mmap_mutex};
+    mmap_file = BLI_mmap_open(file);
+  }
+  if (mmap_file == nullptr) {
+    close(file);
+    return std::nullopt;
+  }
+
+  std::optional<GeometrySet> result;
+  CacheReader reader{Span<char>(static_cast<const char *>(BLI_mmap_get_pointer(mmap_file)),
+                                int64_t(size))};
+  const Span<char> magic = reader.read_block(sizeof(MAGIC));
+  const uint32_t version = reader.read<uint32_t>();
+  const uint64_t file_key = reader.read<uint64_t>();
+  if (!reader.failed() && magic == Span<char>(MAGIC, sizeof(MAGIC)) &&
+      version == CURRENT_VERSION && file_key == key) {
+    GeometrySet geometry;
+    if (read_geometry(reader, id_resolver, geometry)) {
+      result = std::move(geometry);
+    }
+  }
+
+  {
+    std::lock_guard lock{mmap_mutex};
+    /* Pages that could not be read are replaced by zeros, which may look like valid data. */
+    if (BLI_mmap_any_io_error(mmap_file)) {
+      result.reset();
+    }
+    BLI_mmap_free(mmap_file);
+  }
+  close(file);
+  return result;
+}
+
+/** \} */
+
+}  // namespace blender::bke
+
+void BKE_geometry_cache_exit()
+{
+  using namespace blender::bke;
+  TaskPool *pool;
+  {
+    std::lock_guard lock{async_writes.mutex};
+    pool = async_writes.pool;
+    async_writes.pool = nullptr;
+  }
+  if (pool != nullptr) {
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
+}
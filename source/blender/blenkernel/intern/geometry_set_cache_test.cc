@@ -0,0 +1,280 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <fstream>
+#include <string>
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_attribute.hh"
+#include "BKE_curves.hh"
+#include "BKE_geometry_set.h"
+#include "BKE_geometry_set.hh"
+#include "BKE_geometry_set_cache.hh"
+#include "BKE_idtype.h"
+#include "BKE_instances.hh"
+#include "BKE_mesh.h"
+#include "BKE_pointcloud.h"
+
+namespace blender::bke::tests {
+
+class geometry_set_cache_test : public testing::Test {
+ protected:
+  std::string filepath_;
+
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+    BKE_tempdir_init(nullptr);
+  }
+
+  static void TearDownTestSuite()
+  {
+    BKE_tempdir_session_purge();
+  }
+
+  void SetUp() override
+  {
+    char filepath[FILE_MAX];
+    BLI_path_join(filepath, sizeof(filepath), BKE_tempdir_session(), "geometry_cache.bgc");
+    filepath_ = filepath;
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(filepath_.c_str(), false, false);
+  }
+
+  std::optional<GeometrySet> read(const uint64_t key)
+  {
+    return geometry_cache_read(filepath_, key, [](ID_Type /*id_type*/, StringRef /*name*/) {
+      return nullptr;
+    });
+  }
+
+  std::string read_file_contents()
+  {
+    std::ifstream stream(filepath_, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  }
+
+  void write_file_contents(const std::string &contents)
+  {
+    std::ofstream stream(filepath_, std::ios::binary | std::ios::trunc);
+    stream.write(contents.data(), int64_t(contents.size()));
+  }
+};
+
+/** A single quad with a point attribute. */
+static Mesh *create_quad_mesh()
+{
+  Mesh *mesh = BKE_mesh_new_nomain(4, 0, 0, 4, 1);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  positions[0] = float3(0, 0, 0);
+  positions[1] = float3(1, 0, 0);
+  positions[2] = float3(1, 1, 0);
+  positions[3] = float3(0, 1, 0);
+  MutableSpan<MPoly> polys = mesh->polys_for_write();
+  polys[0].loopstart = 0;
+  polys[0].totloop = 4;
+  MutableSpan<MLoop> loops = mesh->loops_for_write();
+  for (const int i : loops.index_range()) {
+    loops[i].v = i;
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  SpanAttributeWriter<float> weights =
+      mesh->attributes_for_write().lookup_or_add_for_write_only_span<float>("weight",
+                                                                            ATTR_DOMAIN_POINT);
+  weights.span.copy_from({0.0f, 0.25f, 0.5f, 1.0f});
+  weights.finish();
+  return mesh;
+}
+
+/** Two curves with two and three points. */
+static Curves *create_curves()
+{
+  Curves *curves_id = curves_new_nomain(5, 2);
+  CurvesGeometry &curves = CurvesGeometry::wrap(curves_id->geometry);
+  curves.offsets_for_write().copy_from({0, 2, 5});
+  for (const int i : curves.points_range()) {
+    curves.positions_for_write()[i] = float3(float(i), 0, 0);
+  }
+  return curves_id;
+}
+
+static PointCloud *create_pointcloud(const int points_num)
+{
+  PointCloud *pointcloud = BKE_pointcloud_new_nomain(points_num);
+  SpanAttributeWriter<float3> positions =
+      pointcloud->attributes_for_write().lookup_for_write_span<float3>("position");
+  for (const int i : positions.span.index_range()) {
+    positions.span[i] = float3(0, 0, float(i));
+  }
+  positions.finish();
+  return pointcloud;
+}
+
+/** A mesh, curves and instances of a nested point cloud geometry. */
+static GeometrySet create_geometry()
+{
+  GeometrySet geometry = GeometrySet::create_with_mesh(create_quad_mesh());
+  geometry.replace_curves(create_curves());
+
+  Instances *instances = new Instances();
+  const int handle = instances->add_reference(
+      InstanceReference(GeometrySet::create_with_pointcloud(create_pointcloud(3))));
+  instances->add_instance(handle, float4x4::identity());
+  instances->add_instance(handle, float4x4::from_location(float3(2, 0, 0)));
+  geometry.replace_instances(instances);
+  return geometry;
+}
+
+TEST_F(geometry_set_cache_test, round_trip)
+{
+  const GeometrySet geometry = create_geometry();
+  ASSERT_TRUE(geometry_cache_supports(geometry));
+  ASSERT_TRUE(geometry_cache_write(geometry, filepath_, 42));
+
+  const std::optional<GeometrySet> result = this->read(42);
+  ASSERT_TRUE(result.has_value());
+
+  const Mesh *mesh = result->get_mesh_for_read();
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->totvert, 4);
+  EXPECT_EQ(mesh->totedge, 4);
+  EXPECT_EQ(mesh->totpoly, 1);
+  EXPECT_EQ(mesh->totloop, 4);
+  EXPECT_EQ(mesh->vert_positions()[2], float3(1, 1, 0));
+  EXPECT_EQ(mesh->polys()[0].totloop, 4);
+  for (const int i : IndexRange(4)) {
+    EXPECT_EQ(mesh->loops()[i].v, i);
+  }
+  const VArray<float> weights = mesh->attributes().lookup<float>("weight", ATTR_DOMAIN_POINT);
+  ASSERT_TRUE(bool(weights));
+  EXPECT_EQ(weights[1], 0.25f);
+  EXPECT_EQ(weights[3], 1.0f);
+
+  const Curves *curves_id = result->get_curves_for_read();
+  ASSERT_NE(curves_id, nullptr);
+  const CurvesGeometry &curves = CurvesGeometry::wrap(curves_id->geometry);
+  EXPECT_EQ(curves.points_num(), 5);
+  EXPECT_EQ(curves.curves_num(), 2);
+  EXPECT_EQ(curves.offsets()[1], 2);
+  EXPECT_EQ(curves.positions()[4], float3(4, 0, 0));
+
+  const Instances *instances = result->get_instances_for_read();
+  ASSERT_NE(instances, nullptr);
+  ASSERT_EQ(instances->instances_num(), 2);
+  ASSERT_EQ(instances->references_num(), 1);
+  EXPECT_EQ(instances->transforms()[1], float4x4::from_location(float3(2, 0, 0)));
+  const InstanceReference &reference = instances->references()[0];
+  ASSERT_EQ(reference.type(), InstanceReference::Type::GeometrySet);
+  const PointCloud *pointcloud = reference.geometry_set().get_pointcloud_for_read();
+  ASSERT_NE(pointcloud, nullptr);
+  EXPECT_EQ(pointcloud->totpoint, 3);
+  const VArray<float3> positions = pointcloud->attributes().lookup<float3>("position");
+  EXPECT_EQ(positions[2], float3(0, 0, 2));
+
+  /* The same data is hashed the same way. */
+  EXPECT_EQ(geometry_cache_hash(*result), geometry_cache_hash(geometry));
+}
+
+TEST_F(geometry_set_cache_test, different_key)
+{
+  ASSERT_TRUE(geometry_cache_write(create_geometry(), filepath_, 42));
+  EXPECT_FALSE(this->read(43).has_value());
+}
+
+TEST_F(geometry_set_cache_test, missing_file)
+{
+  EXPECT_FALSE(this->read(42).has_value());
+}
+
+TEST_F(geometry_set_cache_test, truncated)
+{
+  ASSERT_TRUE(geometry_cache_write(create_geometry(), filepath_, 42));
+  const std::string contents = this->read_file_contents();
+  ASSERT_FALSE(contents.empty());
+  for (const int64_t size : IndexRange(int64_t(contents.size()))) {
+    this->write_file_contents(contents.substr(0, size_t(size)));
+    EXPECT_FALSE(this->read(42).has_value()) << "Size " << size;
+  }
+}
+
+TEST_F(geometry_set_cache_test, invalid_loop_vertex)
+{
+  Mesh *mesh = create_quad_mesh();
+  mesh->loops_for_write()[2].v = 4;
+  ASSERT_TRUE(geometry_cache_write(GeometrySet::create_with_mesh(mesh), filepath_, 42));
+  EXPECT_FALSE(this->read(42).has_value());
+}
+
+TEST_F(geometry_set_cache_test, invalid_poly_offset)
+{
+  Mesh *mesh = create_quad_mesh();
+  mesh->polys_for_write()[0].loopstart = 1;
+  ASSERT_TRUE(geometry_cache_write(GeometrySet::create_with_mesh(mesh), filepath_, 42));
+  EXPECT_FALSE(this->read(42).has_value());
+}
+
+TEST_F(geometry_set_cache_test, invalid_edge_vertex)
+{
+  Mesh *mesh = create_quad_mesh();
+  mesh->edges_for_write()[0].v2 = 10;
+  ASSERT_TRUE(geometry_cache_write(GeometrySet::create_with_mesh(mesh), filepath_, 42));
+  EXPECT_FALSE(this->read(42).has_value());
+}
+
+TEST_F(geometry_set_cache_test, invalid_curve_offsets)
+{
+  Curves *curves_id = create_curves();
+  CurvesGeometry::wrap(curves_id->geometry).offsets_for_write()[1] = 6;
+  ASSERT_TRUE(geometry_cache_write(GeometrySet::create_with_curves(curves_id), filepath_, 42));
+  EXPECT_FALSE(this->read(42).has_value());
+}
+
+TEST_F(geometry_set_cache_test, hash_changes_with_attributes)
+{
+  PointCloud *pointcloud = create_pointcloud(3);
+  const GeometrySet geometry = GeometrySet::create_with_pointcloud(pointcloud);
+  const uint64_t hash = geometry_cache_hash(geometry);
+
+  MutableAttributeAccessor attributes = pointcloud->attributes_for_write();
+  SpanAttributeWriter<int> ids = attributes.lookup_or_add_for_write_span<int>("id",
+                                                                             ATTR_DOMAIN_POINT);
+  ids.finish();
+  const uint64_t hash_with_ids = geometry_cache_hash(geometry);
+  EXPECT_NE(hash, hash_with_ids);
+
+  ids = attributes.lookup_for_write_span<int>("id");
+  ids.span[1] = 7;
+  ids.finish();
+  EXPECT_NE(geometry_cache_hash(geometry), hash_with_ids);
+}
+
+TEST_F(geometry_set_cache_test, write_async)
+{
+  geometry_cache_write_async(create_geometry(), filepath_, 42);
+  /* Waits for the file to be written. */
+  BKE_geometry_cache_exit();
+  const std::optional<GeometrySet> result = this->read(42);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_NE(result->get_mesh_for_read(), nullptr);
+  EXPECT_NE(result->get_instances_for_read(), nullptr);
+}
+
+}  // namespace blender::bke::tests
@@ -23,12 +23,14 @@
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
+#include "DNA_space_types.h"
 #include "DNA_texture_types.h"
 #include "DNA_world_types.h"
 
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
 #include "BLI_linklist_lockfree.h"
+#include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
@@ -36,6 +38,7 @@
 
 #include "BKE_global.h" /* only for G.background test */
 #include "BKE_icons.h"
+#include "BKE_idtype.h"
 #include "BKE_studiolight.h"
 
 #include "BLI_sys_types.h" /* for intptr_t support */
@@ -330,6 +333,12 @@ void BKE_previewimg_id_copy(ID *new_id, const ID *old_id)
 
   if (old_prv_p && *old_prv_p) {
     BLI_assert(new_prv_p != nullptr && ELEM(*new_prv_p, nullptr, *old_prv_p));
+    if ((*old_prv_p)->tag & PRV_TAG_DEFFERED) {
+      /* The copy may be saved, load the preview of a linked ID from its library first. */
+      for (int i = 0; i < NUM_ICON_SIZES; i++) {
+        BKE_previewimg_ensure(*old_prv_p, i);
+      }
+    }
     //      const int new_icon_id = get_next_free_id();
 
     //      if (new_icon_id == 0) {
@@ -377,7 +386,13 @@ PreviewImage *BKE_previewimg_id_get(const ID *id)
 void BKE_previewimg_id_free(ID *id)
 {
   PreviewImage **prv_p = BKE_previewimg_id_get_p(id);
-  if (prv_p) {
+  if (prv_p && *prv_p) {
+    if ((*prv_p)->tag & PRV_TAG_DEFFERED_RENDERING) {
+      /* The preview of a linked ID is being loaded in another thread, which frees it when done. */
+      (*prv_p)->tag |= PRV_TAG_DEFFERED_DELETE;
+      *prv_p = nullptr;
+      return;
+    }
     BKE_previewimg_free(prv_p);
   }
 }
@@ -417,6 +432,37 @@ void BKE_previewimg_id_custom_set(ID *id, const char *filepath)
   }
 }
 
+void BKE_previewimg_id_library_deferred_set(ID *id)
+{
+  BLI_assert(ID_IS_LINKED(id));
+  PreviewImage **prv_p = BKE_previewimg_id_get_p(id);
+  if (prv_p == nullptr) {
+    return;
+  }
+
+  /* Same path as used by the file browser to show previews of IDs in a blend file. */
+  char filepath[FILE_MAX_LIBEXTRA];
+  BLI_path_join(filepath,
+                sizeof(filepath),
+                id->lib->filepath_abs,
+                BKE_idtype_idcode_to_name(GS(id->name)),
+                id->name + 2);
+
+  BKE_previewimg_deferred_release(*prv_p);
+  *prv_p = previewimg_deferred_create(filepath, THB_SOURCE_BLEND);
+}
+
+void BKE_previewimg_id_deferred_load(ID *id)
+{
+  PreviewImage *prv = BKE_previewimg_id_get(id);
+  if (prv == nullptr || (prv->tag & PRV_TAG_DEFFERED) == 0) {
+    return;
+  }
+  for (int i = 0; i < NUM_ICON_SIZES; i++) {
+    BKE_previewimg_ensure(prv, i);
+  }
+}
+
 bool BKE_previewimg_id_supports_jobs(const ID *id)
 {
   return ELEM(GS(id->name), ID_OB, ID_MA, ID_TE, ID_LA, ID_WO, ID_IM, ID_BR, ID_GR);
@@ -45,6 +45,7 @@
 #include "BKE_context.h"
 #include "BKE_global.h"
 #include "BKE_gpencil.h"
+#include "BKE_icons.h"
 #include "BKE_idprop.h"
 #include "BKE_idtype.h"
 #include "BKE_key.h"
@@ -188,6 +189,10 @@ void BKE_lib_id_clear_library_data(Main *bmain, ID *id, const int flags)
 
   lib_id_library_local_paths(bmain, id->lib, id);
 
+  /* The preview of a linked ID may only be loaded on demand from its library, local IDs have to
+   * keep it in memory so it is saved with them. */
+  BKE_previewimg_id_deferred_load(id);
+
   id_fake_user_clear(id);
 
   id->lib = NULL;
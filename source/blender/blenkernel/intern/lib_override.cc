@@ -3782,7 +3782,13 @@ static void lib_override_id_swap(Main *bmain, ID *id_local, ID *id_temp)
   id_local->tag |= (id_temp->tag & LIB_TAG_LIB_OVERRIDE_NEED_RESYNC);
 }
 
-void BKE_lib_override_library_update(Main *bmain, ID *local)
+/**
+ * \param skip_unchanged: Skip overrides whose reference did not change since they were last
+ * updated. Only valid right after reading a file, when the override data is still the one stored
+ * in the file. Other updates (e.g. after resetting override properties) always regenerate the
+ * data from the reference.
+ */
+static void lib_override_library_update(Main *bmain, ID *local, const bool skip_unchanged)
 {
   if (!ID_IS_OVERRIDE_LIBRARY_REAL(local)) {
     return;
@@ -3798,7 +3804,22 @@ void BKE_lib_override_library_update(Main *bmain, ID *local)
   /* Recursively do 'ancestor' overrides first, if any. */
   if (local->override_library->reference->override_library &&
       (local->override_library->reference->tag & LIB_TAG_OVERRIDE_LIBRARY_REFOK) == 0) {
-    BKE_lib_override_library_update(bmain, local->override_library->reference);
+    lib_override_library_update(bmain, local->override_library->reference, skip_unchanged);
+  }
+
+  /* Skip overrides whose reference is the same as when they were last updated (and saved), their
+   * data is then already up to date. Updated 'ancestor' overrides get their hash cleared, so
+   * their users are always updated too. */
+  const uint reference_data_hash = local->override_library->reference->runtime.lib_data_hash;
+  if (skip_unchanged && reference_data_hash != 0 &&
+      reference_data_hash == local->override_library->reference_data_hash &&
+      (local->tag & LIB_TAG_LIB_OVERRIDE_NEED_RESYNC) == 0) {
+    if (local->override_library->storage) {
+      BKE_id_free_ex(bmain, local->override_library->storage, LIB_ID_FREE_NO_UI_USER, true);
+      local->override_library->storage = nullptr;
+    }
+    local->tag |= LIB_TAG_OVERRIDE_LIBRARY_REFOK;
+    return;
   }
 
   /* We want to avoid having to remap here, however creating up-to-date override is much simpler
@@ -3909,6 +3930,14 @@ void BKE_lib_override_library_update(Main *bmain, ID *local)
   }
 
   local->tag |= LIB_TAG_OVERRIDE_LIBRARY_REFOK;
+  /* Overrides that still need a resync must not be skipped on next file load, otherwise the need
+   * for a resync would not be detected anymore. */
+  local->override_library->reference_data_hash = (local->tag &
+                                                  LIB_TAG_LIB_OVERRIDE_NEED_RESYNC) ?
+                                                     0 :
+                                                     reference_data_hash;
+  /* The data does not match what was read from the library file anymore. */
+  local->runtime.lib_data_hash = 0;
 
   /* NOTE: Since we reload full content from linked ID here, potentially from edited local
    * override, we do not really have a way to know *what* is changed, so we need to rely on the
@@ -3918,6 +3947,11 @@ void BKE_lib_override_library_update(Main *bmain, ID *local)
   DEG_relations_tag_update(bmain);
 }
 
+void BKE_lib_override_library_update(Main *bmain, ID *local)
+{
+  lib_override_library_update(bmain, local, false);
+}
+
 void BKE_lib_override_library_main_update(Main *bmain)
 {
   ID *id;
@@ -3931,7 +3965,7 @@ void BKE_lib_override_library_main_update(Main *bmain)
 
   FOREACH_MAIN_ID_BEGIN (bmain, id) {
     if (id->override_library != nullptr) {
-      BKE_lib_override_library_update(bmain, id);
+      lib_override_library_update(bmain, id, true);
     }
   }
   FOREACH_MAIN_ID_END;
@@ -0,0 +1,125 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "BLI_listbase.h"
+
+#include "DNA_ID.h"
+#include "DNA_object_types.h"
+
+#include "RNA_define.h"
+
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_lib_override.h"
+#include "BKE_main.h"
+#include "BKE_main_namemap.h"
+#include "BKE_object.h"
+
+namespace blender::bke::tests {
+
+class lib_override_test : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Object *reference = nullptr;
+  Object *local = nullptr;
+
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    RNA_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    RNA_exit();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    G.main = bmain;
+
+    Library *lib = static_cast<Library *>(BKE_id_new(bmain, ID_LI, "LI"));
+    reference = BKE_object_add_only_object(bmain, OB_EMPTY, "OB");
+    BKE_main_namemap_remove_name(bmain, &reference->id, reference->id.name + 2);
+    reference->id.lib = lib;
+    BKE_main_namemap_get_name(bmain, &reference->id, reference->id.name + 2);
+
+    local = reinterpret_cast<Object *>(
+        BKE_lib_override_library_create_from_id(bmain, &reference->id, false));
+    local->loc[0] = 5.0f;
+    int report_flags = 0;
+    BKE_lib_override_library_operations_create(bmain, &local->id, &report_flags);
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+    G.main = nullptr;
+  }
+
+  /**
+   * Simulate reading the file again: the reference data did not change since the override was
+   * last updated, the hash of the reference read from the library still matches.
+   */
+  void simulate_file_read()
+  {
+    reference->id.runtime.lib_data_hash = 42;
+    local->id.override_library->reference_data_hash = 42;
+    local->id.tag &= ~LIB_TAG_OVERRIDE_LIBRARY_REFOK;
+  }
+};
+
+TEST_F(lib_override_test, unchanged_reference_skipped_on_load)
+{
+  this->simulate_file_read();
+  /* Not covered by the hash, so the data only changes when the override is regenerated. */
+  reference->loc[1] = 3.0f;
+
+  BKE_lib_override_library_main_update(bmain);
+  EXPECT_TRUE(local->id.tag & LIB_TAG_OVERRIDE_LIBRARY_REFOK);
+  EXPECT_EQ(local->loc[0], 5.0f);
+  EXPECT_EQ(local->loc[1], 0.0f);
+}
+
+TEST_F(lib_override_test, changed_reference_updated_on_load)
+{
+  this->simulate_file_read();
+  reference->id.runtime.lib_data_hash = 43;
+  reference->loc[1] = 3.0f;
+
+  BKE_lib_override_library_main_update(bmain);
+  EXPECT_EQ(local->loc[0], 5.0f);
+  EXPECT_EQ(local->loc[1], 3.0f);
+  EXPECT_EQ(local->id.override_library->reference_data_hash, 43);
+}
+
+TEST_F(lib_override_test, reset_after_load_restores_reference_values)
+{
+  this->simulate_file_read();
+  reference->loc[1] = 3.0f;
+  BKE_lib_override_library_main_update(bmain);
+
+  /* The hashes still match, but resetting must regenerate the data from the reference. */
+  BKE_lib_override_library_id_reset(bmain, &local->id, false);
+  EXPECT_TRUE(BLI_listbase_is_empty(&local->id.override_library->properties));
+  EXPECT_EQ(local->loc[0], 0.0f);
+  EXPECT_EQ(local->loc[1], 3.0f);
+}
+
+TEST_F(lib_override_test, update_is_not_skipped)
+{
+  this->simulate_file_read();
+  reference->loc[1] = 3.0f;
+
+  BKE_lib_override_library_update(bmain, &local->id);
+  EXPECT_EQ(local->loc[0], 5.0f);
+  EXPECT_EQ(local->loc[1], 3.0f);
+}
+
+}  // namespace blender::bke::tests
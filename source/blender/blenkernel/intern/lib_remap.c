@@ -8,7 +8,11 @@
 
 #include "CLG_log.h"
 
+#include "MEM_guardedalloc.h"
+
+#include "BLI_ghash.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_collection_types.h"
@@ -403,10 +407,10 @@ static void libblock_remap_data_postprocess_obdata_relink(Main *bmain, Object *o
   }
 }
 
-static void libblock_remap_data_postprocess_nodetree_update(Main *bmain, ID *new_id)
+static void libblock_remap_data_postprocess_nodetree_update(Main *bmain, const GSet *new_ids)
 {
   /* Update all group nodes using a node group. */
-  ntreeUpdateAllUsers(bmain, new_id);
+  ntreeUpdateAllUsersMultiple(bmain, new_ids);
 }
 
 static void libblock_remap_data_update_tags(ID *old_id, ID *new_id, void *user_data)
@@ -443,6 +447,131 @@ static void libblock_remap_reset_remapping_status_callback(ID *old_id,
   }
 }
 
+typedef struct IDRemapUsageScan {
+  const struct IDRemapper *id_remapper;
+  int foreach_id_flags;
+  ID **ids;
+  /** Whether each ID of #ids uses any of the remapped IDs. */
+  bool *ids_use_mapping;
+} IDRemapUsageScan;
+
+typedef struct IDRemapUsageScanID {
+  const struct IDRemapper *id_remapper;
+  bool use_mapping;
+} IDRemapUsageScanID;
+
+static int foreach_libblock_remap_usage_scan_callback(LibraryIDLinkCallbackData *cb_data)
+{
+  const int cb_flag = cb_data->cb_flag;
+  ID **id_p = cb_data->id_pointer;
+
+  if ((cb_flag & IDWALK_CB_EMBEDDED) || *id_p == NULL) {
+    return IDWALK_RET_NOP;
+  }
+
+  /* Same checks as the early exit of #foreach_libblock_remap_callback. */
+  IDRemapperApplyOptions id_remapper_options = ID_REMAP_APPLY_DEFAULT;
+  if (cb_flag & IDWALK_CB_NEVER_SELF) {
+    id_remapper_options |= ID_REMAP_APPLY_UNMAP_WHEN_REMAPPING_TO_SELF;
+  }
+  IDRemapUsageScanID *scan_id = cb_data->user_data;
+  const IDRemapperApplyResult expected_mapping_result = BKE_id_remapper_get_mapping_result(
+      scan_id->id_remapper, *id_p, id_remapper_options, cb_data->id_self);
+  if (ELEM(expected_mapping_result,
+           ID_REMAP_RESULT_SOURCE_UNAVAILABLE,
+           ID_REMAP_RESULT_SOURCE_NOT_MAPPABLE)) {
+    return IDWALK_RET_NOP;
+  }
+
+  scan_id->use_mapping = true;
+  return IDWALK_RET_STOP_ITER;
+}
+
+static void libblock_remap_usage_scan_fn(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  IDRemapUsageScan *scan = userdata;
+  IDRemapUsageScanID scan_id = {.id_remapper = scan->id_remapper, .use_mapping = false};
+  BKE_library_foreach_ID_link(NULL,
+                              scan->ids[i],
+                              foreach_libblock_remap_usage_scan_callback,
+                              &scan_id,
+                              scan->foreach_id_flags | IDWALK_READONLY);
+  scan->ids_use_mapping[i] = scan_id.use_mapping;
+}
+
+/**
+ * Find which IDs of \a bmain actually use one of the remapped IDs. Only reads ID pointers, so
+ * this can be done in parallel, leaving the (much smaller) set of IDs to actually remap, which
+ * also affects user counts and depsgraph tags, to a single thread.
+ *
+ * \return An array of the IDs to remap, in the order of \a bmain, or NULL if there are none.
+ */
+static ID **libblock_remap_usage_scan(Main *bmain,
+                                      const struct IDRemapper *id_remapper,
+                                      const int foreach_id_flags,
+                                      int *r_ids_num)
+{
+  ID *id_curr;
+  int ids_num = 0;
+
+  FOREACH_MAIN_ID_BEGIN (bmain, id_curr) {
+    const uint64_t can_use_filter_id = BKE_library_id_can_use_filter_id(id_curr);
+    if (BKE_id_remapper_has_mapping_for(id_remapper, can_use_filter_id)) {
+      ids_num++;
+    }
+  }
+  FOREACH_MAIN_ID_END;
+
+  *r_ids_num = 0;
+  if (ids_num == 0) {
+    return NULL;
+  }
+
+  IDRemapUsageScan scan = {
+      .id_remapper = id_remapper,
+      .foreach_id_flags = foreach_id_flags,
+      .ids = MEM_malloc_arrayN((size_t)ids_num, sizeof(ID *), __func__),
+      .ids_use_mapping = MEM_malloc_arrayN((size_t)ids_num, sizeof(bool), __func__),
+  };
+
+  int i = 0;
+  FOREACH_MAIN_ID_BEGIN (bmain, id_curr) {
+    const uint64_t can_use_filter_id = BKE_library_id_can_use_filter_id(id_curr);
+    if (BKE_id_remapper_has_mapping_for(id_remapper, can_use_filter_id)) {
+      scan.ids[i++] = id_curr;
+    }
+  }
+  FOREACH_MAIN_ID_END;
+
+  /* Looping over the ID pointers of a scene re-syncs its view layers when they are out of sync,
+   * which modifies data shared between threads. Sync them before the parallel scan, so that it
+   * really only reads. */
+  BKE_main_view_layers_synced_ensure(bmain);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, ids_num, &scan, libblock_remap_usage_scan_fn, &settings);
+
+  /* Compact in place, keeping the order of Main. */
+  int used_num = 0;
+  for (i = 0; i < ids_num; i++) {
+    if (scan.ids_use_mapping[i]) {
+      scan.ids[used_num++] = scan.ids[i];
+    }
+  }
+  MEM_freeN(scan.ids_use_mapping);
+
+  if (used_num == 0) {
+    MEM_freeN(scan.ids);
+    return NULL;
+  }
+  *r_ids_num = used_num;
+  return scan.ids;
+}
+
 /**
  * Execute the 'data' part of the remapping (that is, all ID pointers from other ID data-blocks).
  *
@@ -495,45 +624,181 @@ static void libblock_remap_data(Main *bmain,
         NULL, id, foreach_libblock_remap_callback, &id_remap_data, foreach_id_flags);
   }
   else {
-    /* Note that this is a very 'brute force' approach,
-     * maybe we could use some depsgraph to only process objects actually using given old_id...
-     * sounds rather unlikely currently, though, so this will do for now. */
-    ID *id_curr;
-
-    FOREACH_MAIN_ID_BEGIN (bmain, id_curr) {
-      const uint64_t can_use_filter_id = BKE_library_id_can_use_filter_id(id_curr);
-      const bool has_mapping = BKE_id_remapper_has_mapping_for(id_remapper, can_use_filter_id);
-
-      /* Continue when id_remapper doesn't have any mappings that can be used by id_curr. */
-      if (!has_mapping) {
-        continue;
-      }
+    /* Note that this is a very 'brute force' approach, every ID pointer of the whole Main is
+     * checked. That check is done in parallel first, so that only IDs actually using one of the
+     * remapped IDs are processed here. */
+    int ids_num;
+    ID **ids = libblock_remap_usage_scan(bmain, id_remapper, foreach_id_flags, &ids_num);
 
+    for (int i = 0; i < ids_num; i++) {
       /* Note that we cannot skip indirect usages of old_id
        * here (if requested), we still need to check it for the
        * user count handling...
        * XXX No more true (except for debug usage of those
        * skipping counters). */
-      id_remap_data.id_owner = id_curr;
+      id_remap_data.id_owner = ids[i];
       libblock_remap_data_preprocess(id_remap_data.id_owner, remap_type, id_remapper);
       BKE_library_foreach_ID_link(
-          NULL, id_curr, foreach_libblock_remap_callback, &id_remap_data, foreach_id_flags);
+          NULL, ids[i], foreach_libblock_remap_callback, &id_remap_data, foreach_id_flags);
     }
-    FOREACH_MAIN_ID_END;
+    MEM_SAFE_FREE(ids);
   }
 
   BKE_id_remapper_iter(id_remapper, libblock_remap_data_update_tags, &id_remap_data);
 }
 
+/**
+ * Post-processing needed by a whole set of remapped ID pairs. It is gathered while iterating over
+ * the ID pairs, and only done once for the whole batch in #libblock_remap_postprocess_multiple,
+ * since most of it loops over the whole Main database.
+ */
+typedef struct LibBlockRemapPostprocessData {
+  bool do_object_remove_nulls;
+  bool do_object_remove_duplicates;
+  bool do_collection_remove_nulls;
+  bool do_collection_relations_rebuild;
+  /** Remapped objects, to find their meta-ball basis. */
+  LinkNode *old_objects;
+  /** New obdata IDs, to update the objects using them. */
+  GSet *new_obdata_ids;
+} LibBlockRemapPostprocessData;
+
+static void libblock_remap_postprocess_data_init(LibBlockRemapPostprocessData *post)
+{
+  memset(post, 0, sizeof(*post));
+  post->new_obdata_ids = BLI_gset_ptr_new(__func__);
+}
+
+static void libblock_remap_postprocess_data_free(LibBlockRemapPostprocessData *post)
+{
+  BLI_linklist_free(post->old_objects, NULL);
+  BLI_gset_free(post->new_obdata_ids, NULL);
+}
+
+/** Gather the collection and object post-processing needed by a remapped object or collection. */
+static void libblock_remap_postprocess_tag_collections(LibBlockRemapPostprocessData *post,
+                                                       ID *old_id,
+                                                       ID *new_id)
+{
+  switch (GS(old_id->name)) {
+    case ID_OB:
+      if (new_id == NULL) {
+        post->do_object_remove_nulls = true;
+      }
+      else {
+        post->do_object_remove_duplicates = true;
+      }
+      BLI_linklist_prepend(&post->old_objects, old_id);
+      break;
+    case ID_GR:
+      if (new_id == NULL) {
+        post->do_collection_remove_nulls = true;
+      }
+      else {
+        post->do_collection_relations_rebuild = true;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * Same as calling the object, collection and obdata post-processing for each remapped ID pair,
+ * but looping over the Main database only once.
+ *
+ * \param ids: The IDs whose usages were remapped, or NULL if all of Main was processed. When
+ * given, only the collections owned by these IDs and the objects among them are processed.
+ */
+static void libblock_remap_postprocess_multiple(Main *bmain,
+                                                LibBlockRemapPostprocessData *post,
+                                                LinkNode *ids)
+{
+  if (post->do_object_remove_nulls) {
+    /* In case we unlinked objects, they have already been removed from the scenes and their
+     * collections. We still have to remove the NULL children from collections not used in any
+     * scene. */
+    BKE_collections_object_remove_nulls(bmain);
+  }
+  if (post->do_object_remove_duplicates) {
+    /* Remapping may have created duplicates of CollectionObject pointing to the same object
+     * within the same collection. */
+    BKE_collections_object_remove_duplicates(bmain);
+  }
+  if (post->do_collection_remove_nulls) {
+    if (ids == NULL) {
+      /* See #libblock_remap_data_postprocess_collection_update. */
+      BKE_collections_child_remove_nulls(bmain, NULL, NULL);
+    }
+    else {
+      /* NOTE: here we know which collections we have affected, so at least for NULL children
+       * detection we can only process those.
+       * This is also a required fix in case an ID would not be in Main anymore, which can happen
+       * e.g. when called from `id_delete`. */
+      for (LinkNode *ln_iter = ids; ln_iter != NULL; ln_iter = ln_iter->next) {
+        ID *id_iter = ln_iter->link;
+        if (ELEM(GS(id_iter->name), ID_SCE, ID_GR)) {
+          Collection *owner_collection = (GS(id_iter->name) == ID_GR) ?
+                                             (Collection *)id_iter :
+                                             ((Scene *)id_iter)->master_collection;
+          BKE_collections_child_remove_nulls(bmain, owner_collection, NULL);
+        }
+      }
+    }
+  }
+  if (post->do_collection_relations_rebuild) {
+    /* NOTE: Also takes care of duplicated child collections that remapping may have created. */
+    BKE_main_collections_parent_relations_rebuild(bmain);
+  }
+  if (post->old_objects != NULL || post->do_collection_remove_nulls ||
+      post->do_collection_relations_rebuild) {
+    BKE_main_collection_sync_remap(bmain);
+  }
+
+  const bool do_obdata_relink = BLI_gset_len(post->new_obdata_ids) != 0;
+  const bool do_obdata_relink_main = do_obdata_relink && ids == NULL;
+  if (post->old_objects != NULL || do_obdata_relink_main) {
+    for (Object *ob = bmain->objects.first; ob != NULL; ob = ob->id.next) {
+      if (post->old_objects != NULL && ob->type == OB_MBALL && BKE_mball_is_basis(ob)) {
+        for (LinkNode *link = post->old_objects; link != NULL; link = link->next) {
+          if (BKE_mball_is_same_group(ob, link->link)) {
+            DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
+            break;
+          }
+        }
+      }
+      if (do_obdata_relink_main && ob->data != NULL &&
+          BLI_gset_haskey(post->new_obdata_ids, ob->data)) {
+        libblock_remap_data_postprocess_obdata_relink(bmain, ob, ob->data);
+      }
+    }
+  }
+  if (do_obdata_relink && ids != NULL) {
+    for (LinkNode *ln_iter = ids; ln_iter != NULL; ln_iter = ln_iter->next) {
+      ID *id_iter = ln_iter->link;
+      if (GS(id_iter->name) != ID_OB) {
+        continue;
+      }
+      Object *ob = (Object *)id_iter;
+      if (ob->data != NULL && BLI_gset_haskey(post->new_obdata_ids, ob->data)) {
+        libblock_remap_data_postprocess_obdata_relink(bmain, ob, ob->data);
+      }
+    }
+  }
+}
+
 typedef struct LibblockRemapMultipleUserData {
   Main *bmain;
   short remap_flags;
+
+  LibBlockRemapPostprocessData post;
+  /** All new IDs (for node trees). */
+  GSet *new_ids;
 } LibBlockRemapMultipleUserData;
 
 static void libblock_remap_foreach_idpair_cb(ID *old_id, ID *new_id, void *user_data)
 {
   LibBlockRemapMultipleUserData *data = user_data;
-  Main *bmain = data->bmain;
   const short remap_flags = data->remap_flags;
 
   BLI_assert(old_id != NULL);
@@ -580,12 +845,8 @@ static void libblock_remap_foreach_idpair_cb(ID *old_id, ID *new_id, void *user_
    * Maybe we should do a per-ID callback for this instead? */
   switch (GS(old_id->name)) {
     case ID_OB:
-      libblock_remap_data_postprocess_object_update(
-          bmain, (Object *)old_id, (Object *)new_id, true);
-      break;
     case ID_GR:
-      libblock_remap_data_postprocess_collection_update(
-          bmain, NULL, (Collection *)old_id, (Collection *)new_id);
+      libblock_remap_postprocess_tag_collections(&data->post, old_id, new_id);
       break;
     case ID_ME:
     case ID_CU_LEGACY:
@@ -594,27 +855,37 @@ static void libblock_remap_foreach_idpair_cb(ID *old_id, ID *new_id, void *user_
     case ID_PT:
     case ID_VO:
       if (new_id) { /* Only affects us in case obdata was relinked (changed). */
-        for (Object *ob = bmain->objects.first; ob; ob = ob->id.next) {
-          libblock_remap_data_postprocess_obdata_relink(bmain, ob, new_id);
-        }
+        BLI_gset_add(data->post.new_obdata_ids, new_id);
       }
       break;
     default:
       break;
   }
 
+  if (new_id) {
+    BLI_gset_add(data->new_ids, new_id);
+  }
+
+  BKE_libblock_runtime_reset_remapping_status(old_id);
+}
+
+/**
+ * Same as calling the object, collection, obdata and node tree post-processing for each remapped
+ * ID pair, but looping over the Main database only once.
+ */
+static void libblock_remap_multiple_postprocess(LibBlockRemapMultipleUserData *data)
+{
+  Main *bmain = data->bmain;
+
+  libblock_remap_postprocess_multiple(bmain, &data->post, NULL);
+
   /* Node trees may virtually use any kind of data-block... */
   /* XXX Yuck!!!! nodetree update can do pretty much any thing when talking about py nodes,
    *     including creating new data-blocks (see T50385), so we need to unlock main here. :(
    *     Why can't we have re-entrent locks? */
   BKE_main_unlock(bmain);
-  libblock_remap_data_postprocess_nodetree_update(bmain, new_id);
+  libblock_remap_data_postprocess_nodetree_update(bmain, data->new_ids);
   BKE_main_lock(bmain);
-
-  /* Full rebuild of DEG! */
-  DEG_relations_tag_update(bmain);
-
-  BKE_libblock_runtime_reset_remapping_status(old_id);
 }
 
 void BKE_libblock_remap_multiple_locked(Main *bmain,
@@ -631,8 +902,14 @@ void BKE_libblock_remap_multiple_locked(Main *bmain,
   LibBlockRemapMultipleUserData user_data = {0};
   user_data.bmain = bmain;
   user_data.remap_flags = remap_flags;
+  libblock_remap_postprocess_data_init(&user_data.post);
+  user_data.new_ids = BLI_gset_ptr_new(__func__);
 
   BKE_id_remapper_iter(mappings, libblock_remap_foreach_idpair_cb, &user_data);
+  libblock_remap_multiple_postprocess(&user_data);
+
+  libblock_remap_postprocess_data_free(&user_data.post);
+  BLI_gset_free(user_data.new_ids, NULL);
 
   /* We assume editors do not hold references to their IDs... This is false in some cases
    * (Image is especially tricky here),
@@ -697,63 +974,27 @@ void BKE_libblock_unlink(Main *bmain,
  */
 
 typedef struct LibblockRelinkMultipleUserData {
-  Main *bmain;
-  LinkNode *ids;
+  /** Whether some of the relinked IDs own a collection hierarchy (scenes and collections). */
+  bool has_collection_owners;
+
+  LibBlockRemapPostprocessData post;
 } LibBlockRelinkMultipleUserData;
 
 static void libblock_relink_foreach_idpair_cb(ID *old_id, ID *new_id, void *user_data)
 {
   LibBlockRelinkMultipleUserData *data = user_data;
-  Main *bmain = data->bmain;
-  LinkNode *ids = data->ids;
 
   BLI_assert(old_id != NULL);
   BLI_assert((new_id == NULL) || GS(old_id->name) == GS(new_id->name));
   BLI_assert(old_id != new_id);
 
-  bool is_object_update_processed = false;
-  for (LinkNode *ln_iter = ids; ln_iter != NULL; ln_iter = ln_iter->next) {
-    ID *id_iter = ln_iter->link;
+  if (data->has_collection_owners) {
+    libblock_remap_postprocess_tag_collections(&data->post, old_id, new_id);
+  }
 
-    /* Some after-process updates.
-     * This is a bit ugly, but cannot see a way to avoid it.
-     * Maybe we should do a per-ID callback for this instead?
-     */
-    switch (GS(id_iter->name)) {
-      case ID_SCE:
-      case ID_GR: {
-        /* NOTE: here we know which collection we have affected, so at lest for NULL children
-         * detection we can only process that one.
-         * This is also a required fix in case `id` would not be in Main anymore, which can happen
-         * e.g. when called from `id_delete`. */
-        Collection *owner_collection = (GS(id_iter->name) == ID_GR) ?
-                                           (Collection *)id_iter :
-                                           ((Scene *)id_iter)->master_collection;
-        switch (GS(old_id->name)) {
-          case ID_OB:
-            if (!is_object_update_processed) {
-              libblock_remap_data_postprocess_object_update(
-                  bmain, (Object *)old_id, (Object *)new_id, true);
-              is_object_update_processed = true;
-            }
-            break;
-          case ID_GR:
-            libblock_remap_data_postprocess_collection_update(
-                bmain, owner_collection, (Collection *)old_id, (Collection *)new_id);
-            break;
-          default:
-            break;
-        }
-        break;
-      }
-      case ID_OB:
-        if (new_id != NULL) { /* Only affects us in case obdata was relinked (changed). */
-          libblock_remap_data_postprocess_obdata_relink(bmain, (Object *)id_iter, new_id);
-        }
-        break;
-      default:
-        break;
-    }
+  /* Only affects objects in case obdata was relinked (changed). */
+  if (new_id != NULL && OB_DATA_SUPPORT_ID(GS(new_id->name))) {
+    BLI_gset_add(data->post.new_obdata_ids, new_id);
   }
 }
 
@@ -773,10 +1014,19 @@ void BKE_libblock_relink_multiple(Main *bmain,
   switch (remap_type) {
     case ID_REMAP_TYPE_REMAP: {
       LibBlockRelinkMultipleUserData user_data = {0};
-      user_data.bmain = bmain;
-      user_data.ids = ids;
+      libblock_remap_postprocess_data_init(&user_data.post);
+      for (LinkNode *ln_iter = ids; ln_iter != NULL; ln_iter = ln_iter->next) {
+        ID *id_iter = ln_iter->link;
+        if (ELEM(GS(id_iter->name), ID_SCE, ID_GR)) {
+          user_data.has_collection_owners = true;
+          break;
+        }
+      }
 
       BKE_id_remapper_iter(id_remapper, libblock_relink_foreach_idpair_cb, &user_data);
+      libblock_remap_postprocess_multiple(bmain, &user_data.post, ids);
+
+      libblock_remap_postprocess_data_free(&user_data.post);
       break;
     }
     case ID_REMAP_TYPE_CLEANUP: {
@@ -897,6 +1147,19 @@ static void libblock_relink_to_newid_prepare_data(Main *bmain,
   BKE_library_foreach_ID_link(bmain, id, id_relink_to_newid_looper, relink_data, 0);
 }
 
+static void libblock_relink_to_newid_apply(Main *bmain,
+                                           RelinkToNewIDData *relink_data,
+                                           const int remap_flag)
+{
+  const short remap_flag_final = remap_flag | ID_REMAP_SKIP_INDIRECT_USAGE |
+                                 ID_REMAP_SKIP_OVERRIDE_LIBRARY;
+  BKE_libblock_relink_multiple(
+      bmain, relink_data->ids, ID_REMAP_TYPE_REMAP, relink_data->id_remapper, remap_flag_final);
+
+  BKE_id_remapper_free(relink_data->id_remapper);
+  BLI_linklist_free(relink_data->ids, NULL);
+}
+
 void BKE_libblock_relink_to_newid(Main *bmain, ID *id, const int remap_flag)
 {
   if (ID_IS_LINKED(id)) {
@@ -909,11 +1172,22 @@ void BKE_libblock_relink_to_newid(Main *bmain, ID *id, const int remap_flag)
 
   libblock_relink_to_newid_prepare_data(bmain, id, &relink_data);
 
-  const short remap_flag_final = remap_flag | ID_REMAP_SKIP_INDIRECT_USAGE |
-                                 ID_REMAP_SKIP_OVERRIDE_LIBRARY;
-  BKE_libblock_relink_multiple(
-      bmain, relink_data.ids, ID_REMAP_TYPE_REMAP, relink_data.id_remapper, remap_flag_final);
+  libblock_relink_to_newid_apply(bmain, &relink_data, remap_flag);
+}
+
+void BKE_libblock_relink_to_newid_multiple(Main *bmain, LinkNode *ids, const int remap_flag)
+{
+  /* We do not want to have those cached relationship data here. */
+  BLI_assert(bmain->relations == NULL);
+
+  RelinkToNewIDData relink_data = {.ids = NULL, .id_remapper = BKE_id_remapper_create()};
+
+  for (LinkNode *ln_iter = ids; ln_iter != NULL; ln_iter = ln_iter->next) {
+    ID *id = ln_iter->link;
+    if (!ID_IS_LINKED(id)) {
+      libblock_relink_to_newid_prepare_data(bmain, id, &relink_data);
+    }
+  }
 
-  BKE_id_remapper_free(relink_data.id_remapper);
-  BLI_linklist_free(relink_data.ids, NULL);
+  libblock_relink_to_newid_apply(bmain, &relink_data, remap_flag);
 }
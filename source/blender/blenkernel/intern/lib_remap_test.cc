@@ -2,10 +2,14 @@
  * Copyright 2022 Blender Foundation. */
 #include "testing/testing.h"
 
+#include "BLI_listbase.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "CLG_log.h"
 
+#include "DNA_collection_types.h"
+#include "DNA_layer_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_node_types.h"
 #include "DNA_object_types.h"
@@ -14,9 +18,11 @@
 #include "RNA_define.h"
 
 #include "BKE_appdir.h"
+#include "BKE_collection.h"
 #include "BKE_context.h"
 #include "BKE_global.h"
 #include "BKE_idtype.h"
+#include "BKE_layer.h"
 #include "BKE_lib_id.h"
 #include "BKE_lib_remap.h"
 #include "BKE_main.h"
@@ -351,4 +357,41 @@ TEST(lib_remap, never_null_usage_flag_requested_on_remap)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name View Layers
+ * \{ */
+
+TEST(lib_remap, remap_with_view_layers_out_of_sync)
+{
+  Context<MeshObjectTestData> context;
+  Main *bmain = context.test_data.bmain;
+  Mesh *other_mesh = BKE_mesh_add(bmain, nullptr);
+
+  /* Enough scenes for the usage scan to run in parallel. Adding the object leaves the view layers
+   * of every scene out of sync, they are synced when looping over the ID pointers of the scene. */
+  Vector<Scene *> scenes;
+  for (int i = 0; i < 256; i++) {
+    Scene *scene = BKE_scene_add(bmain, "IDRemapScene");
+    BKE_collection_object_add(bmain, scene->master_collection, context.test_data.object);
+    scenes.append(scene);
+  }
+  for (Scene *scene : scenes) {
+    LISTBASE_FOREACH (ViewLayer *, view_layer, &scene->view_layers) {
+      EXPECT_NE(view_layer->flag & VIEW_LAYER_OUT_OF_SYNC, 0);
+    }
+  }
+
+  BKE_libblock_remap(bmain, context.test_data.mesh, other_mesh, 0);
+  EXPECT_EQ(context.test_data.object->data, other_mesh);
+
+  for (Scene *scene : scenes) {
+    LISTBASE_FOREACH (ViewLayer *, view_layer, &scene->view_layers) {
+      EXPECT_EQ(view_layer->flag & VIEW_LAYER_OUT_OF_SYNC, 0);
+      EXPECT_NE(BKE_view_layer_base_find(view_layer, context.test_data.object), nullptr);
+    }
+  }
+}
+
+/** \} */
+
 }  // namespace blender::bke::tests
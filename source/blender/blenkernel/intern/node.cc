@@ -3840,6 +3840,28 @@ void ntreeUpdateAllUsers(Main *main, ID *id)
   }
 }
 
+void ntreeUpdateAllUsersMultiple(Main *main, const GSet *ids)
+{
+  if (BLI_gset_len(ids) == 0) {
+    return;
+  }
+
+  bool need_update = false;
+
+  FOREACH_NODETREE_BEGIN (main, ntree, owner_id) {
+    for (bNode *node : ntree->all_nodes()) {
+      if (node->id != nullptr && BLI_gset_haskey(ids, node->id)) {
+        BKE_ntree_update_tag_node_property(ntree, node);
+        need_update = true;
+      }
+    }
+  }
+  FOREACH_NODETREE_END;
+  if (need_update) {
+    BKE_ntree_update_main(main, nullptr);
+  }
+}
+
 /* ************* node type access ********** */
 
 void nodeLabel(const bNodeTree *ntree, const bNode *node, char *label, int maxlen)
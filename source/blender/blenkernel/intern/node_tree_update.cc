@@ -363,6 +363,20 @@ class NodeTreeMainUpdater {
         }
       }
 
+      if (result.output_changed) {
+        if (ntree->type == NTREE_GEOMETRY) {
+          /* Geometry cached on disk by modifiers using this tree is outdated now. */
+          relations_.ensure_modifier_users();
+          for (const ObjectModifierPair &pair : relations_.get_modifier_users(ntree)) {
+            Object *object = pair.first;
+            ModifierData *md = pair.second;
+            if (md->type == eModifierType_Nodes) {
+              MOD_nodes_cache_invalidate(object, (NodesModifierData *)md);
+            }
+          }
+        }
+      }
+
       if (params_) {
         relations_.ensure_owner_ids();
         ID *id = relations_.get_owner_id(ntree);
@@ -60,6 +60,18 @@ FileReader *BLI_filereader_new_zstd(FileReader *base) ATTR_WARN_UNUSED_RESULT AT
 /** Create #FileReader from applying `Gzip` decompression on an underlying file. */
 FileReader *BLI_filereader_new_gzip(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
+/**
+ * Access the data of a #FileReader created with #BLI_filereader_new_mmap in place, without
+ * copying it. Returns NULL for other readers or when the range is not inside the file.
+ *
+ * The memory stays valid until the reader is closed and must not be written to. Pages that
+ * cannot be read because of an IO error read as zeros, so #BLI_filereader_mmap_io_error has to be
+ * checked after accessing the memory.
+ */
+const void *BLI_filereader_mmap_data(FileReader *reader, off64_t offset, size_t size)
+    ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+bool BLI_filereader_mmap_io_error(FileReader *reader) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+
 #ifdef __cplusplus
 }
 #endif
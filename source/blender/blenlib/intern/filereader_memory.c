@@ -127,3 +127,22 @@ FileReader *BLI_filereader_new_mmap(int filedes)
 
   return (FileReader *)mem;
 }
+
+const void *BLI_filereader_mmap_data(FileReader *reader, off64_t offset, size_t size)
+{
+  if (reader->close != memory_close_mmap) {
+    return NULL;
+  }
+  MemoryReader *mem = (MemoryReader *)reader;
+  if (offset < 0 || (size_t)offset + size > mem->length || BLI_mmap_any_io_error(mem->mmap)) {
+    return NULL;
+  }
+  return (const char *)BLI_mmap_get_pointer(mem->mmap) + offset;
+}
+
+bool BLI_filereader_mmap_io_error(FileReader *reader)
+{
+  BLI_assert(reader->close == memory_close_mmap);
+  MemoryReader *mem = (MemoryReader *)reader;
+  return BLI_mmap_any_io_error(mem->mmap);
+}
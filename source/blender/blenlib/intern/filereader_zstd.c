@@ -11,10 +11,30 @@
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
 #include "BLI_filereader.h"
+#include "BLI_listbase.h"
 #include "BLI_math_base.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
+/* Maximum number of frames that are decompressed ahead of the current read position.
+ * Frames written by Blender are 1mb each, so this also bounds the extra memory usage. */
+#define ZSTD_READ_AHEAD_FRAMES 4
+
+/* A frame that is decompressed on a worker thread while earlier frames are being read. */
+typedef struct {
+  /* -1 when the slot is unused. */
+  int frame;
+  bool is_running;
+  bool success;
+
+  ZSTD_DCtx *ctx;
+  char *compressed_data;
+  size_t compressed_size;
+  char *uncompressed_data;
+  size_t uncompressed_size;
+} ZstdReadAheadTask;
+
 typedef struct {
   FileReader reader;
 
@@ -31,6 +51,10 @@ typedef struct {
 
     char *cached_content;
     int cached_frame;
+
+    ListBase threadpool;
+    ZstdReadAheadTask *read_ahead;
+    int read_ahead_num;
   } seek;
 } ZstdReader;
 
@@ -154,6 +178,151 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
+/* Read the compressed data of a frame from the base file. */
+static char *zstd_read_frame_compressed(ZstdReader *zstd, int frame, size_t *r_size)
+{
+  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
+  char *compressed_data = MEM_mallocN(compressed_size, __func__);
+  if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
+      zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size) {
+    MEM_freeN(compressed_data);
+    return NULL;
+  }
+  *r_size = compressed_size;
+  return compressed_data;
+}
+
+static size_t zstd_frame_uncompressed_size(ZstdReader *zstd, int frame)
+{
+  return zstd->seek.uncompressed_ofs[frame + 1] - zstd->seek.uncompressed_ofs[frame];
+}
+
+static void *zstd_read_ahead_task(void *userdata)
+{
+  ZstdReadAheadTask *task = userdata;
+
+  size_t res = ZSTD_decompressDCtx(task->ctx,
+                                   task->uncompressed_data,
+                                   task->uncompressed_size,
+                                   task->compressed_data,
+                                   task->compressed_size);
+  task->success = !ZSTD_isError(res) && res == task->uncompressed_size;
+
+  MEM_freeN(task->compressed_data);
+  task->compressed_data = NULL;
+  return NULL;
+}
+
+/* Wait for the task to finish and return the slot to the unused state. */
+static void zstd_read_ahead_discard(ZstdReader *zstd, ZstdReadAheadTask *task)
+{
+  if (task->is_running) {
+    BLI_threadpool_remove(&zstd->seek.threadpool, task);
+    task->is_running = false;
+  }
+  MEM_SAFE_FREE(task->uncompressed_data);
+  task->frame = -1;
+}
+
+/* Take the decompressed content of the frame from the read-ahead tasks.
+ * Returns NULL when the frame wasn't scheduled or failed to decompress. */
+static char *zstd_read_ahead_take(ZstdReader *zstd, int frame)
+{
+  for (int i = 0; i < zstd->seek.read_ahead_num; i++) {
+    ZstdReadAheadTask *task = &zstd->seek.read_ahead[i];
+    if (task->frame != frame) {
+      continue;
+    }
+    BLI_threadpool_remove(&zstd->seek.threadpool, task);
+    task->is_running = false;
+
+    char *uncompressed_data = NULL;
+    if (task->success) {
+      uncompressed_data = task->uncompressed_data;
+      task->uncompressed_data = NULL;
+    }
+    zstd_read_ahead_discard(zstd, task);
+    return uncompressed_data;
+  }
+  return NULL;
+}
+
+/* Start decompressing the frames following the given one on worker threads,
+ * reusing the slots of frames that are no longer expected to be read. */
+static void zstd_read_ahead_schedule(ZstdReader *zstd, int frame)
+{
+  const int first = frame + 1;
+  const int last = min_ii(frame + zstd->seek.read_ahead_num, zstd->seek.frames_num - 1);
+
+  for (int next = first; next <= last; next++) {
+    ZstdReadAheadTask *free_task = NULL;
+    bool is_scheduled = false;
+    for (int i = 0; i < zstd->seek.read_ahead_num; i++) {
+      ZstdReadAheadTask *task = &zstd->seek.read_ahead[i];
+      if (task->frame == next) {
+        is_scheduled = true;
+        break;
+      }
+      if (free_task == NULL && (task->frame < first || task->frame > last)) {
+        free_task = task;
+      }
+    }
+    if (is_scheduled) {
+      continue;
+    }
+    if (free_task == NULL) {
+      break;
+    }
+    zstd_read_ahead_discard(zstd, free_task);
+
+    /* Reading from the base file is not thread-safe, so only the decompression is threaded. */
+    free_task->compressed_data = zstd_read_frame_compressed(
+        zstd, next, &free_task->compressed_size);
+    if (free_task->compressed_data == NULL) {
+      break;
+    }
+    free_task->frame = next;
+    free_task->success = false;
+    free_task->uncompressed_size = zstd_frame_uncompressed_size(zstd, next);
+    free_task->uncompressed_data = MEM_mallocN(free_task->uncompressed_size, __func__);
+    free_task->is_running = true;
+    BLI_threadpool_insert(&zstd->seek.threadpool, free_task);
+  }
+}
+
+static void zstd_read_ahead_init(ZstdReader *zstd)
+{
+  /* Leave one thread for the main reading logic, which consumes the decompressed frames. */
+  const int num = min_ii(BLI_system_thread_count() - 1, ZSTD_READ_AHEAD_FRAMES);
+  if (num < 1 || zstd->seek.frames_num < 2) {
+    return;
+  }
+
+  zstd->seek.read_ahead_num = num;
+  zstd->seek.read_ahead = MEM_calloc_arrayN(num, sizeof(ZstdReadAheadTask), __func__);
+  for (int i = 0; i < num; i++) {
+    zstd->seek.read_ahead[i].frame = -1;
+    zstd->seek.read_ahead[i].ctx = ZSTD_createDCtx();
+  }
+  BLI_threadpool_init(&zstd->seek.threadpool, zstd_read_ahead_task, num);
+}
+
+static void zstd_read_ahead_free(ZstdReader *zstd)
+{
+  if (zstd->seek.read_ahead == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < zstd->seek.read_ahead_num; i++) {
+    zstd_read_ahead_discard(zstd, &zstd->seek.read_ahead[i]);
+    ZSTD_freeDCtx(zstd->seek.read_ahead[i].ctx);
+  }
+  BLI_threadpool_end(&zstd->seek.threadpool);
+  MEM_freeN(zstd->seek.read_ahead);
+  zstd->seek.read_ahead = NULL;
+  zstd->seek.read_ahead_num = 0;
+}
+
 /* Ensure that the currently loaded frame is the correct one. */
 static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
 {
@@ -164,30 +333,34 @@ static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
 
   /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
   MEM_SAFE_FREE(zstd->seek.cached_content);
+  zstd->seek.cached_frame = -1;
 
-  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
-  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
-                             zstd->seek.uncompressed_ofs[frame];
+  /* Reading is mostly sequential, so the frame was likely decompressed ahead of time. */
+  char *uncompressed_data = zstd_read_ahead_take(zstd, frame);
+  if (uncompressed_data == NULL) {
+    size_t compressed_size;
+    char *compressed_data = zstd_read_frame_compressed(zstd, frame, &compressed_size);
+    if (compressed_data == NULL) {
+      return NULL;
+    }
 
-  char *uncompressed_data = MEM_mallocN(uncompressed_size, __func__);
-  char *compressed_data = MEM_mallocN(compressed_size, __func__);
-  if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
-      zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size) {
+    size_t uncompressed_size = zstd_frame_uncompressed_size(zstd, frame);
+    uncompressed_data = MEM_mallocN(uncompressed_size, __func__);
+    size_t res = ZSTD_decompressDCtx(
+        zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
     MEM_freeN(compressed_data);
-    MEM_freeN(uncompressed_data);
-    return NULL;
-  }
-
-  size_t res = ZSTD_decompressDCtx(
-      zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
-  MEM_freeN(compressed_data);
-  if (ZSTD_isError(res) || res < uncompressed_size) {
-    MEM_freeN(uncompressed_data);
-    return NULL;
+    if (ZSTD_isError(res) || res < uncompressed_size) {
+      MEM_freeN(uncompressed_data);
+      return NULL;
+    }
   }
 
   zstd->seek.cached_frame = frame;
   zstd->seek.cached_content = uncompressed_data;
+
+  if (zstd->seek.read_ahead_num > 0) {
+    zstd_read_ahead_schedule(zstd, frame);
+  }
   return uncompressed_data;
 }
 
@@ -279,6 +452,7 @@ static void zstd_close(FileReader *reader)
 
   ZSTD_freeDCtx(zstd->ctx);
   if (zstd->reader.seek) {
+    zstd_read_ahead_free(zstd);
     MEM_freeN(zstd->seek.uncompressed_ofs);
     MEM_freeN(zstd->seek.compressed_ofs);
     /* When an error has occurred this may be NULL, see: T99744. */
@@ -304,6 +478,7 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
   if (zstd_read_seek_table(zstd)) {
     zstd->reader.read = zstd_read_seekable;
     zstd->reader.seek = zstd_seek;
+    zstd_read_ahead_init(zstd);
   }
   else {
     zstd->reader.read = zstd_read;
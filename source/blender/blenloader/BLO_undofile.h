@@ -27,6 +27,13 @@ typedef struct {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** When true, this chunk doesn't own the memory either, it shares the buffer of a chunk with the
+   * same content at another position of the previous step. Unlike #is_identical, this does not
+   * mean that the data at this position is unchanged. */
+  bool is_deduplicated;
+  /** Hash of the content for chunks of large data blocks, zero for other chunks.
+   * See #BLO_memfile_chunk_add_split. */
+  uint content_hash;
 } MemFileChunk;
 
 typedef struct MemFile {
@@ -43,6 +50,8 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /** Maps a content hash to a reference MemFileChunk of a large data block, if existing. */
+  struct GHash *content_hash_mapping;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -73,6 +82,12 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 void BLO_memfile_write_finalize(MemFileWriteData *mem_data);
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size);
+/**
+ * Add a large block of data, split into chunks at positions that depend on the content.
+ * Inserting or removing data in the middle of the block then only changes the chunks around the
+ * edit, and the following chunks can share memory with the previous step even though they moved.
+ */
+void BLO_memfile_chunk_add_split(MemFileWriteData *mem_data, const char *buf, size_t size);
 
 /* exports */
 
@@ -87,6 +102,12 @@ extern void BLO_memfile_free(MemFile *memfile);
  * to keep list of memfiles consistent, 'first' is always first in list.
  */
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
+/**
+ * Fill `memfile_dst` with chunks that share the buffers of `memfile_src` without copying them.
+ * Chunk buffers are reference counted, so `memfile_dst` stays valid when the undo steps that
+ * created the buffers are freed. Must be freed with #BLO_memfile_free.
+ */
+extern void BLO_memfile_share(const MemFile *memfile_src, MemFile *memfile_dst);
 /**
  * Clear is_identical_future before adding next memfile.
  */
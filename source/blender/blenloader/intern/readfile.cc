@@ -50,11 +50,13 @@
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
 #include "BLI_map.hh"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 
 #include "PIL_time.h"
@@ -64,8 +66,10 @@
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
 #include "BKE_asset.h"
+#include "BKE_blender_version.h"
 #include "BKE_collection.h"
 #include "BKE_global.h" /* for G */
+#include "BKE_icons.h"
 #include "BKE_idprop.h"
 #include "BKE_idtype.h"
 #include "BKE_layer.h"
@@ -1757,6 +1761,35 @@ static void switch_endian_structs(const SDNA *filesdna, BHead *bhead)
   }
 }
 
+/**
+ * Convert the struct array of the block to the current SDNA. Large arrays, like mesh elements in
+ * files from older versions, are split into ranges that are reconstructed in parallel.
+ *
+ * \param data: The data of the block in the file, which does not have to directly follow the
+ * #BHead in memory.
+ */
+static void *read_struct_reconstruct(FileData *fd, const BHead *bh, const void *data)
+{
+  const int new_block_size = DNA_struct_reconstruct_size(fd->reconstruct_info, bh->SDNAnr);
+  if (new_block_size == 0) {
+    return nullptr;
+  }
+
+  void *new_blocks = MEM_callocN(size_t(bh->nr) * size_t(new_block_size), "reconstruct");
+  /* Each task reconstructs at least 64kb of data. */
+  const int64_t grain_size = std::max(int64_t(1), int64_t((1 << 16) / new_block_size));
+  blender::threading::parallel_for(
+      blender::IndexRange(bh->nr), grain_size, [&](const blender::IndexRange range) {
+        DNA_struct_reconstruct_range(fd->reconstruct_info,
+                                     bh->SDNAnr,
+                                     int(range.start()),
+                                     int(range.size()),
+                                     data,
+                                     new_blocks);
+      });
+  return new_blocks;
+}
+
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 {
   void *temp = nullptr;
@@ -1784,6 +1817,18 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
+          /* Reconstruct straight from a memory-mapped file, instead of copying the whole block
+           * into memory first. */
+          const void *mapped_data = BLI_filereader_mmap_data(
+              fd->file, BHEADN_FROM_BHEAD(bh)->file_offset, size_t(bh->len));
+          if (mapped_data != nullptr) {
+            temp = read_struct_reconstruct(fd, bh, mapped_data);
+            if (UNLIKELY(BLI_filereader_mmap_io_error(fd->file))) {
+              fd->flags &= ~FD_FLAGS_FILE_OK;
+              MEM_SAFE_FREE(temp);
+            }
+            return temp;
+          }
           bh = blo_bhead_read_full(fd, bh);
           if (UNLIKELY(bh == nullptr)) {
             fd->flags &= ~FD_FLAGS_FILE_OK;
@@ -1791,7 +1836,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
           }
         }
 #endif
-        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = read_struct_reconstruct(fd, bh, bh + 1);
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -2960,11 +3005,29 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
     return true;
   }
 
+  /* Previews of linked IDs are only needed when drawn, they are loaded from the library file on
+   * demand instead of being kept in memory. Their data is freed with the rest of the unused
+   * file data. */
+  PreviewImage **preview_p = nullptr;
+  if (main->curlib != nullptr && !BLO_read_data_is_undo(&reader)) {
+    preview_p = BKE_previewimg_id_get_p(id);
+    if (preview_p != nullptr && *preview_p != nullptr) {
+      *preview_p = nullptr;
+    }
+    else {
+      preview_p = nullptr;
+    }
+  }
+
   const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
   if (id_type->blend_read_data != nullptr) {
     id_type->blend_read_data(&reader, id);
   }
 
+  if (preview_p != nullptr) {
+    BKE_previewimg_id_library_deferred_set(id);
+  }
+
   /* XXX Very weakly handled currently, see comment in read_libblock() before trying to
    * use it for anything new. */
   bool success = true;
@@ -2990,8 +3053,14 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
   return success;
 }
 
-/* Read all data associated with a datablock into datamap. */
-static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
+/**
+ * Read all data associated with a datablock into datamap.
+ * \param data_hash: Optional, the data of all blocks is added to it.
+ */
+static BHead *read_data_into_datamap(FileData *fd,
+                                     BHead *bhead,
+                                     const char *allocname,
+                                     BLI_HashMurmur2A *data_hash)
 {
   bhead = blo_bhead_next(fd, bhead);
 
@@ -3018,6 +3087,9 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
 
     void *data = read_struct(fd, bhead, allocname);
     if (data) {
+      if (data_hash != nullptr) {
+        BLI_hash_mm2a_add(data_hash, static_cast<const uchar *>(data), MEM_allocN_len(data));
+      }
       oldnewmap_insert(fd->datamap, bhead->old, data, 0);
     }
 
@@ -3337,9 +3409,16 @@ static BHead *read_libblock(FileData *fd,
     *r_id = id_target;
   }
 
+  /* Linked data-blocks referenced by library overrides keep a hash of their data as stored in the
+   * library file, so that the overrides can detect that their reference did not change since they
+   * were last updated. The version is part of the hash, since versioning code may change the data.
+   * Other data-blocks are not hashed, it would only slow down reading them. */
+  const bool use_data_hash = (tag & LIB_TAG_NEED_DATA_HASH) != 0 &&
+                             (fd->flags & FD_FLAGS_IS_MEMFILE) == 0;
+
   /* Set tag for new datablock to indicate lib linking and versioning needs
    * to be done still. */
-  int id_tag = tag | LIB_TAG_NEED_LINK | LIB_TAG_NEW;
+  int id_tag = (tag & ~LIB_TAG_NEED_DATA_HASH) | LIB_TAG_NEED_LINK | LIB_TAG_NEW;
 
   if (bhead->code == ID_LINK_PLACEHOLDER) {
     /* Read placeholder for linked datablock. */
@@ -3355,6 +3434,7 @@ static BHead *read_libblock(FileData *fd,
     }
 
     direct_link_id(fd, main, id_tag, id, id_old);
+    id->runtime.lib_data_hash = 0;
 
     if (main->id_map != nullptr) {
       BKE_main_idmap_insert_id(main->id_map, id);
@@ -3363,12 +3443,19 @@ static BHead *read_libblock(FileData *fd,
     return blo_bhead_next(fd, bhead);
   }
 
+  BLI_HashMurmur2A data_hash;
+  if (use_data_hash) {
+    BLI_hash_mm2a_init(&data_hash, BLENDER_FILE_VERSION * 100 + BLENDER_FILE_SUBVERSION);
+    BLI_hash_mm2a_add(&data_hash, reinterpret_cast<const uchar *>(id), MEM_allocN_len(id));
+  }
+
   /* Read datablock contents.
    * Use convenient malloc name for debugging and better memory link prints. */
   const char *allocname = dataname(idcode);
-  bhead = read_data_into_datamap(fd, bhead, allocname);
+  bhead = read_data_into_datamap(fd, bhead, allocname, use_data_hash ? &data_hash : nullptr);
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
   oldnewmap_clear(fd->datamap);
+  id->runtime.lib_data_hash = use_data_hash ? BLI_hash_mm2a_end(&data_hash) : 0;
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -3405,7 +3492,7 @@ BHead *blo_read_asset_data_block(FileData *fd, BHead *bhead, AssetMetaData **r_a
 {
   BLI_assert(blo_bhead_is_id_valid_type(bhead));
 
-  bhead = read_data_into_datamap(fd, bhead, "asset-data read");
+  bhead = read_data_into_datamap(fd, bhead, "asset-data read", nullptr);
 
   BlendDataReader reader = {fd};
   BLO_read_data_address(&reader, r_asset_data);
@@ -3664,6 +3751,30 @@ static void after_liblink_merged_bmain_process(Main *bmain)
   BKE_main_collections_parent_relations_rebuild(bmain);
 }
 
+/**
+ * Tag the link placeholders of the references of all library overrides read from the given file,
+ * so that the data of these linked data-blocks is hashed when reading them from their library.
+ *
+ * Must be called before #read_libraries, while the override references are still the pointer
+ * values stored in the file. Only references that are linked directly by the file are handled,
+ * overrides of indirectly linked data-blocks never skip their update.
+ */
+static void read_tag_override_references(FileData *fd, Main *bmain)
+{
+  ID *id;
+  FOREACH_MAIN_ID_BEGIN (bmain, id) {
+    if (id->override_library == nullptr || id->override_library->reference == nullptr) {
+      continue;
+    }
+    ID *reference = static_cast<ID *>(
+        oldnewmap_lookup_and_inc(fd->libmap, id->override_library->reference, false));
+    if (reference != nullptr && (reference->tag & LIB_TAG_ID_LINK_PLACEHOLDER)) {
+      reference->tag |= LIB_TAG_NEED_DATA_HASH;
+    }
+  }
+  FOREACH_MAIN_ID_END;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -3688,7 +3799,7 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
   user->subversionfile = bfd->main->subversionfile;
 
   /* read all data into fd->datamap */
-  bhead = read_data_into_datamap(fd, bhead, "user def");
+  bhead = read_data_into_datamap(fd, bhead, "user def", nullptr);
 
   BlendDataReader reader_ = {fd};
   BlendDataReader *reader = &reader_;
@@ -3879,6 +3990,10 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
   }
 
   if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
+    if ((fd->flags & FD_FLAGS_IS_MEMFILE) == 0) {
+      read_tag_override_references(fd, bfd->main);
+    }
+
     fd->reports->duration.libraries = PIL_check_seconds_timer();
     read_libraries(fd, &mainlist);
 
@@ -4630,6 +4745,7 @@ static void read_library_linked_id(
                      library_parent_filepath(mainvar->curlib));
   }
 
+  /* #LIB_TAG_NEED_DATA_HASH is passed on to #read_libblock, which clears it. */
   id->tag &= ~LIB_TAG_ID_LINK_PLACEHOLDER;
   id->flag &= ~LIB_INDIRECT_WEAK_LINK;
 
@@ -4650,7 +4766,10 @@ static void read_library_linked_id(
 
     /* Generate a placeholder for this ID (simplified version of read_libblock actually...). */
     if (r_id) {
-      *r_id = is_valid ? create_placeholder(mainvar, GS(id->name), id->name + 2, id->tag) :
+      *r_id = is_valid ? create_placeholder(mainvar,
+                                            GS(id->name),
+                                            id->name + 2,
+                                            id->tag & ~LIB_TAG_NEED_DATA_HASH) :
                          nullptr;
     }
   }
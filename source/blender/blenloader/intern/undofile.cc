@@ -5,12 +5,14 @@
  * \ingroup blenloader
  */
 
+#include <atomic>
 #include <cerrno>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
+#include <new>
 
 /* open/close */
 #ifndef _WIN32
@@ -25,6 +27,8 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -38,13 +42,63 @@
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/* Content-defined splitting of large data blocks, see #BLO_memfile_chunk_add_split.
+ * The average chunk size is the minimum size plus the inverse probability of a split point. */
+#define MEMFILE_SPLIT_MIN_SIZE (1 << 13) /* 8kb */
+#define MEMFILE_SPLIT_MAX_SIZE (1 << 17) /* 128kb */
+#define MEMFILE_SPLIT_MASK_BITS 15
+
+/**
+ * Chunk buffers are reference counted, so that memfiles outside of the undo stack can use them
+ * without a copy, see #BLO_memfile_share. Within the undo stack only the chunk that owns a buffer
+ * holds a reference to it, see #memfile_chunk_owns_buffer.
+ *
+ * The header is placed in front of the buffer data, padded to keep the data aligned like a
+ * regular allocation.
+ */
+struct alignas(16) MemFileBufferHeader {
+  std::atomic<int32_t> users;
+};
+
+static MemFileBufferHeader *memfile_buffer_header(const char *buf)
+{
+  return reinterpret_cast<MemFileBufferHeader *>(const_cast<char *>(buf)) - 1;
+}
+
+static char *memfile_buffer_alloc(const size_t size)
+{
+  void *mem = MEM_mallocN(sizeof(MemFileBufferHeader) + size, "Chunk buffer");
+  MemFileBufferHeader *header = new (mem) MemFileBufferHeader();
+  header->users = 1;
+  return reinterpret_cast<char *>(header + 1);
+}
+
+static void memfile_buffer_user_add(const char *buf)
+{
+  memfile_buffer_header(buf)->users.fetch_add(1);
+}
+
+static void memfile_buffer_user_remove(const char *buf)
+{
+  MemFileBufferHeader *header = memfile_buffer_header(buf);
+  if (header->users.fetch_sub(1) == 1) {
+    header->~MemFileBufferHeader();
+    MEM_freeN(header);
+  }
+}
+
+static bool memfile_chunk_owns_buffer(const MemFileChunk *chunk)
+{
+  return !chunk->is_identical && !chunk->is_deduplicated;
+}
+
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
   while ((chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks)))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
+    if (memfile_chunk_owns_buffer(chunk)) {
+      memfile_buffer_user_remove(chunk->buf);
     }
     MEM_freeN(chunk);
   }
@@ -58,11 +112,15 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   GHash *buffer_to_second_memchunk = BLI_ghash_new(
       BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
 
-  /* First, detect all memchunks in second memfile that are not owned by it. */
+  /* First, detect all memchunks in second memfile that are not owned by it. Deduplicated chunks
+   * may share the same buffer several times, only one of them needs to take over ownership. */
   for (MemFileChunk *sc = static_cast<MemFileChunk *>(second->chunks.first); sc != nullptr;
        sc = static_cast<MemFileChunk *>(sc->next)) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+    if (!memfile_chunk_owns_buffer(sc)) {
+      void **entry;
+      if (!BLI_ghash_ensure_p(buffer_to_second_memchunk, (void *)sc->buf, &entry)) {
+        *entry = sc;
+      }
     }
   }
 
@@ -70,12 +128,13 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk *fc = static_cast<MemFileChunk *>(first->chunks.first); fc != nullptr;
        fc = static_cast<MemFileChunk *>(fc->next)) {
-    if (!fc->is_identical) {
+    if (memfile_chunk_owns_buffer(fc)) {
       MemFileChunk *sc = static_cast<MemFileChunk *>(
           BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf));
       if (sc != nullptr) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(!memfile_chunk_owns_buffer(sc));
         sc->is_identical = false;
+        sc->is_deduplicated = false;
         fc->is_identical = true;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
@@ -89,6 +148,24 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   BLO_memfile_free(first);
 }
 
+void BLO_memfile_share(const MemFile *memfile_src, MemFile *memfile_dst)
+{
+  BLI_listbase_clear(&memfile_dst->chunks);
+  /* No memory is allocated for the data, so it does not add to the size. */
+  memfile_dst->size = 0;
+
+  LISTBASE_FOREACH (const MemFileChunk *, chunk_src, &memfile_src->chunks) {
+    MemFileChunk *chunk_dst = static_cast<MemFileChunk *>(
+        MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk"));
+    *chunk_dst = *chunk_src;
+    /* Every chunk holds its own reference, also when the source chunks share a buffer. */
+    memfile_buffer_user_add(chunk_src->buf);
+    chunk_dst->is_identical = false;
+    chunk_dst->is_deduplicated = false;
+    BLI_addtail(&memfile_dst->chunks, chunk_dst);
+  }
+}
+
 void BLO_memfile_clear_future(MemFile *memfile)
 {
   LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
@@ -105,6 +182,8 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
   mem_data->reference_current_chunk = reference_memfile ? static_cast<MemFileChunk *>(
                                                               reference_memfile->chunks.first) :
                                                           nullptr;
+  mem_data->id_session_uuid_mapping = nullptr;
+  mem_data->content_hash_mapping = nullptr;
 
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
    * IDs stored in that previous undo step, and its first matching memchunk. This will allow
@@ -129,6 +208,21 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
         }
       }
     }
+
+    /* Chunks of large data blocks can be shared with the new step even when they moved, e.g.
+     * after inserting elements in the middle of an array, so they are also found by content. */
+    mem_data->content_hash_mapping = BLI_ghash_new(
+        BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
+    LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &reference_memfile->chunks) {
+      if (mem_chunk->content_hash != 0) {
+        void **entry;
+        if (!BLI_ghash_ensure_p(mem_data->content_hash_mapping,
+                                POINTER_FROM_UINT(mem_chunk->content_hash),
+                                &entry)) {
+          *entry = mem_chunk;
+        }
+      }
+    }
   }
 }
 
@@ -137,44 +231,159 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != nullptr) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, nullptr, nullptr);
   }
+  if (mem_data->content_hash_mapping != nullptr) {
+    BLI_ghash_free(mem_data->content_hash_mapping, nullptr, nullptr);
+  }
 }
 
-void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
+static MemFileChunk *memfile_chunk_append(MemFileWriteData *mem_data,
+                                          size_t size,
+                                          uint content_hash)
 {
-  MemFile *memfile = mem_data->written_memfile;
-  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
-
   MemFileChunk *curchunk = static_cast<MemFileChunk *>(
       MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk"));
   curchunk->size = size;
   curchunk->buf = nullptr;
   curchunk->is_identical = false;
+  curchunk->is_deduplicated = false;
+  curchunk->content_hash = content_hash;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
-  BLI_addtail(&memfile->chunks, curchunk);
+  BLI_addtail(&mem_data->written_memfile->chunks, curchunk);
+  return curchunk;
+}
+
+static void memfile_chunk_set_identical(MemFileChunk *curchunk, MemFileChunk *compchunk)
+{
+  curchunk->buf = compchunk->buf;
+  curchunk->is_identical = true;
+  compchunk->is_identical_future = true;
+}
+
+/**
+ * Store the data of a chunk that doesn't match the previous step at its position, sharing the
+ * buffer of a chunk with the same content elsewhere in the previous step when possible.
+ */
+static void memfile_chunk_store(MemFileWriteData *mem_data,
+                                MemFileChunk *curchunk,
+                                const char *buf)
+{
+  const size_t size = curchunk->size;
+
+  /* Not equal, but the same content may exist elsewhere in the previous step. This only shares
+   * memory, the chunk is still considered changed when reading. */
+  if (curchunk->content_hash != 0 && mem_data->content_hash_mapping != nullptr) {
+    const MemFileChunk *hashchunk = static_cast<const MemFileChunk *>(BLI_ghash_lookup(
+        mem_data->content_hash_mapping, POINTER_FROM_UINT(curchunk->content_hash)));
+    if (hashchunk != nullptr && hashchunk->size == size &&
+        memcmp(hashchunk->buf, buf, size) == 0) {
+      curchunk->buf = hashchunk->buf;
+      curchunk->is_deduplicated = true;
+      return;
+    }
+  }
+
+  /* not equal... */
+  char *buf_new = memfile_buffer_alloc(size);
+  memcpy(buf_new, buf, size);
+  curchunk->buf = buf_new;
+  mem_data->written_memfile->size += size;
+}
+
+void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
+{
+  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
+  MemFileChunk *curchunk = memfile_chunk_append(mem_data, size, 0);
 
   /* we compare compchunk with buf */
   if (*compchunk_step != nullptr) {
     MemFileChunk *compchunk = *compchunk_step;
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
-        curchunk->buf = compchunk->buf;
-        curchunk->is_identical = true;
-        compchunk->is_identical_future = true;
+        memfile_chunk_set_identical(curchunk, compchunk);
       }
     }
     *compchunk_step = static_cast<MemFileChunk *>(compchunk->next);
   }
 
-  /* not equal... */
   if (curchunk->buf == nullptr) {
-    char *buf_new = static_cast<char *>(MEM_mallocN(size, "Chunk buffer"));
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+    memfile_chunk_store(mem_data, curchunk, buf);
+  }
+}
+
+/**
+ * Random values for the rolling "gear" hash, one per byte value.
+ */
+static const uint64_t *memfile_split_gear_table()
+{
+  static const struct GearTable {
+    uint64_t values[256];
+    GearTable()
+    {
+      for (uint i = 0; i < 256; i++) {
+        values[i] = (uint64_t(BLI_hash_int(i)) << 32) | uint64_t(BLI_hash_int(i + 256));
+      }
+    }
+  } table;
+  return table.values;
+}
+
+/**
+ * Find the size of the next chunk: the first position after the minimum size where the rolling
+ * hash of the preceding bytes has its highest bits cleared. Since the hash only depends on the
+ * last 64 bytes, the same split points are found again after data was inserted or removed.
+ */
+static size_t memfile_split_size(const uchar *buf, size_t size)
+{
+  if (size <= MEMFILE_SPLIT_MIN_SIZE) {
+    return size;
+  }
+  const uint64_t *gear = memfile_split_gear_table();
+  const size_t end = MIN2(size, size_t(MEMFILE_SPLIT_MAX_SIZE));
+  uint64_t hash = 0;
+  for (size_t i = MEMFILE_SPLIT_MIN_SIZE; i < end; i++) {
+    hash = (hash << 1) + gear[buf[i]];
+    if ((hash >> (64 - MEMFILE_SPLIT_MASK_BITS)) == 0) {
+      return i + 1;
+    }
+  }
+  return end;
+}
+
+void BLO_memfile_chunk_add_split(MemFileWriteData *mem_data, const char *buf, size_t size)
+{
+  while (size > 0) {
+    MemFileChunk *compchunk = mem_data->reference_current_chunk;
+    size_t chunk_size;
+
+    /* Unchanged data matches the chunk of the previous step at the same position, which was split
+     * the same way. Reuse its size and hash, so unchanged data is neither split nor hashed. */
+    if (compchunk != nullptr && compchunk->size <= size &&
+        memcmp(compchunk->buf, buf, compchunk->size) == 0) {
+      chunk_size = compchunk->size;
+      MemFileChunk *curchunk = memfile_chunk_append(mem_data, chunk_size, compchunk->content_hash);
+      memfile_chunk_set_identical(curchunk, compchunk);
+      mem_data->reference_current_chunk = static_cast<MemFileChunk *>(compchunk->next);
+    }
+    else {
+      chunk_size = memfile_split_size(reinterpret_cast<const uchar *>(buf), size);
+      uint content_hash = BLI_hash_mm2(reinterpret_cast<const uchar *>(buf), chunk_size, 0);
+      /* Zero is used for chunks without hash. */
+      if (content_hash == 0) {
+        content_hash = 1;
+      }
+      MemFileChunk *curchunk = memfile_chunk_append(mem_data, chunk_size, content_hash);
+      if (compchunk != nullptr) {
+        mem_data->reference_current_chunk = static_cast<MemFileChunk *>(compchunk->next);
+      }
+      memfile_chunk_store(mem_data, curchunk, buf);
+    }
+
+    buf += chunk_size;
+    size -= chunk_size;
   }
 }
 
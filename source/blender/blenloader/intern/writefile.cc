@@ -483,6 +483,30 @@ static void writedata_do_write(WriteData *wd, const void *mem, size_t memlen)
   }
 }
 
+/**
+ * Write a block of data larger than the buffer, in several pieces.
+ */
+static void writedata_do_write_split(WriteData *wd, const void *mem, size_t memlen)
+{
+  if ((wd == nullptr) || wd->error || (mem == nullptr) || memlen < 1) {
+    return;
+  }
+
+  if (wd->use_memfile) {
+    /* Split at positions depending on the content rather than at fixed sizes, so that an
+     * edit in the middle of a large array doesn't change all following undo chunks. */
+    BLO_memfile_chunk_add_split(&wd->mem, static_cast<const char *>(mem), memlen);
+    return;
+  }
+
+  do {
+    const size_t writelen = MIN2(memlen, wd->buffer.chunk_size);
+    writedata_do_write(wd, mem, writelen);
+    mem = static_cast<const char *>(mem) + writelen;
+    memlen -= writelen;
+  } while (memlen > 0);
+}
+
 static void writedata_free(WriteData *wd)
 {
   if (wd->buffer.buf) {
@@ -541,13 +565,7 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
         wd->buffer.used_len = 0;
       }
 
-      do {
-        size_t writelen = MIN2(len, wd->buffer.chunk_size);
-        writedata_do_write(wd, adr, writelen);
-        adr = (const char *)adr + writelen;
-        len -= writelen;
-      } while (len > 0);
-
+      writedata_do_write_split(wd, adr, len);
       return;
     }
 
@@ -0,0 +1,183 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_listbase.h"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+#include "BLO_undofile.h"
+
+namespace blender::blenloader::tests {
+
+static Vector<char> random_data(const int64_t size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Vector<char> data(size);
+  for (char &value : data) {
+    value = char(rng.get_uint32());
+  }
+  return data;
+}
+
+/** Write `data` as a single large block, like writing a big array does for undo. */
+static void memfile_write_block(MemFile *memfile, MemFile *reference, Span<char> data)
+{
+  MemFileWriteData mem_data = {};
+  BLO_memfile_write_init(&mem_data, memfile, reference);
+  BLO_memfile_chunk_add_split(&mem_data, data.data(), size_t(data.size()));
+  BLO_memfile_write_finalize(&mem_data);
+}
+
+/** Concatenate the chunks of the memfile, to check that no data got lost. */
+static Vector<char> memfile_content(const MemFile *memfile)
+{
+  Vector<char> content;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    content.extend(Span<char>(chunk->buf, int64_t(chunk->size)));
+  }
+  return content;
+}
+
+static bool memfile_chunk_owns_buffer(const MemFileChunk *chunk)
+{
+  return !chunk->is_identical && !chunk->is_deduplicated;
+}
+
+TEST(memfile, SplitBoundaries)
+{
+  const Vector<char> data = random_data(1024 * 1024, 0);
+  MemFile memfile = {};
+  memfile_write_block(&memfile, nullptr, data);
+
+  EXPECT_GT(BLI_listbase_count(&memfile.chunks), 1);
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile.chunks) {
+    if (chunk->next != nullptr) {
+      EXPECT_GT(chunk->size, size_t(1 << 13));
+    }
+    EXPECT_LE(chunk->size, size_t(1 << 17));
+    EXPECT_NE(chunk->content_hash, 0u);
+    EXPECT_TRUE(memfile_chunk_owns_buffer(chunk));
+  }
+  EXPECT_EQ(memfile.size, size_t(data.size()));
+  EXPECT_EQ(memfile_content(&memfile).as_span(), data.as_span());
+
+  BLO_memfile_free(&memfile);
+}
+
+TEST(memfile, SplitSmallBlock)
+{
+  const Vector<char> data = random_data(1000, 1);
+  MemFile memfile = {};
+  memfile_write_block(&memfile, nullptr, data);
+
+  EXPECT_EQ(BLI_listbase_count(&memfile.chunks), 1);
+  EXPECT_EQ(memfile_content(&memfile).as_span(), data.as_span());
+
+  BLO_memfile_free(&memfile);
+}
+
+TEST(memfile, UnchangedBlockIsIdentical)
+{
+  const Vector<char> data = random_data(1024 * 1024, 2);
+  MemFile first = {};
+  MemFile second = {};
+  memfile_write_block(&first, nullptr, data);
+  memfile_write_block(&second, &first, data);
+
+  EXPECT_EQ(BLI_listbase_count(&second.chunks), BLI_listbase_count(&first.chunks));
+  const MemFileChunk *first_chunk = static_cast<const MemFileChunk *>(first.chunks.first);
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &second.chunks) {
+    EXPECT_TRUE(chunk->is_identical);
+    EXPECT_EQ(chunk->buf, first_chunk->buf);
+    EXPECT_EQ(chunk->content_hash, first_chunk->content_hash);
+    first_chunk = static_cast<const MemFileChunk *>(first_chunk->next);
+  }
+  EXPECT_EQ(second.size, size_t(0));
+
+  BLO_memfile_free(&second);
+  BLO_memfile_free(&first);
+}
+
+TEST(memfile, InsertedDataIsDeduplicatedByHash)
+{
+  const Vector<char> data = random_data(1024 * 1024, 3);
+  const Vector<char> insert = random_data(100, 4);
+  Vector<char> data_edited;
+  data_edited.extend(data.as_span().take_front(data.size() / 2));
+  data_edited.extend(insert);
+  data_edited.extend(data.as_span().drop_front(data.size() / 2));
+
+  MemFile first = {};
+  MemFile second = {};
+  memfile_write_block(&first, nullptr, data);
+  memfile_write_block(&second, &first, data_edited);
+
+  int deduplicated_num = 0;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &second.chunks) {
+    deduplicated_num += chunk->is_deduplicated;
+  }
+  EXPECT_GT(deduplicated_num, 0);
+  /* Only the chunks around the insertion are stored again. */
+  EXPECT_LT(second.size, size_t(data.size() / 4));
+  EXPECT_EQ(memfile_content(&second).as_span(), data_edited.as_span());
+
+  BLO_memfile_free(&second);
+  BLO_memfile_free(&first);
+}
+
+TEST(memfile, MergeTransfersOwnership)
+{
+  const Vector<char> data = random_data(1024 * 1024, 5);
+  Vector<char> data_edited = data;
+  data_edited[data.size() / 2] ^= 1;
+  const Vector<char> insert = random_data(100, 6);
+  data_edited.extend(data.as_span().take_front(1 << 14));
+  data_edited.extend(insert);
+
+  MemFile first = {};
+  MemFile second = {};
+  memfile_write_block(&first, nullptr, data);
+  memfile_write_block(&second, &first, data_edited);
+
+  int shared_num = 0;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &second.chunks) {
+    shared_num += !memfile_chunk_owns_buffer(chunk);
+  }
+  EXPECT_GT(shared_num, 0);
+
+  /* Merging frees the first step, the second one takes over the buffers it still uses. */
+  BLO_memfile_merge(&first, &second);
+  EXPECT_TRUE(BLI_listbase_is_empty(&first.chunks));
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &second.chunks) {
+    const MemFileChunk *owner = chunk;
+    /* Several chunks may share the same buffer, only one of them owns it. */
+    LISTBASE_FOREACH (const MemFileChunk *, other, &second.chunks) {
+      if (other->buf == chunk->buf && memfile_chunk_owns_buffer(other)) {
+        owner = other;
+      }
+    }
+    EXPECT_TRUE(memfile_chunk_owns_buffer(owner));
+  }
+  EXPECT_EQ(memfile_content(&second).as_span(), data_edited.as_span());
+
+  BLO_memfile_free(&second);
+}
+
+TEST(memfile, ShareKeepsBuffersAlive)
+{
+  const Vector<char> data = random_data(256 * 1024, 7);
+  MemFile source = {};
+  MemFile shared = {};
+  memfile_write_block(&source, nullptr, data);
+  BLO_memfile_share(&source, &shared);
+  EXPECT_EQ(shared.size, size_t(0));
+
+  /* Buffers are reference counted, freeing the source keeps them alive for the shared copy. */
+  BLO_memfile_free(&source);
+  EXPECT_EQ(memfile_content(&shared).as_span(), data.as_span());
+
+  BLO_memfile_free(&shared);
+}
+
+}  // namespace blender::blenloader::tests
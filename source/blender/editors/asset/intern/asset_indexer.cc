@@ -30,6 +30,8 @@
 
 #include "CLG_log.h"
 
+#include "asset_indexer_consolidated.hh"
+
 static CLG_LogRef LOG = {"ed.asset"};
 
 namespace blender::ed::asset::index {
@@ -64,6 +66,9 @@ using namespace blender::bke::idprop;
  *
  * NOTE: entries, author, description, tags and properties are optional attributes.
  *
+ * NOTE: The contents of all index files of a library are also stored together in a single
+ * #ConsolidatedIndex, which is used instead of the separate index files when possible.
+ *
  * NOTE: File browser uses name and idcode separate. Inside the index they are joined together like
  * #ID.name.
  * NOTE: File browser group name isn't stored in the index as it is a translatable name.
@@ -442,6 +447,8 @@ struct AssetLibraryIndex {
 
   std::string library_path;
 
+  ConsolidatedIndex consolidated_index;
+
  public:
   AssetLibraryIndex(const StringRef library_path) : library_path(library_path)
   {
@@ -478,6 +485,14 @@ struct AssetLibraryIndex {
     indices_base_path = std::string(index_path);
   }
 
+  /**
+   * \return absolute path to the #ConsolidatedIndex of the library.
+   */
+  std::string consolidated_index_file_path() const
+  {
+    return indices_base_path + "library.index";
+  }
+
   /**
    * \return absolute path to the index file of the given `asset_file`.
    *
@@ -644,6 +659,15 @@ struct AssetIndex {
     return get_version() == CURRENT_VERSION;
   }
 
+  /**
+   * Whether there are any entries, the attribute isn't stored when there are none.
+   */
+  bool contains_entries() const
+  {
+    const DictionaryValue *root = contents->as_dictionary_value();
+    return root != nullptr && root->create_lookup().contains(ATTRIBUTE_ENTRIES);
+  }
+
   /**
    * Extract the contents of this index into the given \p indexer_entries.
    *
@@ -796,6 +820,27 @@ static eFileIndexerResult read_index(const char *filename,
   BlendFile asset_file(filename);
   AssetIndexFile asset_index_file(library_index, asset_file);
 
+  /* The consolidated index doesn't need any file system access, use it when possible. */
+  std::unique_ptr<Value> consolidated_value = library_index.consolidated_index.take_contents(
+      filename);
+  if (consolidated_value) {
+    const AssetIndex consolidated_contents(consolidated_value);
+    if (consolidated_contents.is_latest_version()) {
+      /* Keep the separate index, it is still valid. */
+      asset_index_file.mark_as_used();
+      const int read_entries_len = consolidated_contents.contains_entries() ?
+                                       consolidated_contents.extract_into(*entries) :
+                                       0;
+      CLOG_INFO(&LOG,
+                1,
+                "Read %d entries from consolidated asset index for [%s].",
+                read_entries_len,
+                filename);
+      *r_read_entries_len = read_entries_len;
+      return FILE_INDEXER_ENTRIES_LOADED;
+    }
+  }
+
   if (!asset_index_file.exists()) {
     return FILE_INDEXER_NEEDS_UPDATE;
   }
@@ -822,6 +867,9 @@ static eFileIndexerResult read_index(const char *filename,
               "Asset file index is to small to contain any entries. [%s]",
               asset_index_file.filename.c_str());
     *r_read_entries_len = 0;
+    FileIndexerEntries no_entries = {nullptr};
+    AssetIndex no_entries_contents(no_entries);
+    library_index.consolidated_index.add(filename, *no_entries_contents.contents);
     return FILE_INDEXER_ENTRIES_LOADED;
   }
 
@@ -839,6 +887,7 @@ static eFileIndexerResult read_index(const char *filename,
   const int read_entries_len = contents->extract_into(*entries);
   CLOG_INFO(&LOG, 1, "Read %d entries from asset index for [%s].", read_entries_len, filename);
   *r_read_entries_len = read_entries_len;
+  library_index.consolidated_index.add(filename, *contents->contents);
 
   return FILE_INDEXER_ENTRIES_LOADED;
 }
@@ -856,6 +905,7 @@ static void update_index(const char *filename, FileIndexerEntries *entries, void
 
   AssetIndex content(*entries);
   asset_index_file.write_contents(content);
+  library_index.consolidated_index.add(filename, *content.contents);
 }
 
 static void *init_user_data(const char *root_directory, size_t root_directory_maxlen)
@@ -864,6 +914,7 @@ static void *init_user_data(const char *root_directory, size_t root_directory_ma
       __func__, StringRef(root_directory, BLI_strnlen(root_directory, root_directory_maxlen)));
   library_index->collect_preexisting_file_indices();
   library_index->remove_broken_index_files();
+  library_index->consolidated_index.load(library_index->consolidated_index_file_path());
   return library_index;
 }
 
@@ -879,6 +930,7 @@ static void filelist_finished(void *user_data)
   if (num_indices_removed > 0) {
     CLOG_INFO(&LOG, 1, "Removed %d unused indices.", num_indices_removed);
   }
+  library_index.consolidated_index.save();
 }
 
 constexpr FileIndexerType asset_indexer()
@@ -0,0 +1,212 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup edasset
+ */
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "CLG_log.h"
+
+#include "asset_indexer_consolidated.hh"
+
+static CLG_LogRef LOG = {"ed.asset"};
+
+namespace blender::ed::asset::index {
+
+using namespace blender::io::serialize;
+
+bool ConsolidatedIndex::stat_asset_file(const char *asset_file_path,
+                                        int64_t &r_mtime,
+                                        int64_t &r_size)
+{
+  BLI_stat_t stat = {};
+  if (BLI_stat(asset_file_path, &stat) == -1) {
+    return false;
+  }
+  r_mtime = int64_t(stat.st_mtime);
+  r_size = int64_t(stat.st_size);
+  return true;
+}
+
+void ConsolidatedIndex::load(StringRef index_file_path)
+{
+  file_path = index_file_path;
+
+  size_t data_size = 0;
+  char *data = static_cast<char *>(BLI_file_read_binary_as_mem(file_path.c_str(), 0, &data_size));
+  if (data == nullptr) {
+    return;
+  }
+  if (!read_records(Span<char>(data, int64_t(data_size)))) {
+    CLOG_INFO(&LOG, 1, "Ignoring invalid consolidated asset index [%s].", file_path.c_str());
+    records.clear();
+    /* Make sure it gets rewritten. */
+    is_dirty = true;
+  }
+  MEM_freeN(data);
+
+  Vector<std::pair<const std::string *, Record *>> items;
+  for (auto item : records.items()) {
+    items.append({&item.key, &item.value});
+  }
+  threading::parallel_for(items.index_range(), 16, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const std::string &asset_file_path = *items[i].first;
+      Record &record = *items[i].second;
+      int64_t mtime, size;
+      if (!stat_asset_file(asset_file_path.c_str(), mtime, size) || mtime != record.mtime ||
+          size != record.size) {
+        continue;
+      }
+      JsonFormatter formatter;
+      std::istringstream is(record.json);
+      record.contents = formatter.deserialize(is);
+      record.is_valid = record.contents != nullptr;
+    }
+  });
+  CLOG_INFO(&LOG,
+            1,
+            "Loaded consolidated asset index with %d records [%s].",
+            int(records.size()),
+            file_path.c_str());
+}
+
+std::unique_ptr<Value> ConsolidatedIndex::take_contents(const std::string &asset_file_path)
+{
+  std::lock_guard lock{mutex};
+  Record *record = records.lookup_ptr(asset_file_path);
+  if (record == nullptr || !record->is_valid || !record->contents) {
+    return nullptr;
+  }
+  record->is_used = true;
+  return std::move(record->contents);
+}
+
+void ConsolidatedIndex::add(const std::string &asset_file_path, const Value &contents)
+{
+  Record record;
+  if (!stat_asset_file(asset_file_path.c_str(), record.mtime, record.size)) {
+    return;
+  }
+  JsonFormatter formatter;
+  std::ostringstream os;
+  formatter.serialize(os, contents);
+  record.json = os.str();
+  record.is_used = true;
+
+  std::lock_guard lock{mutex};
+  records.add_overwrite(asset_file_path, std::move(record));
+  is_dirty = true;
+}
+
+void ConsolidatedIndex::save()
+{
+  std::lock_guard lock{mutex};
+  const int64_t records_num = records.size();
+  records.remove_if([](const auto item) { return !item.value.is_used; });
+  if (records.size() != records_num) {
+    is_dirty = true;
+  }
+  if (!is_dirty) {
+    return;
+  }
+
+  if (!BLI_make_existing_file(file_path.c_str())) {
+    CLOG_ERROR(&LOG, "Index not created: couldn't create folder [%s].", file_path.c_str());
+    return;
+  }
+  /* Write to a temporary file first, so the index is never left partially written. */
+  const std::string temp_path = file_path + "@";
+  std::ofstream os;
+  os.open(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+  os.write(MAGIC, sizeof(MAGIC));
+  write_uint32(os, CURRENT_VERSION);
+  write_uint32(os, uint32_t(records.size()));
+  for (auto item : records.items()) {
+    write_string(os, item.key);
+    write_int64(os, item.value.mtime);
+    write_int64(os, item.value.size);
+    write_string(os, item.value.json);
+  }
+  os.close();
+  if (os.fail() || BLI_rename(temp_path.c_str(), file_path.c_str()) != 0) {
+    CLOG_ERROR(&LOG, "Couldn't write consolidated asset index [%s].", file_path.c_str());
+    BLI_delete(temp_path.c_str(), false, false);
+    return;
+  }
+  is_dirty = false;
+  CLOG_INFO(&LOG,
+            1,
+            "Wrote consolidated asset index with %d records [%s].",
+            int(records.size()),
+            file_path.c_str());
+}
+
+bool ConsolidatedIndex::read_records(Span<char> data)
+{
+  int64_t offset = 0;
+  auto read = [&](void *dst, const int64_t size) {
+    if (offset + size > data.size()) {
+      return false;
+    }
+    memcpy(dst, data.data() + offset, size_t(size));
+    offset += size;
+    return true;
+  };
+  auto read_string = [&](std::string &r_string) {
+    uint32_t len;
+    if (!read(&len, sizeof(len)) || offset + len > data.size()) {
+      return false;
+    }
+    r_string.assign(data.data() + offset, len);
+    offset += len;
+    return true;
+  };
+
+  char magic[sizeof(MAGIC)];
+  uint32_t version, records_num;
+  if (!read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      !read(&version, sizeof(version)) || version != CURRENT_VERSION ||
+      !read(&records_num, sizeof(records_num))) {
+    return false;
+  }
+  records.reserve(records_num);
+  for (uint32_t i = 0; i < records_num; i++) {
+    std::string asset_file_path;
+    Record record;
+    if (!read_string(asset_file_path) || !read(&record.mtime, sizeof(record.mtime)) ||
+        !read(&record.size, sizeof(record.size)) || !read_string(record.json)) {
+      return false;
+    }
+    records.add_overwrite(std::move(asset_file_path), std::move(record));
+  }
+  return true;
+}
+
+void ConsolidatedIndex::write_uint32(std::ostream &os, const uint32_t value)
+{
+  os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void ConsolidatedIndex::write_int64(std::ostream &os, const int64_t value)
+{
+  os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void ConsolidatedIndex::write_string(std::ostream &os, const StringRef str)
+{
+  write_uint32(os, uint32_t(str.size()));
+  os.write(str.data(), str.size());
+}
+
+}  // namespace blender::ed::asset::index
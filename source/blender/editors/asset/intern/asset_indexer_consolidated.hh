@@ -0,0 +1,95 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup edasset
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "BLI_map.hh"
+#include "BLI_serialize.hh"
+#include "BLI_span.hh"
+#include "BLI_string_ref.hh"
+
+namespace blender::ed::asset::index {
+
+/**
+ * \brief The indices of all asset files of a library, stored together in a single binary file.
+ *
+ * Using the separate index files requires multiple file system accesses per asset file (checking
+ * for the index file, comparing modification times, reading the index), one asset file at a time.
+ * For large libraries on network drives this takes most of the time to open the library, even
+ * when nothing changed. The consolidated index is loaded with a single read, after which the
+ * asset files are checked and the index contents parsed in parallel. Only new or changed asset
+ * files still go through the separate index files.
+ *
+ * The index is updated incrementally: records are added or replaced when the index of an asset
+ * file is read or updated, and records of asset files that are not part of the library anymore
+ * are removed once listing the library finished.
+ *
+ * The file is stored in native byte order, strings are prefixed with their length as `uint32`:
+ * \code
+ * "BLAI" <uint32 version> <uint32 records number>
+ * <string asset file path> <int64 modification time> <int64 size> <string index contents>
+ * ...
+ * \endcode
+ */
+struct ConsolidatedIndex {
+  static constexpr char MAGIC[4] = {'B', 'L', 'A', 'I'};
+  /** Increase when the layout of the file changes. */
+  static const uint32_t CURRENT_VERSION = 1;
+
+  struct Record {
+    int64_t mtime = 0;
+    int64_t size = 0;
+    /** The index contents in JSON format, like in the separate index files. */
+    std::string json;
+    /** Parsed #json. Only set when the asset file did not change since the index was created. */
+    std::unique_ptr<io::serialize::Value> contents;
+    bool is_valid = false;
+    /** Whether the asset file was listed, records that aren't used are removed on save. */
+    bool is_used = false;
+  };
+
+  std::string file_path;
+  Map<std::string /*asset file path*/, Record> records;
+  /** Records have been added, changed or removed since loading. */
+  bool is_dirty = false;
+  /** Protects #records, as indices can be read and updated from multiple threads. */
+  std::mutex mutex;
+
+  static bool stat_asset_file(const char *asset_file_path, int64_t &r_mtime, int64_t &r_size);
+
+  /**
+   * Read all records from the file, then check the asset files and parse the contents of the
+   * records that are still valid in parallel.
+   */
+  void load(StringRef index_file_path);
+
+  /**
+   * \return The index contents of the given asset file, when it did not change since they were
+   * stored. The contents are handed over, so this should be called once per asset file.
+   */
+  std::unique_ptr<io::serialize::Value> take_contents(const std::string &asset_file_path);
+
+  /** Add or replace the record of an asset file whose index was read or updated. */
+  void add(const std::string &asset_file_path, const io::serialize::Value &contents);
+
+  /** Remove the records of asset files that weren't listed, and write the file if needed. */
+  void save();
+
+ private:
+  bool read_records(Span<char> data);
+
+  static void write_uint32(std::ostream &os, uint32_t value);
+  static void write_int64(std::ostream &os, int64_t value);
+  static void write_string(std::ostream &os, StringRef str);
+};
+
+}  // namespace blender::ed::asset::index
@@ -0,0 +1,266 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <fstream>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+
+#include "CLG_log.h"
+
+#include "asset_indexer_consolidated.hh"
+
+#include "testing/testing.h"
+
+namespace blender::ed::asset::index::tests {
+
+using namespace blender::io::serialize;
+
+class consolidated_asset_index_test : public testing::Test {
+ protected:
+  std::string temp_path_;
+
+  static void SetUpTestSuite()
+  {
+    testing::Test::SetUpTestSuite();
+    CLG_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+    testing::Test::TearDownTestSuite();
+  }
+
+  void SetUp() override
+  {
+    BKE_tempdir_init("");
+    temp_path_ = std::string(BKE_tempdir_session()) + "consolidated-asset-index" + SEP_STR;
+    BLI_dir_create_recursive(temp_path_.c_str());
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(temp_path_.c_str(), true, true);
+  }
+
+  std::string index_file_path() const
+  {
+    return temp_path_ + "index" + SEP_STR + "library.index";
+  }
+
+  /** Create or replace a file in the temporary directory, standing in for an asset file. */
+  std::string write_file(const std::string &name, const std::string &data) const
+  {
+    const std::string path = temp_path_ + name;
+    std::ofstream os(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    os << data;
+    return path;
+  }
+};
+
+/** Index contents like the ones of the separate index files, identified by a number. */
+static std::unique_ptr<DictionaryValue> index_contents(const int64_t number)
+{
+  std::unique_ptr<DictionaryValue> contents = std::make_unique<DictionaryValue>();
+  contents->elements().append_as(std::pair(std::string("version"), new IntValue(number)));
+  return contents;
+}
+
+static int64_t index_contents_number(const Value *contents)
+{
+  if (contents == nullptr || contents->as_dictionary_value() == nullptr) {
+    return -1;
+  }
+  const DictionaryValue::Lookup lookup = contents->as_dictionary_value()->create_lookup();
+  const DictionaryValue::LookupValue *value = lookup.lookup_ptr("version");
+  if (value == nullptr || (*value)->as_int_value() == nullptr) {
+    return -1;
+  }
+  return (*value)->as_int_value()->value();
+}
+
+TEST_F(consolidated_asset_index_test, save_and_load)
+{
+  const std::string file_a = write_file("a.blend", "asset file a");
+  const std::string file_b = write_file("b.blend", "asset file b");
+  {
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    EXPECT_TRUE(index.records.is_empty());
+    index.add(file_a, *index_contents(1));
+    index.add(file_b, *index_contents(2));
+    index.save();
+    EXPECT_FALSE(index.is_dirty);
+  }
+  EXPECT_TRUE(BLI_exists(index_file_path().c_str()));
+
+  ConsolidatedIndex index;
+  index.load(index_file_path());
+  EXPECT_EQ(index.records.size(), 2);
+  EXPECT_FALSE(index.is_dirty);
+  EXPECT_EQ(index_contents_number(index.take_contents(file_a).get()), 1);
+  EXPECT_EQ(index_contents_number(index.take_contents(file_b).get()), 2);
+  /* The contents are handed over. */
+  EXPECT_EQ(index.take_contents(file_a), nullptr);
+}
+
+TEST_F(consolidated_asset_index_test, add_replaces_record)
+{
+  const std::string file_a = write_file("a.blend", "asset file a");
+  ConsolidatedIndex index;
+  index.load(index_file_path());
+  index.add(file_a, *index_contents(1));
+  index.add(file_a, *index_contents(2));
+  index.save();
+
+  ConsolidatedIndex loaded_index;
+  loaded_index.load(index_file_path());
+  EXPECT_EQ(loaded_index.records.size(), 1);
+  EXPECT_EQ(index_contents_number(loaded_index.take_contents(file_a).get()), 2);
+}
+
+TEST_F(consolidated_asset_index_test, missing_asset_file_is_not_added)
+{
+  ConsolidatedIndex index;
+  index.load(index_file_path());
+  index.add(temp_path_ + "missing.blend", *index_contents(1));
+  EXPECT_TRUE(index.records.is_empty());
+}
+
+TEST_F(consolidated_asset_index_test, changed_asset_file_invalidates_record)
+{
+  const std::string file_a = write_file("a.blend", "asset file a");
+  const std::string file_b = write_file("b.blend", "asset file b");
+  {
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    index.add(file_a, *index_contents(1));
+    index.add(file_b, *index_contents(2));
+    index.save();
+  }
+  /* A different size invalidates the record, even when the modification time is the same. */
+  write_file("a.blend", "asset file a, changed");
+  {
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    EXPECT_EQ(index.take_contents(file_a), nullptr);
+    EXPECT_EQ(index_contents_number(index.take_contents(file_b).get()), 2);
+    /* The invalid record wasn't used, so it is removed. */
+    index.save();
+  }
+
+  ConsolidatedIndex index;
+  index.load(index_file_path());
+  EXPECT_EQ(index.records.size(), 1);
+  EXPECT_FALSE(index.records.contains(file_a));
+}
+
+TEST_F(consolidated_asset_index_test, deleted_asset_file_invalidates_record)
+{
+  const std::string file_a = write_file("a.blend", "asset file a");
+  {
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    index.add(file_a, *index_contents(1));
+    index.save();
+  }
+  BLI_delete(file_a.c_str(), false, false);
+
+  ConsolidatedIndex index;
+  index.load(index_file_path());
+  EXPECT_EQ(index.take_contents(file_a), nullptr);
+}
+
+TEST_F(consolidated_asset_index_test, unused_records_are_removed_on_save)
+{
+  const std::string file_a = write_file("a.blend", "asset file a");
+  const std::string file_b = write_file("b.blend", "asset file b");
+  {
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    index.add(file_a, *index_contents(1));
+    index.add(file_b, *index_contents(2));
+    index.save();
+  }
+  {
+    /* Only the first asset file is listed. */
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    EXPECT_NE(index.take_contents(file_a), nullptr);
+    index.save();
+  }
+
+  ConsolidatedIndex index;
+  index.load(index_file_path());
+  EXPECT_EQ(index.records.size(), 1);
+  EXPECT_EQ(index_contents_number(index.take_contents(file_a).get()), 1);
+  EXPECT_EQ(index.take_contents(file_b), nullptr);
+}
+
+TEST_F(consolidated_asset_index_test, unchanged_index_is_not_rewritten)
+{
+  const std::string file_a = write_file("a.blend", "asset file a");
+  {
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    index.add(file_a, *index_contents(1));
+    index.save();
+  }
+
+  ConsolidatedIndex index;
+  index.load(index_file_path());
+  EXPECT_NE(index.take_contents(file_a), nullptr);
+  /* Saving would write the file again if anything changed. */
+  BLI_delete(index_file_path().c_str(), false, false);
+  index.save();
+  EXPECT_FALSE(BLI_exists(index_file_path().c_str()));
+}
+
+TEST_F(consolidated_asset_index_test, invalid_index_file_is_ignored)
+{
+  const std::string file_a = write_file("a.blend", "asset file a");
+  {
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    index.add(file_a, *index_contents(1));
+    index.save();
+  }
+
+  /* Truncate the index file in the middle of the record. */
+  size_t data_size = 0;
+  char *data = static_cast<char *>(
+      BLI_file_read_binary_as_mem(index_file_path().c_str(), 0, &data_size));
+  ASSERT_NE(data, nullptr);
+  {
+    std::ofstream os(index_file_path(), std::ios::out | std::ios::binary | std::ios::trunc);
+    os.write(data, std::streamsize(data_size - 4));
+  }
+  MEM_freeN(data);
+  {
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    EXPECT_TRUE(index.records.is_empty());
+    /* Make sure the invalid file gets replaced. */
+    EXPECT_TRUE(index.is_dirty);
+    index.add(file_a, *index_contents(2));
+    index.save();
+  }
+  {
+    ConsolidatedIndex index;
+    index.load(index_file_path());
+    EXPECT_EQ(index_contents_number(index.take_contents(file_a).get()), 2);
+  }
+
+  /* Files that aren't a consolidated index at all. */
+  write_file("index" SEP_STR "library.index", "{\"version\": 1}");
+  ConsolidatedIndex index;
+  index.load(index_file_path());
+  EXPECT_TRUE(index.records.is_empty());
+  EXPECT_TRUE(index.is_dirty);
+}
+
+}  // namespace blender::ed::asset::index::tests
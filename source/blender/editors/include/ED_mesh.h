@@ -199,6 +199,12 @@ void EDBM_automerge_and_split(struct Object *obedit,
 
 /** Export for ED_undo_sys. */
 void ED_mesh_undosys_type(struct UndoType *ut);
+/**
+ * Tell the next undo push that only the positions of `verts` changed since the active undo step,
+ * so only those need to be stored. Their positions are copied, so this must be called after all
+ * changes, right before the undo push of the operator.
+ */
+void EDBM_undo_tag_positions(struct BMEditMesh *em, struct BMVert **verts, int verts_len);
 
 /* editmesh_select.cc */
 
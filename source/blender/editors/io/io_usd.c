@@ -281,7 +281,8 @@ void WM_OT_usd_export(struct wmOperatorType *ot)
                   "use_instancing",
                   false,
                   "Instancing",
-                  "Export instanced objects as references in USD rather than real objects");
+                  "Export instanced objects as references in USD rather than real objects. "
+                  "Instances of meshes are written as points of a point instancer");
 
   RNA_def_enum(ot->srna,
                "evaluation_mode",
@@ -14,9 +14,12 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 
 #include "BLI_array_utils.h"
 #include "BLI_listbase.h"
+#include "BLI_math_vector.h"
+#include "BLI_vector.hh"
 
 #include "BKE_context.h"
 #include "BKE_customdata.h"
@@ -109,6 +112,19 @@ struct UndoMesh {
   } store;
 #endif /* USE_ARRAY_STORE */
 
+  /**
+   * When set, this is a positions-only step that stores the vertex positions that changed
+   * since `delta_base`, all other data is read from the base, see #EDBM_undo_tag_positions.
+   */
+  UndoMesh *delta_base;
+  int *delta_vert_indices;
+  float (*delta_vert_positions)[3];
+  int delta_verts_len;
+  /** Number of positions-only undo-meshes using this one as `delta_base`. */
+  int delta_users;
+  /** The undo step was freed, the data is only kept for the `delta_users`. */
+  bool is_detached;
+
   size_t undo_size;
 };
 
@@ -567,6 +583,165 @@ static UndoMesh **mesh_undostep_reference_elems_from_objects(Object **object, in
 
 #endif /* USE_ARRAY_STORE */
 
+/* -------------------------------------------------------------------- */
+/** \name Positions-Only Undo
+ *
+ * Converting the whole #BMesh for every undo push is slow on dense meshes, even when an
+ * operator only moved a few vertices. Operators that only change vertex positions (transform)
+ * tag the vertices they moved right before their undo push. The undo-mesh then only stores
+ * those positions, relative to the undo-mesh of the active undo step.
+ *
+ * Reading back such an undo-mesh reads the full undo-mesh it is based on and applies the
+ * positions of all undo-meshes in-between. Freeing a base undo-mesh that is still used keeps
+ * its data until the undo-meshes depending on it are freed too.
+ * \{ */
+
+struct UndoMeshPositionsTag {
+  UndoMeshPositionsTag *next, *prev;
+  const BMesh *bm;
+  /** The active undo step when tagging, the positions are relative to its state. */
+  const UndoStep *us_active;
+  int *vert_indices;
+  float (*vert_positions)[3];
+  int verts_len;
+};
+
+static struct {
+  /** #UndoMeshPositionsTag items, used by the next undo push. */
+  ListBase tags;
+  /** Positions-only undo-meshes, linked by `local_next` & `local_prev`. */
+  ListBase delta_links;
+} um_delta = {{nullptr}};
+
+static void um_delta_tag_free(UndoMeshPositionsTag *tag)
+{
+  MEM_freeN(tag->vert_indices);
+  MEM_freeN(tag->vert_positions);
+  MEM_freeN(tag);
+}
+
+void EDBM_undo_tag_positions(BMEditMesh *em, BMVert **verts, const int verts_len)
+{
+  UndoStack *ustack = ED_undo_stack_get();
+  if (ustack == nullptr || U.undosteps <= 0) {
+    return;
+  }
+
+  BMesh *bm = em->bm;
+  LISTBASE_FOREACH_MUTABLE (UndoMeshPositionsTag *, tag, &um_delta.tags) {
+    if (tag->bm == bm) {
+      BLI_remlink(&um_delta.tags, tag);
+      um_delta_tag_free(tag);
+    }
+  }
+
+  BM_mesh_elem_index_ensure(bm, BM_VERT);
+
+  UndoMeshPositionsTag *tag = MEM_cnew<UndoMeshPositionsTag>(__func__);
+  tag->bm = bm;
+  tag->us_active = ustack->step_active;
+  tag->vert_indices = static_cast<int *>(
+      MEM_malloc_arrayN(size_t(verts_len), sizeof(int), __func__));
+  tag->vert_positions = static_cast<float(*)[3]>(
+      MEM_malloc_arrayN(size_t(verts_len), sizeof(float[3]), __func__));
+  tag->verts_len = verts_len;
+  for (int i = 0; i < verts_len; i++) {
+    tag->vert_indices[i] = BM_elem_index_get(verts[i]);
+    copy_v3_v3(tag->vert_positions[i], verts[i]->co);
+  }
+  BLI_addtail(&um_delta.tags, tag);
+}
+
+static void um_delta_tags_clear()
+{
+  LISTBASE_FOREACH_MUTABLE (UndoMeshPositionsTag *, tag, &um_delta.tags) {
+    um_delta_tag_free(tag);
+  }
+  BLI_listbase_clear(&um_delta.tags);
+}
+
+/**
+ * Store only the tagged positions of `em` when they were tagged while `us_base` was active,
+ * so the state of `em` matches `um_base` apart from them.
+ * \return False when a full undo-mesh must be stored.
+ */
+static bool undomesh_from_editmesh_delta(UndoMesh *um,
+                                         BMEditMesh *em,
+                                         UndoMesh *um_base,
+                                         const UndoStep *us_base)
+{
+  BMesh *bm = em->bm;
+  const UndoMeshPositionsTag *tag = nullptr;
+  LISTBASE_FOREACH (const UndoMeshPositionsTag *, tag_iter, &um_delta.tags) {
+    if (tag_iter->bm == bm && tag_iter->us_active == us_base) {
+      tag = tag_iter;
+      break;
+    }
+  }
+  if (tag == nullptr) {
+    return false;
+  }
+
+  /* Find the full undo-mesh to check the element counts against. */
+  const UndoMesh *um_full = um_base;
+  while (um_full->delta_base) {
+    um_full = um_full->delta_base;
+  }
+  const Mesh *me = &um_full->me;
+  if (me->totvert != bm->totvert || me->totedge != bm->totedge ||
+      me->totpoly != bm->totface || me->totloop != bm->totloop ||
+      um_base->selectmode != em->selectmode || um_base->shapenr != bm->shapenr) {
+    return false;
+  }
+
+  um->delta_base = um_base;
+  um_base->delta_users += 1;
+  um->delta_verts_len = tag->verts_len;
+  um->delta_vert_indices = static_cast<int *>(MEM_dupallocN(tag->vert_indices));
+  um->delta_vert_positions = static_cast<float(*)[3]>(MEM_dupallocN(tag->vert_positions));
+
+  um->selectmode = em->selectmode;
+  um->shapenr = bm->shapenr;
+  um->undo_size = size_t(tag->verts_len) * (sizeof(int) + sizeof(float[3]));
+
+  BLI_addtail(&um_delta.delta_links, um);
+  return true;
+}
+
+/** Move the data of an undo-mesh that is freed but still used as `delta_base`. */
+static void undomesh_detach(UndoMesh *um)
+{
+  BLI_assert(um->delta_users != 0);
+
+#ifdef USE_ARRAY_STORE_THREAD
+  /* The array store may be using the undo-mesh. */
+  if (um_arraystore.task_pool) {
+    BLI_task_pool_work_and_wait(um_arraystore.task_pool);
+  }
+#endif
+
+  UndoMesh *um_detached = static_cast<UndoMesh *>(MEM_mallocN(sizeof(*um), __func__));
+  memcpy(um_detached, um, sizeof(*um));
+  um_detached->is_detached = true;
+
+  if (um->delta_base) {
+    BLI_insertlinkreplace(&um_delta.delta_links, um, um_detached);
+  }
+#ifdef USE_ARRAY_STORE
+  else {
+    BLI_insertlinkreplace(&um_arraystore.local_links, um, um_detached);
+  }
+#endif
+
+  LISTBASE_FOREACH (UndoMesh *, um_iter, &um_delta.delta_links) {
+    if (um_iter->delta_base == um) {
+      um_iter->delta_base = um_detached;
+    }
+  }
+}
+
+/** \} */
+
 /* for callbacks */
 /* undo simply makes copies of a bmesh */
 /**
@@ -646,6 +821,13 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em)
   BMEditMesh *em_tmp;
   BMesh *bm;
 
+  /* Positions-only undo-meshes are applied on top of the full undo-mesh they are based on. */
+  blender::Vector<const UndoMesh *> um_deltas;
+  while (um->delta_base) {
+    um_deltas.append(um);
+    um = um->delta_base;
+  }
+
 #ifdef USE_ARRAY_STORE
 #  ifdef USE_ARRAY_STORE_THREAD
   /* changes this waits is low, but must have finished */
@@ -680,6 +862,17 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em)
   convert_params.active_shapekey = um->shapenr;
   BM_mesh_bm_from_me(bm, &um->me, &convert_params);
 
+  if (!um_deltas.is_empty()) {
+    BM_mesh_elem_table_ensure(bm, BM_VERT);
+    for (int i = um_deltas.size() - 1; i >= 0; i--) {
+      const UndoMesh *um_delta = um_deltas[i];
+      for (int j = 0; j < um_delta->delta_verts_len; j++) {
+        copy_v3_v3(BM_vert_at_index(bm, um_delta->delta_vert_indices[j])->co,
+                   um_delta->delta_vert_positions[j]);
+      }
+    }
+  }
+
   em_tmp = BKE_editmesh_create(bm);
   *em = *em_tmp;
 
@@ -706,6 +899,24 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em)
 
 static void undomesh_free_data(UndoMesh *um)
 {
+  if (um->delta_users != 0) {
+    undomesh_detach(um);
+    return;
+  }
+
+  if (UndoMesh *um_base = um->delta_base) {
+    BLI_remlink(&um_delta.delta_links, um);
+    MEM_freeN(um->delta_vert_indices);
+    MEM_freeN(um->delta_vert_positions);
+
+    um_base->delta_users -= 1;
+    if (um_base->is_detached && um_base->delta_users == 0) {
+      undomesh_free_data(um_base);
+      MEM_freeN(um_base);
+    }
+    return;
+  }
+
   Mesh *me = &um->me;
 
 #ifdef USE_ARRAY_STORE
@@ -771,6 +982,23 @@ static bool mesh_undosys_poll(bContext *C)
   return editmesh_object_from_context(C) != nullptr;
 }
 
+static bool mesh_undosys_step_encode(bContext *C, Main *bmain, UndoStep *us_p);
+
+/** The undo-mesh of `ob` in the active undo step, when that is an edit-mesh step. */
+static UndoMesh *mesh_undostep_active_elem_find(UndoStep *us_active, const Object *ob)
+{
+  if (us_active == nullptr || us_active->type->step_encode != mesh_undosys_step_encode) {
+    return nullptr;
+  }
+  MeshUndoStep *us = (MeshUndoStep *)us_active;
+  for (uint i = 0; i < us->elems_len; i++) {
+    if (us->elems[i].obedit_ref.ptr == ob) {
+      return &us->elems[i].data;
+    }
+  }
+  return nullptr;
+}
+
 static bool mesh_undosys_step_encode(bContext *C, Main *bmain, UndoStep *us_p)
 {
   MeshUndoStep *us = (MeshUndoStep *)us_p;
@@ -788,6 +1016,7 @@ static bool mesh_undosys_step_encode(bContext *C, Main *bmain, UndoStep *us_p)
   us->elems_len = objects_len;
 
   UndoMesh **um_references = nullptr;
+  UndoStep *us_active = ED_undo_stack_get()->step_active;
 
 #ifdef USE_ARRAY_STORE
   um_references = mesh_undostep_reference_elems_from_objects(objects, objects_len);
@@ -800,8 +1029,12 @@ static bool mesh_undosys_step_encode(bContext *C, Main *bmain, UndoStep *us_p)
     elem->obedit_ref.ptr = ob;
     Mesh *me = static_cast<Mesh *>(elem->obedit_ref.ptr->data);
     BMEditMesh *em = me->edit_mesh;
-    undomesh_from_editmesh(
-        &elem->data, me->edit_mesh, me->key, um_references ? um_references[i] : nullptr);
+    /* The step isn't added to the stack yet, so the active step is the previous state. */
+    UndoMesh *um_base = mesh_undostep_active_elem_find(us_active, ob);
+    if (!(um_base && undomesh_from_editmesh_delta(&elem->data, em, um_base, us_active))) {
+      undomesh_from_editmesh(
+          &elem->data, me->edit_mesh, me->key, um_references ? um_references[i] : nullptr);
+    }
     em->needs_flush_to_id = 1;
     us->step.data_size += elem->data.undo_size;
     elem->data.uv_selectmode = ts->uv_selectmode;
@@ -816,6 +1049,7 @@ static bool mesh_undosys_step_encode(bContext *C, Main *bmain, UndoStep *us_p)
   if (um_references != nullptr) {
     MEM_freeN(um_references);
   }
+  um_delta_tags_clear();
 
   bmain->is_memfile_undo_flush_needed = true;
 
@@ -149,6 +149,9 @@ typedef struct SculptUndoNodeGeometry {
   int totpoly;
 } SculptUndoNodeGeometry;
 
+/** Number of arrays of a #SculptUndoNode that are packed into the undo array store. */
+#define SCULPT_UNDO_ARRAY_NUM 10
+
 typedef struct SculptUndoNode {
   struct SculptUndoNode *next, *prev;
 
@@ -213,9 +216,31 @@ typedef struct SculptUndoNode {
   PBVHFaceRef *faces;
   int faces_num;
 
+  /* Array store states of the arrays above, once the undo step has been pushed.
+   * When a state is set and the array is null the data is only stored in the state. */
+  struct BArrayState *array_states[SCULPT_UNDO_ARRAY_NUM];
+
   size_t undo_size;
 } SculptUndoNode;
 
+/** The nodes of a sculpt undo step. */
+typedef struct UndoSculpt {
+  ListBase nodes;
+
+  size_t undo_size;
+  /** Memory used once the arrays are packed, #undo_size minus the packed arrays plus what they
+   * added to the array store. Set by the packing task. */
+  size_t undo_size_packed;
+  /** The size reported to the undo system, updated once packing finished. Can be null. */
+  size_t *step_size_p;
+
+  /** The node arrays are (or have been) stored in the array store. */
+  bool use_array_store;
+  /** The node arrays are only stored in the array store. Accessed atomically, see
+   * #SCULPT_undo_nodes_ensure_unpacked. */
+  int is_packed;
+} UndoSculpt;
+
 /* Factor of brush to have rake point following behind
  * (could be configurable but this is reasonable default). */
 #define SCULPT_RAKE_BRUSH_FACTOR 0.25f
@@ -1598,6 +1623,27 @@ void SCULPT_undo_push_begin_ex(struct Object *ob, const char *name);
 void SCULPT_undo_push_end(struct Object *ob);
 void SCULPT_undo_push_end_ex(struct Object *ob, const bool use_nested_undo);
 
+/**
+ * Pack the arrays of the nodes into the undo array store in the background. The reported size of
+ * the step is updated the next time the packing task is waited for.
+ * \param usculpt_ref: The previously pushed data to de-duplicate against, can be null.
+ */
+void SCULPT_undo_nodes_pack_schedule(UndoSculpt *usculpt, const UndoSculpt *usculpt_ref);
+/**
+ * Expand the packed arrays before the step is restored. The array store states are kept as
+ * reference, the step is expected to be packed again afterwards. Main thread only.
+ */
+void SCULPT_undo_nodes_unpack(UndoSculpt *usculpt);
+/**
+ * Make the arrays of a packed step accessible, for access to its nodes outside of undo and redo.
+ * The step stops using the array store, since its arrays may be changed. Thread safe.
+ */
+void SCULPT_undo_nodes_ensure_unpacked(UndoSculpt *usculpt);
+/** Free the array store data of the nodes, the arrays that are not packed are kept. */
+void SCULPT_undo_nodes_arraystore_free(UndoSculpt *usculpt);
+/** Wait until the arrays of the last pushed step are packed. */
+void SCULPT_undo_arraystore_wait(void);
+
 /** \} */
 
 void SCULPT_vertcos_to_key(Object *ob, KeyBlock *kb, const float (*vertCos)[3]);
@@ -33,6 +33,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
+#include "BLI_array_store.h"
+#include "BLI_array_store_utils.h"
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
@@ -125,12 +129,6 @@
 
 #define NO_ACTIVE_LAYER ATTR_DOMAIN_AUTO
 
-typedef struct UndoSculpt {
-  ListBase nodes;
-
-  size_t undo_size;
-} UndoSculpt;
-
 typedef struct SculptAttrRef {
   eAttrDomain domain;
   int type;
@@ -1106,6 +1104,298 @@ static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase
   MEM_SAFE_FREE(undo_modified_grids);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Array Store
+ *
+ * Once an undo step is pushed its arrays are only needed again when the step is undone or
+ * redone. They are packed into an array store from a background task, using the nodes of the
+ * previous step as reference. Strokes usually only change part of the data of the PBVH nodes
+ * they touch, so most of the data is shared between steps. Packed arrays are expanded again
+ * (in parallel over the nodes) when the step is decoded.
+ *
+ * All access to the array store happens either in the task pool, or after waiting for the pool on
+ * the main thread or while holding #sculpt_undo_unpack_lock (when nodes are accessed from tasks
+ * that run while the main thread waits for them).
+ * \{ */
+
+/* Amount of elements per chunk, as for edit-mesh undo. */
+#define ARRAY_CHUNK_SIZE 256
+
+static struct {
+  struct BArrayStore_AtSize bs_stride;
+  /** Number of undo steps using the array store. */
+  int users;
+  TaskPool *task_pool;
+  /** Data that is packed by the task pool, its size is reported once packing finished. */
+  UndoSculpt *packing;
+} sculpt_undo_arraystore = {{NULL}};
+
+/** Unpacking through #SCULPT_undo_get_node may happen from several threads at once. */
+static ThreadMutex sculpt_undo_unpack_lock = BLI_MUTEX_INITIALIZER;
+
+typedef struct SculptUndoArrayMember {
+  size_t offset;
+  int stride;
+} SculptUndoArrayMember;
+
+/** Arrays of #SculptUndoNode that are packed, in the order of #SculptUndoNode.array_states. */
+static const SculptUndoArrayMember sculpt_undo_array_members[] = {
+    {offsetof(SculptUndoNode, co), sizeof(float[3])},
+    {offsetof(SculptUndoNode, orig_co), sizeof(float[3])},
+    {offsetof(SculptUndoNode, col), sizeof(float[4])},
+    {offsetof(SculptUndoNode, loop_col), sizeof(float[4])},
+    {offsetof(SculptUndoNode, mask), sizeof(float)},
+    {offsetof(SculptUndoNode, index), sizeof(int)},
+    {offsetof(SculptUndoNode, loop_index), sizeof(int)},
+    {offsetof(SculptUndoNode, grids), sizeof(int)},
+    {offsetof(SculptUndoNode, face_sets), sizeof(int)},
+    {offsetof(SculptUndoNode, faces), sizeof(PBVHFaceRef)},
+};
+BLI_STATIC_ASSERT(ARRAY_SIZE(sculpt_undo_array_members) == SCULPT_UNDO_ARRAY_NUM,
+                  "Array store members mismatch")
+
+static void **sculpt_undo_array_member_get(SculptUndoNode *unode, const int i)
+{
+  return (void **)POINTER_OFFSET(unode, sculpt_undo_array_members[i].offset);
+}
+
+/**
+ * Move the arrays of the node into the array store.
+ * Existing states of the node (from before it was expanded) are replaced.
+ * \return The size of the arrays that were freed.
+ */
+static size_t sculpt_undo_node_pack(SculptUndoNode *unode, const SculptUndoNode *unode_ref)
+{
+  size_t freed_size = 0;
+  for (int i = 0; i < SCULPT_UNDO_ARRAY_NUM; i++) {
+    void **data_p = sculpt_undo_array_member_get(unode, i);
+    if (*data_p == NULL) {
+      continue;
+    }
+    BArrayStore *bs = BLI_array_store_at_size_ensure(&sculpt_undo_arraystore.bs_stride,
+                                                     sculpt_undo_array_members[i].stride,
+                                                     ARRAY_CHUNK_SIZE);
+    BArrayState *state_prev = unode->array_states[i];
+    const BArrayState *state_ref = state_prev ? state_prev :
+                                   unode_ref  ? unode_ref->array_states[i] :
+                                                NULL;
+    unode->array_states[i] = BLI_array_store_state_add(
+        bs, *data_p, MEM_allocN_len(*data_p), state_ref);
+    if (state_prev) {
+      BLI_array_store_state_remove(bs, state_prev);
+    }
+    freed_size += MEM_allocN_len(*data_p);
+    MEM_freeN(*data_p);
+    *data_p = NULL;
+  }
+  return freed_size;
+}
+
+/** Expand the packed arrays of the node, the states are kept as reference for re-packing. */
+static void sculpt_undo_node_unpack(SculptUndoNode *unode)
+{
+  for (int i = 0; i < SCULPT_UNDO_ARRAY_NUM; i++) {
+    void **data_p = sculpt_undo_array_member_get(unode, i);
+    if (*data_p == NULL && unode->array_states[i]) {
+      size_t data_len;
+      *data_p = BLI_array_store_state_data_get_alloc(unode->array_states[i], &data_len);
+    }
+  }
+}
+
+static void sculpt_undo_node_states_free(SculptUndoNode *unode)
+{
+  for (int i = 0; i < SCULPT_UNDO_ARRAY_NUM; i++) {
+    if (unode->array_states[i]) {
+      BArrayStore *bs = BLI_array_store_at_size_get(&sculpt_undo_arraystore.bs_stride,
+                                                    sculpt_undo_array_members[i].stride);
+      BLI_array_store_state_remove(bs, unode->array_states[i]);
+      unode->array_states[i] = NULL;
+    }
+  }
+}
+
+void SCULPT_undo_arraystore_wait(void)
+{
+  if (sculpt_undo_arraystore.task_pool) {
+    BLI_task_pool_work_and_wait(sculpt_undo_arraystore.task_pool);
+  }
+  UndoSculpt *usculpt = sculpt_undo_arraystore.packing;
+  if (usculpt) {
+    if (usculpt->step_size_p) {
+      *usculpt->step_size_p = usculpt->undo_size_packed;
+    }
+    sculpt_undo_arraystore.packing = NULL;
+  }
+}
+
+static void sculpt_undo_pack_nodes(UndoSculpt *usculpt, const UndoSculpt *usculpt_ref)
+{
+  /* Nodes of the reference step, by PBVH node and type. The PBVH node pointers are only used as
+   * keys, a wrong match only makes de-duplication less effective. */
+  GHash *ref_map = NULL;
+  if (usculpt_ref) {
+    ref_map = BLI_ghash_new(BLI_ghashutil_pairhash, BLI_ghashutil_paircmp, __func__);
+    LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt_ref->nodes) {
+      if (unode->node) {
+        GHashPair *key = BLI_ghashutil_pairalloc(unode->node, POINTER_FROM_INT(unode->type));
+        void **val_p;
+        if (BLI_ghash_ensure_p(ref_map, key, &val_p)) {
+          BLI_ghashutil_pairfree(key);
+        }
+        else {
+          *val_p = unode;
+        }
+      }
+    }
+  }
+
+  size_t size_expanded_prev, size_compacted_prev;
+  BLI_array_store_at_size_calc_memory_usage(
+      &sculpt_undo_arraystore.bs_stride, &size_expanded_prev, &size_compacted_prev);
+
+  size_t freed_size = 0;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    const SculptUndoNode *unode_ref = NULL;
+    if (ref_map && unode->node) {
+      const GHashPair key = {unode->node, POINTER_FROM_INT(unode->type)};
+      unode_ref = BLI_ghash_lookup(ref_map, &key);
+    }
+    freed_size += sculpt_undo_node_pack(unode, unode_ref);
+  }
+
+  /* Only the chunks that are not shared with other steps add to the size of the store. */
+  size_t size_expanded, size_compacted;
+  BLI_array_store_at_size_calc_memory_usage(
+      &sculpt_undo_arraystore.bs_stride, &size_expanded, &size_compacted);
+  const size_t size_added = size_compacted > size_compacted_prev ?
+                                size_compacted - size_compacted_prev :
+                                0;
+  usculpt->undo_size_packed = (usculpt->undo_size > freed_size ?
+                                   usculpt->undo_size - freed_size :
+                                   0) +
+                              size_added;
+
+  if (ref_map) {
+    BLI_ghash_free(ref_map, BLI_ghashutil_pairfree, NULL);
+  }
+}
+
+typedef struct SculptUndoPackData {
+  UndoSculpt *usculpt;
+  /** Can be null. */
+  const UndoSculpt *usculpt_ref;
+} SculptUndoPackData;
+
+static void sculpt_undo_pack_nodes_cb(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  SculptUndoPackData *data = taskdata;
+  sculpt_undo_pack_nodes(data->usculpt, data->usculpt_ref);
+}
+
+void SCULPT_undo_nodes_pack_schedule(UndoSculpt *usculpt, const UndoSculpt *usculpt_ref)
+{
+  /* Tasks modify the array store, so only one may run at a time. */
+  SCULPT_undo_arraystore_wait();
+
+  sculpt_undo_arraystore.packing = usculpt;
+
+  if (!usculpt->use_array_store) {
+    usculpt->use_array_store = true;
+    sculpt_undo_arraystore.users += 1;
+  }
+  atomic_store_int32(&usculpt->is_packed, true);
+
+  if (sculpt_undo_arraystore.task_pool == NULL) {
+    sculpt_undo_arraystore.task_pool = BLI_task_pool_create_background(NULL, TASK_PRIORITY_LOW);
+  }
+
+  SculptUndoPackData *data = MEM_mallocN(sizeof(*data), __func__);
+  data->usculpt = usculpt;
+  data->usculpt_ref = (usculpt_ref && usculpt_ref->use_array_store) ? usculpt_ref : NULL;
+  BLI_task_pool_push(
+      sculpt_undo_arraystore.task_pool, sculpt_undo_pack_nodes_cb, data, true, NULL);
+}
+
+static void sculpt_undo_unpack_node_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SculptUndoNode **unodes = userdata;
+  sculpt_undo_node_unpack(unodes[i]);
+}
+
+static void sculpt_undo_unpack_nodes_impl(UndoSculpt *usculpt)
+{
+  SCULPT_undo_arraystore_wait();
+
+  const int nodes_num = BLI_listbase_count(&usculpt->nodes);
+  SculptUndoNode **unodes = MEM_malloc_arrayN(nodes_num, sizeof(*unodes), __func__);
+  int i = 0;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    unodes[i++] = unode;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, nodes_num, unodes, sculpt_undo_unpack_node_cb, &settings);
+
+  MEM_freeN(unodes);
+}
+
+void SCULPT_undo_nodes_unpack(UndoSculpt *usculpt)
+{
+  BLI_assert(BLI_thread_is_main());
+  if (!usculpt->is_packed) {
+    return;
+  }
+  sculpt_undo_unpack_nodes_impl(usculpt);
+  atomic_store_int32(&usculpt->is_packed, false);
+}
+
+void SCULPT_undo_nodes_ensure_unpacked(UndoSculpt *usculpt)
+{
+  if (!atomic_load_int32(&usculpt->is_packed)) {
+    return;
+  }
+  BLI_mutex_lock(&sculpt_undo_unpack_lock);
+  if (usculpt->is_packed) {
+    sculpt_undo_unpack_nodes_impl(usculpt);
+    /* The caller may change the arrays, so the states would be outdated. Nothing packs the
+     * step again, so it keeps the expanded arrays and reports their size. */
+    SCULPT_undo_nodes_arraystore_free(usculpt);
+    if (usculpt->step_size_p) {
+      *usculpt->step_size_p = usculpt->undo_size;
+    }
+    atomic_store_int32(&usculpt->is_packed, false);
+  }
+  BLI_mutex_unlock(&sculpt_undo_unpack_lock);
+}
+
+void SCULPT_undo_nodes_arraystore_free(UndoSculpt *usculpt)
+{
+  if (!usculpt->use_array_store) {
+    return;
+  }
+  SCULPT_undo_arraystore_wait();
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    sculpt_undo_node_states_free(unode);
+  }
+  usculpt->use_array_store = false;
+  usculpt->is_packed = false;
+
+  sculpt_undo_arraystore.users -= 1;
+  BLI_assert(sculpt_undo_arraystore.users >= 0);
+  if (sculpt_undo_arraystore.users == 0) {
+    BLI_array_store_at_size_clear(&sculpt_undo_arraystore.bs_stride);
+    BLI_task_pool_free(sculpt_undo_arraystore.task_pool);
+    sculpt_undo_arraystore.task_pool = NULL;
+  }
+}
+
+/** \} */
+
 static void sculpt_undo_free_list(ListBase *lb)
 {
   SculptUndoNode *unode = lb->first;
@@ -1201,6 +1491,7 @@ SculptUndoNode *SCULPT_undo_get_node(PBVHNode *node, SculptUndoType type)
   if (usculpt == NULL) {
     return NULL;
   }
+  SCULPT_undo_nodes_ensure_unpacked(usculpt);
 
   LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
     if (unode->node == node && unode->type == type) {
@@ -1218,6 +1509,7 @@ SculptUndoNode *SCULPT_undo_get_first_node()
   if (usculpt == NULL) {
     return NULL;
   }
+  SCULPT_undo_nodes_ensure_unpacked(usculpt);
 
   return usculpt->nodes.first;
 }
@@ -1882,6 +2174,7 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
   /* Dummy, encoding is done along the way by adding tiles
    * to the current 'SculptUndoStep' added by encode_init. */
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+  /* Replaced by the packed size once the arrays are packed. */
   us->step.data_size = us->data.undo_size;
 
   SculptUndoNode *unode = us->data.nodes.last;
@@ -1892,6 +2185,14 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
 
   if (!BLI_listbase_is_empty(&us->data.nodes)) {
     bmain->is_memfile_undo_flush_needed = true;
+
+    /* The step is not added to the stack yet, the active step is the previous one. */
+    UndoStep *us_prev = ED_undo_stack_get()->step_active;
+    us->data.step_size_p = &us->step.data_size;
+    SCULPT_undo_nodes_pack_schedule(&us->data,
+                                    (us_prev && us_prev->type == BKE_UNDOSYS_TYPE_SCULPT) ?
+                                        sculpt_undosys_step_get_nodes(us_prev) :
+                                        NULL);
   }
 
   return true;
@@ -1903,7 +2204,12 @@ static void sculpt_undosys_step_decode_undo_impl(struct bContext *C,
 {
   BLI_assert(us->step.is_applied == true);
 
+  SCULPT_undo_nodes_unpack(&us->data);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  if (us->data.use_array_store) {
+    /* Restoring swaps the data, pack the other side. */
+    SCULPT_undo_nodes_pack_schedule(&us->data, NULL);
+  }
   us->step.is_applied = false;
 
   sculpt_undo_print_nodes(CTX_data_active_object(C), NULL);
@@ -1915,7 +2221,12 @@ static void sculpt_undosys_step_decode_redo_impl(struct bContext *C,
 {
   BLI_assert(us->step.is_applied == false);
 
+  SCULPT_undo_nodes_unpack(&us->data);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  if (us->data.use_array_store) {
+    /* Restoring swaps the data, pack the other side. */
+    SCULPT_undo_nodes_pack_schedule(&us->data, NULL);
+  }
   us->step.is_applied = true;
 
   sculpt_undo_print_nodes(CTX_data_active_object(C), NULL);
@@ -2032,6 +2343,7 @@ static void sculpt_undosys_step_decode(
 static void sculpt_undosys_step_free(UndoStep *us_p)
 {
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+  SCULPT_undo_nodes_arraystore_free(&us->data);
   sculpt_undo_free_list(&us->data.nodes);
 }
 
@@ -0,0 +1,170 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_listbase.h"
+#include "BLI_task.hh"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "sculpt_intern.h"
+
+namespace blender::ed::sculpt_paint::undo::tests {
+
+class sculpt_undo_test : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BLI_threadapi_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    BLI_threadapi_exit();
+  }
+};
+
+static const int verts_num = 10000;
+
+/** Add a node with coordinates, like the nodes pushed by a sculpt stroke. */
+static void add_node(UndoSculpt &usculpt, const int key, const float offset)
+{
+  SculptUndoNode *unode = MEM_cnew<SculptUndoNode>(__func__);
+  /* Only used as key to find the matching node of the previous step. */
+  unode->node = POINTER_FROM_INT(key + 1);
+  unode->type = SCULPT_UNDO_COORDS;
+  unode->totvert = verts_num;
+  unode->co = static_cast<float(*)[3]>(MEM_malloc_arrayN(verts_num, sizeof(float[3]), __func__));
+  for (const int i : IndexRange(verts_num)) {
+    unode->co[i][0] = float(i);
+    unode->co[i][1] = offset;
+    unode->co[i][2] = float(key);
+  }
+  unode->undo_size = MEM_allocN_len(unode->co);
+  usculpt.undo_size += unode->undo_size;
+  BLI_addtail(&usculpt.nodes, unode);
+}
+
+static void add_nodes(UndoSculpt &usculpt, const int nodes_num)
+{
+  for (const int i : IndexRange(nodes_num)) {
+    add_node(usculpt, i, 0.0f);
+  }
+}
+
+static bool node_coords_equal(const SculptUndoNode &unode, const int key, const float offset)
+{
+  if (unode.co == nullptr) {
+    return false;
+  }
+  for (const int i : IndexRange(verts_num)) {
+    if (unode.co[i][0] != float(i) || unode.co[i][1] != offset || unode.co[i][2] != float(key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void free_nodes(UndoSculpt &usculpt)
+{
+  SCULPT_undo_nodes_arraystore_free(&usculpt);
+  LISTBASE_FOREACH_MUTABLE (SculptUndoNode *, unode, &usculpt.nodes) {
+    MEM_SAFE_FREE(unode->co);
+    MEM_freeN(unode);
+  }
+  BLI_listbase_clear(&usculpt.nodes);
+}
+
+TEST_F(sculpt_undo_test, pack_and_unpack)
+{
+  UndoSculpt usculpt = {};
+  size_t step_size = 0;
+  usculpt.step_size_p = &step_size;
+  add_nodes(usculpt, 8);
+
+  SCULPT_undo_nodes_pack_schedule(&usculpt, nullptr);
+  SCULPT_undo_arraystore_wait();
+  EXPECT_TRUE(usculpt.is_packed);
+  EXPECT_EQ(step_size, usculpt.undo_size_packed);
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt.nodes) {
+    EXPECT_EQ(unode->co, nullptr);
+    EXPECT_NE(unode->array_states[0], nullptr);
+  }
+
+  /* Decoding keeps the states as reference to pack the step again. */
+  SCULPT_undo_nodes_unpack(&usculpt);
+  EXPECT_FALSE(usculpt.is_packed);
+  int key = 0;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt.nodes) {
+    EXPECT_TRUE(node_coords_equal(*unode, key++, 0.0f));
+    EXPECT_NE(unode->array_states[0], nullptr);
+  }
+  SCULPT_undo_nodes_pack_schedule(&usculpt, nullptr);
+  SCULPT_undo_arraystore_wait();
+  EXPECT_TRUE(usculpt.is_packed);
+
+  free_nodes(usculpt);
+}
+
+TEST_F(sculpt_undo_test, deduplicate_with_previous_step)
+{
+  UndoSculpt usculpt_prev = {};
+  add_nodes(usculpt_prev, 8);
+  SCULPT_undo_nodes_pack_schedule(&usculpt_prev, nullptr);
+
+  /* Only one node differs from the previous step. */
+  UndoSculpt usculpt = {};
+  size_t step_size = 0;
+  usculpt.step_size_p = &step_size;
+  add_node(usculpt, 0, 1.0f);
+  for (const int i : IndexRange(1, 7)) {
+    add_node(usculpt, i, 0.0f);
+  }
+  SCULPT_undo_nodes_pack_schedule(&usculpt, &usculpt_prev);
+  SCULPT_undo_arraystore_wait();
+  EXPECT_LT(step_size, usculpt.undo_size / 4);
+
+  SCULPT_undo_nodes_unpack(&usculpt);
+  EXPECT_TRUE(node_coords_equal(*static_cast<SculptUndoNode *>(usculpt.nodes.first), 0, 1.0f));
+
+  free_nodes(usculpt);
+  free_nodes(usculpt_prev);
+}
+
+TEST_F(sculpt_undo_test, ensure_unpacked_from_tasks)
+{
+  UndoSculpt usculpt = {};
+  size_t step_size = 0;
+  usculpt.step_size_p = &step_size;
+  add_nodes(usculpt, 8);
+  SCULPT_undo_nodes_pack_schedule(&usculpt, nullptr);
+
+  /* Nodes are accessed from the tasks of a brush, the first access unpacks them. */
+  Array<bool> valid(64, false);
+  threading::parallel_for(valid.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      SCULPT_undo_nodes_ensure_unpacked(&usculpt);
+      const SculptUndoNode *unode = static_cast<SculptUndoNode *>(
+          BLI_findlink(&usculpt.nodes, i % 8));
+      valid[i] = node_coords_equal(*unode, i % 8, 0.0f);
+    }
+  });
+  for (const bool node_valid : valid) {
+    EXPECT_TRUE(node_valid);
+  }
+
+  /* The arrays may be modified now, so the step doesn't use the array store anymore. */
+  EXPECT_FALSE(usculpt.is_packed);
+  EXPECT_FALSE(usculpt.use_array_store);
+  EXPECT_EQ(step_size, usculpt.undo_size);
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt.nodes) {
+    EXPECT_EQ(unode->array_states[0], nullptr);
+  }
+
+  free_nodes(usculpt);
+}
+
+}  // namespace blender::ed::sculpt_paint::undo::tests
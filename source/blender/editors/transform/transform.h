@@ -138,8 +138,14 @@ typedef enum {
 
   /** No cursor wrapping on region bounds */
   T_NO_CURSOR_WRAP = 1 << 23,
+
+  /**
+   * Transform runs as an operator of its own (not in a macro or from another operator),
+   * so the undo push of the operator directly follows the changes made by transform.
+   */
+  T_OWN_UNDO_PUSH = 1 << 24,
 } eTFlag;
-ENUM_OPERATORS(eTFlag, T_NO_CURSOR_WRAP);
+ENUM_OPERATORS(eTFlag, T_OWN_UNDO_PUSH);
 
 #define T_ALL_RESTRICTIONS (T_NO_CONSTRAINT | T_NULL_ONE)
 #define T_PROP_EDIT_ALL (T_PROP_EDIT | T_PROP_CONNECTED | T_PROP_PROJECTED)
@@ -2076,6 +2076,52 @@ static void recalcData_mesh(TransInfo *t)
 /** \name Special After Transform Mesh
  * \{ */
 
+/**
+ * Only vertex positions changed, let the undo push store only the transformed vertices
+ * instead of the whole mesh.
+ */
+static void tc_mesh_undo_tag_positions(TransInfo *t)
+{
+  if (!ELEM(t->mode,
+            TFM_TRANSLATION,
+            TFM_ROTATION,
+            TFM_RESIZE,
+            TFM_TOSPHERE,
+            TFM_SHEAR,
+            TFM_BEND,
+            TFM_SHRINKFATTEN,
+            TFM_TRACKBALL,
+            TFM_PUSHPULL,
+            TFM_MIRROR,
+            TFM_ALIGN,
+            TFM_EDGE_SLIDE,
+            TFM_VERT_SLIDE)) {
+    /* Other modes also change custom-data, such as custom normals. */
+    return;
+  }
+
+  FOREACH_TRANS_DATA_CONTAINER (t, tc) {
+    struct TransCustomDataMesh *tcmd = tc->custom.type.data;
+    if (tcmd && tcmd->cd_layer_correct) {
+      /* Custom-data (UV's) changed as well. */
+      continue;
+    }
+    const int verts_len = tc->data_len + tc->data_mirror_len;
+    if (verts_len == 0) {
+      continue;
+    }
+    BMVert **verts = MEM_malloc_arrayN(verts_len, sizeof(*verts), __func__);
+    for (int i = 0; i < tc->data_len; i++) {
+      verts[i] = tc->data[i].extra;
+    }
+    for (int i = 0; i < tc->data_mirror_len; i++) {
+      verts[tc->data_len + i] = tc->data_mirror[i].extra;
+    }
+    EDBM_undo_tag_positions(BKE_editmesh_from_object(tc->obedit), verts, verts_len);
+    MEM_freeN(verts);
+  }
+}
+
 static void special_aftertrans_update__mesh(bContext *UNUSED(C), TransInfo *t)
 {
   const bool is_canceling = (t->state == TRANS_CANCEL);
@@ -2128,6 +2174,11 @@ static void special_aftertrans_update__mesh(bContext *UNUSED(C), TransInfo *t)
     }
   }
 
+  if (!is_canceling && !use_automerge && (t->flag & T_OWN_UNDO_PUSH) &&
+      !(t->flag & T_CLNOR_REBUILD)) {
+    tc_mesh_undo_tag_positions(t);
+  }
+
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
     /* table needs to be created for each edit command, since vertices can move etc */
     ED_mesh_mirror_spatial_table_end(tc->obedit);
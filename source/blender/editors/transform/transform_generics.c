@@ -213,6 +213,11 @@ void initTransInfo(bContext *C, TransInfo *t, wmOperator *op, const wmEvent *eve
     t->flag |= T_EVENT_DRAG_START;
   }
 
+  if (op && (op->opm == NULL) && (op->type->flag & OPTYPE_UNDO) &&
+      (CTX_wm_manager(C)->op_undo_depth == 1)) {
+    t->flag |= T_OWN_UNDO_PUSH;
+  }
+
   /* Many kinds of transform only use a single handle. */
   if (t->data_container == NULL) {
     t->data_container = MEM_callocN(sizeof(*t->data_container), __func__);
@@ -119,6 +119,12 @@ class MultiFunction {
      * educated guess about a good grain size.
      */
     bool uniform_execution_time = true;
+    /**
+     * Tells the caller that every output element only depends on the input elements at the same
+     * index and that calling the function on few indices at a time is cheap. Calls of such
+     * functions can be fused, see #procedure_optimization::fuse_element_wise_calls.
+     */
+    bool is_element_wise = false;
   };
 
   ExecutionHints execution_hints() const;
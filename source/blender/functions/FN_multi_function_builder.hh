@@ -485,6 +485,14 @@ template<typename CallFn, typename... ParamTags> class CustomMF : public MultiFu
   {
     call_fn_(mask, params);
   }
+
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    /* The call function is always generated from an element function. */
+    hints.is_element_wise = true;
+    return hints;
+  }
 };
 
 template<typename Out, typename... In, typename ElementFn, typename ExecPreset>
@@ -270,6 +270,13 @@ class Procedure : NonCopyable, NonMovable {
   DummyInstruction &new_dummy_instruction();
   ReturnInstruction &new_return_instruction();
 
+  /**
+   * Remove an instruction that is not linked to other instructions anymore. The instruction stops
+   * using its variables and must not be accessed afterwards.
+   */
+  void remove_instruction(CallInstruction &instruction);
+  void remove_instruction(DestructInstruction &instruction);
+
   void add_parameter(ParamType::InterfaceType interface_type, Variable &variable);
   Span<ConstParameter> params() const;
 
@@ -6,6 +6,9 @@
  * \ingroup fn
  */
 
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_stack.hh"
+
 #include "FN_multi_function_procedure.hh"
 
 namespace blender::fn::multi_function {
@@ -16,12 +19,25 @@ class ProcedureExecutor : public MultiFunction {
   Signature signature_;
   const Procedure &procedure_;
 
+  struct Scratch;
+  /**
+   * Memory that is reused by multiple calls on the same thread. This avoids allocating new buffers
+   * for every chunk when the executor is called for many parts of a large mask. A stack is used
+   * because a thread may start another call while it is waiting for other tasks.
+   */
+  mutable threading::EnumerableThreadSpecific<Stack<std::unique_ptr<Scratch>>> scratch_by_thread_;
+
  public:
   ProcedureExecutor(const Procedure &procedure);
+  ~ProcedureExecutor();
 
   void call(IndexMask mask, Params params, Context context) const override;
 
  private:
+  void call_with_scratch(IndexMask full_mask,
+                         Params params,
+                         Context context,
+                         Scratch &scratch) const;
   ExecutionHints get_execution_hints() const override;
 };
 
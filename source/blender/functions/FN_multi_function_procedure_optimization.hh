@@ -44,4 +44,25 @@ namespace blender::fn::multi_function::procedure_optimization {
  */
 void move_destructs_up(Procedure &procedure, Instruction &block_end_instr);
 
+/**
+ * When a procedure is executed, every call instruction is executed for all indices before the next
+ * instruction starts, so every intermediate variable needs a buffer with a value for every index.
+ * For long chains of cheap functions (e.g. math nodes), the execution time is then dominated by
+ * memory bandwidth for writing and reading those intermediate buffers.
+ *
+ * This optimization pass replaces consecutive calls of element-wise functions (see
+ * #MultiFunction::ExecutionHints::is_element_wise) with a single call of a fused function. The
+ * fused function evaluates the whole chain for a small tile of indices at a time, so that
+ * intermediate values stay in the CPU cache. Only variables that are used outside of the chain
+ * are still written for all indices.
+ *
+ * Like #move_destructs_up, this only works on a single chain of instructions. It should run after
+ * #move_destructs_up, so that destruct instructions of intermediate variables are part of the
+ * chain that is fused.
+ *
+ * \param block_end_instr: The instruction that points to the last instruction within a linear
+ * chain of instructions. It is not changed itself.
+ */
+void fuse_element_wise_calls(Procedure &procedure, Instruction &block_end_instr);
+
 }  // namespace blender::fn::multi_function::procedure_optimization
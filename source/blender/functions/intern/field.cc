@@ -6,6 +6,7 @@
 #include "BLI_multi_value_map.hh"
 #include "BLI_set.hh"
 #include "BLI_stack.hh"
+#include "BLI_task.hh"
 #include "BLI_vector_set.hh"
 
 #include "FN_field.hh"
@@ -272,11 +273,68 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
   mf::ReturnInstruction &return_instr = builder.add_return();
 
   mf::procedure_optimization::move_destructs_up(procedure, return_instr);
+  mf::procedure_optimization::fuse_element_wise_calls(procedure, return_instr);
 
   // std::cout << procedure.to_dot() << "\n";
   BLI_assert(procedure.validate());
 }
 
+/**
+ * Find the number of indices the procedure should be evaluated for at once. All the buffers used
+ * for one chunk should fit into the CPU cache.
+ */
+static int64_t compute_procedure_chunk_size(mf::Procedure &procedure)
+{
+  /* Roughly the size of the per-core cache on common CPUs. */
+  const int64_t cache_size = 256 * 1024;
+  int64_t bytes_per_index = 0;
+  for (mf::Variable *variable : procedure.variables()) {
+    if (variable->users().is_empty()) {
+      /* Variables can become unused when calls are fused. */
+      continue;
+    }
+    const mf::DataType data_type = variable->data_type();
+    if (data_type.is_single()) {
+      bytes_per_index += data_type.single_type().size();
+    }
+  }
+  return std::clamp<int64_t>(cache_size / std::max<int64_t>(bytes_per_index, 1), 1024, 16384);
+}
+
+/**
+ * Evaluate the procedure for chunks of the mask in parallel. Every chunk runs the full procedure
+ * with smaller intermediate buffers, which are reused for the chunks evaluated by the same thread.
+ */
+static void evaluate_procedure_in_chunks(const mf::ProcedureExecutor &procedure_executor,
+                                         const int64_t chunk_size,
+                                         const IndexMask mask,
+                                         const Span<GVArray> inputs,
+                                         const Span<GMutableSpan> outputs)
+{
+  mf::ContextBuilder mf_context;
+  threading::parallel_for(mask.index_range(), chunk_size, [&](const IndexRange range) {
+    /* The range passed in can be larger than the chunk size. */
+    Vector<int64_t> offset_indices;
+    for (int64_t chunk_start = range.start(); chunk_start < range.one_after_last();
+         chunk_start += chunk_size) {
+      const IndexRange chunk_range(chunk_start,
+                                   std::min(chunk_size, range.one_after_last() - chunk_start));
+      const IndexMask chunk_mask = mask.slice_and_offset(chunk_range, offset_indices);
+      const int64_t first_index = mask[chunk_range.first()];
+      const IndexRange array_range(first_index, mask[chunk_range.last()] - first_index + 1);
+
+      mf::ParamsBuilder mf_params{procedure_executor, &chunk_mask};
+      for (const GVArray &varray : inputs) {
+        mf_params.add_readonly_single_input(varray.slice(array_range));
+      }
+      for (const GMutableSpan &span : outputs) {
+        mf_params.add_uninitialized_single_output(span.slice(array_range));
+      }
+      procedure_executor.call(chunk_mask, mf_params, mf_context);
+    }
+  });
+}
+
 Vector<GVArray> evaluate_fields(ResourceScope &scope,
                                 Span<GFieldRef> fields_to_evaluate,
                                 IndexMask mask,
@@ -372,14 +430,7 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
         procedure, scope, field_tree_info, varying_fields_to_evaluate);
     mf::ProcedureExecutor procedure_executor{procedure};
 
-    mf::ParamsBuilder mf_params{procedure_executor, &mask};
-    mf::ContextBuilder mf_context;
-
-    /* Provide inputs to the procedure executor. */
-    for (const GVArray &varray : field_context_inputs) {
-      mf_params.add_readonly_single_input(varray);
-    }
-
+    Vector<GMutableSpan> output_spans;
     for (const int i : varying_fields_to_evaluate.index_range()) {
       const GFieldRef &field = varying_fields_to_evaluate[i];
       const CPPType &type = field.cpp_type();
@@ -408,12 +459,14 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
         is_output_written_to_dst[out_index] = true;
       }
 
-      /* Pass output buffer to the procedure executor. */
-      const GMutableSpan span{type, buffer, array_size};
-      mf_params.add_uninitialized_single_output(span);
+      output_spans.append({type, buffer, array_size});
     }
 
-    procedure_executor.call_auto(mask, mf_params, mf_context);
+    evaluate_procedure_in_chunks(procedure_executor,
+                                 compute_procedure_chunk_size(procedure),
+                                 mask,
+                                 field_context_inputs,
+                                 output_spans);
   }
 
   /* Evaluate constant fields if necessary. */
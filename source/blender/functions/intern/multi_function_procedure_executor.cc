@@ -17,6 +17,8 @@ ProcedureExecutor::ProcedureExecutor(const Procedure &procedure) : procedure_(pr
   this->set_signature(&signature_);
 }
 
+ProcedureExecutor::~ProcedureExecutor() = default;
+
 using IndicesSplitVectors = std::array<Vector<int64_t>, 2>;
 
 namespace {
@@ -133,6 +135,12 @@ class ValueAllocator : NonCopyable, NonMovable {
   /** All buffers in the free-lists below have been allocated with this allocator. */
   LinearAllocator<> &linear_allocator_;
 
+  /**
+   * Number of elements in every span buffer. This can be larger than the size required by a
+   * specific call when the allocator is reused for multiple calls.
+   */
+  int64_t span_buffer_size_;
+
   /**
    * Use stacks so that the most recently used buffers are reused first. This improves cache
    * efficiency.
@@ -145,6 +153,8 @@ class ValueAllocator : NonCopyable, NonMovable {
    */
   Stack<void *> small_span_buffers_free_list_;
   Map<int, Stack<void *>> span_buffers_free_lists_;
+  /** Buffers for types that require a larger alignment than #min_alignment. */
+  Map<const CPPType *, Stack<void *>> aligned_span_buffers_free_lists_;
 
   /** Cache buffers for single values of different types. */
   static constexpr inline int small_value_max_size = 16;
@@ -153,10 +163,16 @@ class ValueAllocator : NonCopyable, NonMovable {
   Map<const CPPType *, Stack<void *>> single_value_free_lists_;
 
  public:
-  ValueAllocator(LinearAllocator<> &linear_allocator) : linear_allocator_(linear_allocator)
+  ValueAllocator(LinearAllocator<> &linear_allocator, const int64_t span_buffer_size)
+      : linear_allocator_(linear_allocator), span_buffer_size_(span_buffer_size)
   {
   }
 
+  int64_t span_buffer_size() const
+  {
+    return span_buffer_size_;
+  }
+
   VariableValue_GVArray *obtain_GVArray(const GVArray &varray)
   {
     return this->obtain<VariableValue_GVArray>(varray);
@@ -174,29 +190,27 @@ class ValueAllocator : NonCopyable, NonMovable {
 
   VariableValue_Span *obtain_Span(const CPPType &type, int size)
   {
+    BLI_assert(size <= span_buffer_size_);
+    UNUSED_VARS_NDEBUG(size);
     void *buffer = nullptr;
 
-    const int64_t element_size = type.size();
-    const int64_t alignment = type.alignment();
-
-    if (alignment > min_alignment) {
-      /* In this rare case we fallback to not reusing existing buffers. */
-      buffer = linear_allocator_.allocate(element_size * size, alignment);
-    }
-    else {
-      Stack<void *> *stack = type.can_exist_in_buffer(small_value_max_size,
-                                                      small_value_max_alignment) ?
-                                 &small_span_buffers_free_list_ :
-                                 span_buffers_free_lists_.lookup_ptr(element_size);
-      if (stack == nullptr || stack->is_empty()) {
-        buffer = linear_allocator_.allocate(
-            std::max<int64_t>(element_size, small_value_max_size) * size, min_alignment);
+    Stack<void *> &stack = this->span_buffers_free_list(type);
+    if (stack.is_empty()) {
+      const int64_t element_size = type.size();
+      const int64_t alignment = type.alignment();
+      if (alignment > min_alignment) {
+        buffer = linear_allocator_.allocate(element_size * span_buffer_size_, alignment);
       }
       else {
-        /* Reuse existing buffer. */
-        buffer = stack->pop();
+        buffer = linear_allocator_.allocate(
+            std::max<int64_t>(element_size, small_value_max_size) * span_buffer_size_,
+            min_alignment);
       }
     }
+    else {
+      /* Reuse existing buffer. */
+      buffer = stack.pop();
+    }
 
     return this->obtain<VariableValue_Span>(buffer, true);
   }
@@ -247,11 +261,7 @@ class ValueAllocator : NonCopyable, NonMovable {
         if (value_typed->owned) {
           const CPPType &type = data_type.single_type();
           /* Assumes all values in the buffer are uninitialized already. */
-          Stack<void *> &buffers = type.can_exist_in_buffer(small_value_max_size,
-                                                            small_value_max_alignment) ?
-                                       small_span_buffers_free_list_ :
-                                       span_buffers_free_lists_.lookup_or_add_default(type.size());
-          buffers.push(value_typed->data);
+          this->span_buffers_free_list(type).push(value_typed->data);
         }
         break;
       }
@@ -293,6 +303,18 @@ class ValueAllocator : NonCopyable, NonMovable {
   }
 
  private:
+  /** Get the free-list of span buffers that can be used for values of the given type. */
+  Stack<void *> &span_buffers_free_list(const CPPType &type)
+  {
+    if (type.alignment() > min_alignment) {
+      return aligned_span_buffers_free_lists_.lookup_or_add_default(&type);
+    }
+    if (type.can_exist_in_buffer(small_value_max_size, small_value_max_alignment)) {
+      return small_span_buffers_free_list_;
+    }
+    return span_buffers_free_lists_.lookup_or_add_default(type.size());
+  }
+
   template<typename T, typename... Args> T *obtain(Args &&...args)
   {
     static_assert(std::is_base_of_v<VariableValue, T>);
@@ -821,17 +843,15 @@ class VariableState : NonCopyable, NonMovable {
 /** Keeps track of the states of all variables during evaluation. */
 class VariableStates {
  private:
-  ValueAllocator value_allocator_;
+  ValueAllocator &value_allocator_;
   const Procedure &procedure_;
   /** The state of every variable, indexed by #Variable::index_in_procedure(). */
   Array<VariableState> variable_states_;
   IndexMask full_mask_;
 
  public:
-  VariableStates(LinearAllocator<> &linear_allocator,
-                 const Procedure &procedure,
-                 IndexMask full_mask)
-      : value_allocator_(linear_allocator),
+  VariableStates(ValueAllocator &value_allocator, const Procedure &procedure, IndexMask full_mask)
+      : value_allocator_(value_allocator),
         procedure_(procedure),
         variable_states_(procedure.variables().size()),
         full_mask_(full_mask)
@@ -1169,15 +1189,45 @@ class InstructionScheduler {
   }
 };
 
+struct ProcedureExecutor::Scratch {
+  LinearAllocator<> linear_allocator;
+  ValueAllocator value_allocator;
+
+  Scratch(const int64_t span_buffer_size) : value_allocator(linear_allocator, span_buffer_size)
+  {
+  }
+};
+
 void ProcedureExecutor::call(IndexMask full_mask, Params params, Context context) const
 {
   BLI_assert(procedure_.validate());
 
-  AlignedBuffer<512, 64> local_buffer;
-  LinearAllocator<> linear_allocator;
-  linear_allocator.provide_buffer(local_buffer);
+  const int64_t array_size = full_mask.min_array_size();
+  Stack<std::unique_ptr<Scratch>> &thread_scratches = scratch_by_thread_.local();
+  std::unique_ptr<Scratch> scratch;
+  if (!thread_scratches.is_empty()) {
+    scratch = thread_scratches.pop();
+    if (scratch->value_allocator.span_buffer_size() < array_size) {
+      /* The buffers are too small, free them. */
+      scratch.reset();
+    }
+  }
+  if (!scratch) {
+    scratch = std::make_unique<Scratch>(array_size);
+  }
 
-  VariableStates variable_states{linear_allocator, procedure_, full_mask};
+  this->call_with_scratch(full_mask, params, context, *scratch);
+
+  /* Variables have been destructed, so all buffers can be reused by the next call. */
+  thread_scratches.push(std::move(scratch));
+}
+
+void ProcedureExecutor::call_with_scratch(IndexMask full_mask,
+                                          Params params,
+                                          Context context,
+                                          Scratch &scratch) const
+{
+  VariableStates variable_states{scratch.value_allocator, procedure_, full_mask};
   variable_states.add_initial_variable_states(*this, procedure_, params);
 
   InstructionScheduler scheduler;
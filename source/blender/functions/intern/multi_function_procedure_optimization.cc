@@ -1,5 +1,11 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <algorithm>
+
+#include "BLI_set.hh"
+#include "BLI_vector_set.hh"
+
+#include "FN_multi_function_params.hh"
 #include "FN_multi_function_procedure_optimization.hh"
 
 namespace blender::fn::multi_function::procedure_optimization {
@@ -72,4 +78,495 @@ void move_destructs_up(Procedure &procedure, Instruction &block_end_instr)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Fuse Element-Wise Calls
+ * \{ */
+
+/**
+ * Number of indices that a fused function processes at once. Intermediate buffers of that size
+ * should easily fit into the CPU cache.
+ */
+static constexpr int64_t fused_tile_size = 1024;
+
+/**
+ * Evaluates a chain of element-wise multi-functions for a tile of indices at a time.
+ */
+class FusedElementWiseFunction : public MultiFunction {
+ public:
+  struct Step {
+    const MultiFunction *fn;
+    /** The slot of every parameter of the function, or -1 for ignored outputs. */
+    Vector<int> slots;
+  };
+
+ private:
+  Signature signature_;
+  /**
+   * Every value that is passed between steps has a slot. The inputs of the fused function come
+   * first, then its outputs and then the values that are only used within the fused function.
+   */
+  Vector<const CPPType *> slot_types_;
+  int inputs_num_;
+  int outputs_num_;
+  Vector<Step> steps_;
+
+ public:
+  FusedElementWiseFunction(const Span<const Variable *> input_variables,
+                           const Span<const Variable *> output_variables,
+                           Vector<const CPPType *> slot_types,
+                           Vector<Step> steps)
+      : slot_types_(std::move(slot_types)),
+        inputs_num_(input_variables.size()),
+        outputs_num_(output_variables.size()),
+        steps_(std::move(steps))
+  {
+    SignatureBuilder builder("Fused Element-Wise", signature_);
+    for (const Variable *variable : input_variables) {
+      builder.input(variable->name().c_str(), variable->data_type());
+    }
+    for (const Variable *variable : output_variables) {
+      builder.output(variable->name().c_str(), variable->data_type());
+    }
+    this->set_signature(&signature_);
+  }
+
+  void call(IndexMask mask, Params params, Context context) const override
+  {
+    LinearAllocator<> allocator;
+    Vector<GMutablePointer> values_to_destruct;
+
+    /* Values that are the same for every index are only computed once, like in
+     * #ProcedureExecutor. */
+    Array<const void *> single_values(slot_types_.size(), nullptr);
+    Array<GVArray> input_varrays(inputs_num_);
+    for (const int input_index : IndexRange(inputs_num_)) {
+      const GVArray &varray = params.readonly_single_input(input_index);
+      if (varray.is_single()) {
+        const CPPType &type = *slot_types_[input_index];
+        void *value = allocator.allocate(type.size(), type.alignment());
+        varray.get_internal_single_to_uninitialized(value);
+        values_to_destruct.append({type, value});
+        single_values[input_index] = value;
+      }
+      else {
+        input_varrays[input_index] = varray;
+      }
+    }
+
+    Array<GMutableSpan> output_spans(outputs_num_);
+    for (const int output_index : IndexRange(outputs_num_)) {
+      output_spans[output_index] = params.uninitialized_single_output(inputs_num_ +
+                                                                       output_index);
+    }
+
+    Array<bool> step_is_single(steps_.size());
+    for (const int step_index : steps_.index_range()) {
+      step_is_single[step_index] = this->try_execute_step_as_one(
+          steps_[step_index], single_values, allocator, values_to_destruct, context);
+    }
+
+    for (const int output_index : IndexRange(outputs_num_)) {
+      if (const void *value = single_values[inputs_num_ + output_index]) {
+        const GMutableSpan span = output_spans[output_index];
+        span.type().fill_construct_indices(value, span.data(), mask);
+      }
+    }
+
+    if (!step_is_single.as_span().contains(false)) {
+      for (GMutablePointer value : values_to_destruct) {
+        value.destruct();
+      }
+      return;
+    }
+
+    /* Buffers for the values that are only used within a tile. */
+    Array<void *> tile_buffers(slot_types_.size(), nullptr);
+    for (const int slot : slot_types_.index_range().drop_front(inputs_num_ + outputs_num_)) {
+      if (single_values[slot] == nullptr) {
+        const CPPType &type = *slot_types_[slot];
+        tile_buffers[slot] = allocator.allocate(type.size() * fused_tile_size, type.alignment());
+      }
+    }
+
+    const Span<int64_t> indices = mask.indices();
+    Vector<int64_t> offset_indices;
+    Array<GVArray> tile_input_varrays(inputs_num_);
+    int64_t tile_start = 0;
+    while (tile_start < mask.size()) {
+      /* Limit the range of indices in a tile, so that the tile buffers are large enough. */
+      const int64_t first_index = indices[tile_start];
+      const int64_t tile_end = std::lower_bound(indices.begin() + tile_start,
+                                                indices.end(),
+                                                first_index + fused_tile_size) -
+                               indices.begin();
+      const IndexRange array_range{first_index, indices[tile_end - 1] - first_index + 1};
+      const IndexMask tile_mask = mask.slice_and_offset(
+          IndexRange(tile_start, tile_end - tile_start), offset_indices);
+
+      for (const int input_index : IndexRange(inputs_num_)) {
+        if (single_values[input_index] == nullptr) {
+          tile_input_varrays[input_index] = input_varrays[input_index].slice(array_range);
+        }
+      }
+
+      for (const int step_index : steps_.index_range()) {
+        if (step_is_single[step_index]) {
+          continue;
+        }
+        const Step &step = steps_[step_index];
+        const MultiFunction &fn = *step.fn;
+        ParamsBuilder step_params{fn, &tile_mask};
+        for (const int param_index : fn.param_indices()) {
+          const int slot = step.slots[param_index];
+          if (slot == -1) {
+            step_params.add_ignored_single_output();
+            continue;
+          }
+          const CPPType &type = *slot_types_[slot];
+          const bool is_input = fn.param_type(param_index).interface_type() == ParamType::Input;
+          if (is_input && single_values[slot] != nullptr) {
+            step_params.add_readonly_single_input(GPointer(type, single_values[slot]));
+          }
+          else if (slot < inputs_num_) {
+            step_params.add_readonly_single_input(tile_input_varrays[slot]);
+          }
+          else if (slot < inputs_num_ + outputs_num_) {
+            const GMutableSpan span = output_spans[slot - inputs_num_].slice(array_range);
+            if (is_input) {
+              step_params.add_readonly_single_input(GSpan(span));
+            }
+            else {
+              step_params.add_uninitialized_single_output(span);
+            }
+          }
+          else {
+            const GMutableSpan span{type, tile_buffers[slot], array_range.size()};
+            if (is_input) {
+              step_params.add_readonly_single_input(GSpan(span));
+            }
+            else {
+              step_params.add_uninitialized_single_output(span);
+            }
+          }
+        }
+        fn.call(tile_mask, step_params, context);
+      }
+
+      for (const int slot : slot_types_.index_range().drop_front(inputs_num_ + outputs_num_)) {
+        if (tile_buffers[slot] != nullptr) {
+          slot_types_[slot]->destruct_indices(tile_buffers[slot], tile_mask);
+        }
+      }
+      tile_start = tile_end;
+    }
+
+    for (GMutablePointer value : values_to_destruct) {
+      value.destruct();
+    }
+  }
+
+  std::string debug_name() const override
+  {
+    std::string name = signature_.function_name;
+    for (const Step &step : steps_) {
+      name += ", " + step.fn->debug_name();
+    }
+    return name;
+  }
+
+ private:
+  /**
+   * Execute the step only once when all its inputs are the same for every index.
+   * \return True when the step has been executed.
+   */
+  bool try_execute_step_as_one(const Step &step,
+                               MutableSpan<const void *> single_values,
+                               LinearAllocator<> &allocator,
+                               Vector<GMutablePointer> &values_to_destruct,
+                               const Context &context) const
+  {
+    const MultiFunction &fn = *step.fn;
+    for (const int param_index : fn.param_indices()) {
+      if (fn.param_type(param_index).interface_type() == ParamType::Input) {
+        if (single_values[step.slots[param_index]] == nullptr) {
+          return false;
+        }
+      }
+    }
+    ParamsBuilder step_params{fn, 1};
+    for (const int param_index : fn.param_indices()) {
+      const int slot = step.slots[param_index];
+      if (slot == -1) {
+        step_params.add_ignored_single_output();
+        continue;
+      }
+      const CPPType &type = *slot_types_[slot];
+      if (fn.param_type(param_index).interface_type() == ParamType::Input) {
+        step_params.add_readonly_single_input(GPointer(type, single_values[slot]));
+      }
+      else {
+        void *value = allocator.allocate(type.size(), type.alignment());
+        step_params.add_uninitialized_single_output(GMutableSpan(type, value, 1));
+        values_to_destruct.append({type, value});
+        single_values[slot] = value;
+      }
+    }
+    fn.call(IndexRange(1), step_params, context);
+    return true;
+  }
+};
+
+static bool is_fusable_call(const CallInstruction &instr)
+{
+  const MultiFunction &fn = instr.fn();
+  if (!fn.execution_hints().is_element_wise) {
+    return false;
+  }
+  bool has_input = false;
+  bool has_output = false;
+  for (const int param_index : fn.param_indices()) {
+    switch (fn.param_type(param_index).category()) {
+      case ParamCategory::SingleInput:
+        has_input = true;
+        break;
+      case ParamCategory::SingleOutput:
+        has_output = true;
+        break;
+      default:
+        /* Mutable and vector parameters are not supported. */
+        return false;
+    }
+  }
+  /* Functions without inputs (e.g. constants) are not fused, because their outputs are computed
+   * only once anyway. */
+  return has_input && has_output;
+}
+
+static Instruction *get_next_instruction(Instruction &instr)
+{
+  switch (instr.type()) {
+    case InstructionType::Call:
+      return static_cast<CallInstruction &>(instr).next();
+    case InstructionType::Destruct:
+      return static_cast<DestructInstruction &>(instr).next();
+    case InstructionType::Dummy:
+      return static_cast<DummyInstruction &>(instr).next();
+    default:
+      return nullptr;
+  }
+}
+
+static void set_next_instruction(Instruction &instr, Instruction *next)
+{
+  switch (instr.type()) {
+    case InstructionType::Call:
+      static_cast<CallInstruction &>(instr).set_next(next);
+      break;
+    case InstructionType::Destruct:
+      static_cast<DestructInstruction &>(instr).set_next(next);
+      break;
+    default:
+      BLI_assert_unreachable();
+      break;
+  }
+}
+
+/**
+ * Replace a run of fusable call instructions (with destruct instructions in between) by a single
+ * call of a #FusedElementWiseFunction.
+ * \param run: Consecutive instructions, starting with a call instruction.
+ */
+static void fuse_run(Procedure &procedure, const Span<Instruction *> run)
+{
+  Vector<CallInstruction *> calls;
+  Vector<DestructInstruction *> destructs;
+  for (Instruction *instr : run) {
+    if (instr->type() == InstructionType::Call) {
+      calls.append(static_cast<CallInstruction *>(instr));
+    }
+    else {
+      destructs.append(static_cast<DestructInstruction *>(instr));
+    }
+  }
+
+  VectorSet<Variable *> input_variables;
+  VectorSet<Variable *> produced_variables;
+  for (CallInstruction *call : calls) {
+    const MultiFunction &fn = call->fn();
+    for (const int param_index : fn.param_indices()) {
+      Variable *variable = call->params()[param_index];
+      if (variable == nullptr) {
+        continue;
+      }
+      if (fn.param_type(param_index).interface_type() == ParamType::Input) {
+        if (!produced_variables.contains(variable)) {
+          input_variables.add(variable);
+        }
+      }
+      else if (input_variables.contains(variable) || !produced_variables.add(variable)) {
+        /* The variable is initialized more than once, which is not supported here. */
+        return;
+      }
+    }
+  }
+
+  Set<const Variable *> procedure_variables;
+  for (const ConstParameter &param : procedure.params()) {
+    procedure_variables.add(param.variable);
+  }
+  Set<const Instruction *> run_set;
+  for (const Instruction *instr : run) {
+    run_set.add(instr);
+  }
+
+  VectorSet<Variable *> output_variables;
+  Vector<Variable *> internal_variables;
+  for (Variable *variable : produced_variables) {
+    bool is_used_outside = procedure_variables.contains(variable);
+    for (const Instruction *user : variable->users()) {
+      if (!run_set.contains(user)) {
+        is_used_outside = true;
+      }
+    }
+    if (is_used_outside) {
+      output_variables.add(variable);
+    }
+    else {
+      internal_variables.append(variable);
+    }
+  }
+  if (output_variables.is_empty()) {
+    return;
+  }
+
+  /* Assign a slot to every variable. */
+  Map<const Variable *, int> slot_by_variable;
+  Vector<const CPPType *> slot_types;
+  auto add_slot = [&](const Variable *variable) {
+    slot_by_variable.add_new(variable, slot_types.size());
+    slot_types.append(&variable->data_type().single_type());
+  };
+  for (const Variable *variable : input_variables) {
+    add_slot(variable);
+  }
+  for (const Variable *variable : output_variables) {
+    add_slot(variable);
+  }
+  for (const Variable *variable : internal_variables) {
+    add_slot(variable);
+  }
+
+  Vector<FusedElementWiseFunction::Step> steps;
+  for (const CallInstruction *call : calls) {
+    FusedElementWiseFunction::Step step;
+    step.fn = &call->fn();
+    for (const Variable *variable : call->params()) {
+      step.slots.append(variable ? slot_by_variable.lookup(variable) : -1);
+    }
+    steps.append(std::move(step));
+  }
+
+  Vector<const Variable *> fused_inputs(input_variables.as_span());
+  Vector<const Variable *> fused_outputs(output_variables.as_span());
+  const MultiFunction &fused_fn = procedure.construct_function<FusedElementWiseFunction>(
+      fused_inputs.as_span(), fused_outputs.as_span(), std::move(slot_types), std::move(steps));
+
+  CallInstruction &fused_instr = procedure.new_call_instruction(fused_fn);
+  Vector<Variable *> fused_params;
+  fused_params.extend(input_variables.as_span());
+  fused_params.extend(output_variables.as_span());
+  fused_instr.set_params(fused_params);
+
+  /* Unlink the run from the rest of the procedure. */
+  Instruction *after_run_instr = get_next_instruction(*run.last());
+  while (!run.first()->prev().is_empty()) {
+    /* Do a copy of the cursor here, because `run.first()->prev()` changes when #set_next is
+     * called below. */
+    const InstructionCursor cursor = run.first()->prev()[0];
+    cursor.set_next(procedure, &fused_instr);
+  }
+  for (Instruction *instr : run) {
+    set_next_instruction(*instr, nullptr);
+  }
+
+  /* Destruct instructions for variables that are not internal are kept after the fused call. */
+  Instruction *last_instr = &fused_instr;
+  for (DestructInstruction *destruct_instr : destructs) {
+    if (produced_variables.contains(destruct_instr->variable()) &&
+        !output_variables.contains(destruct_instr->variable())) {
+      procedure.remove_instruction(*destruct_instr);
+      continue;
+    }
+    set_next_instruction(*last_instr, destruct_instr);
+    last_instr = destruct_instr;
+  }
+  set_next_instruction(*last_instr, after_run_instr);
+
+  for (CallInstruction *call : calls) {
+    procedure.remove_instruction(*call);
+  }
+}
+
+void fuse_element_wise_calls(Procedure &procedure, Instruction &block_end_instr)
+{
+  /* Find the linear chain of instructions that ends at the given instruction. */
+  Vector<Instruction *> chain;
+  Instruction *current_instr = &block_end_instr;
+  while (current_instr != nullptr) {
+    chain.append(current_instr);
+    const Span<InstructionCursor> prev_cursors = current_instr->prev();
+    if (prev_cursors.size() != 1) {
+      break;
+    }
+    current_instr = prev_cursors[0].instruction();
+  }
+  std::reverse(chain.begin(), chain.end());
+
+  /* Find runs of fusable calls. Destruct instructions in between calls don't end a run. */
+  Vector<Vector<Instruction *>> runs;
+  Vector<Instruction *> current_run;
+  int current_run_calls_num = 0;
+  auto finish_run = [&]() {
+    if (current_run_calls_num >= 2) {
+      runs.append(std::move(current_run));
+    }
+    current_run.clear();
+    current_run_calls_num = 0;
+  };
+  for (Instruction *instr : chain) {
+    if (instr == &block_end_instr) {
+      break;
+    }
+    switch (instr->type()) {
+      case InstructionType::Call: {
+        if (is_fusable_call(*static_cast<CallInstruction *>(instr))) {
+          current_run.append(instr);
+          current_run_calls_num++;
+        }
+        else {
+          finish_run();
+        }
+        break;
+      }
+      case InstructionType::Destruct: {
+        if (!current_run.is_empty()) {
+          current_run.append(instr);
+        }
+        break;
+      }
+      default: {
+        finish_run();
+        break;
+      }
+    }
+  }
+  finish_run();
+
+  for (const Span<Instruction *> run : runs) {
+    fuse_run(procedure, run);
+  }
+}
+
+/** \} */
+
 }  // namespace blender::fn::multi_function::procedure_optimization
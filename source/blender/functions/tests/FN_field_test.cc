@@ -149,6 +149,38 @@ TEST(field, TwoFunctions)
   EXPECT_EQ(result[8], 26);
 }
 
+TEST(field, LargeMaskInChunks)
+{
+  GField index_field{std::make_shared<IndexFieldInput>()};
+
+  auto add_fn = mf::build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+  GField add_field{
+      std::make_shared<FieldOperation>(FieldOperation(add_fn, {index_field, index_field})), 0};
+
+  auto add_10_fn = mf::build::SI1_SO<int, int>("add_10", [](int a) { return a + 10; });
+  GField result_field{std::make_shared<FieldOperation>(FieldOperation(add_10_fn, {add_field})), 0};
+
+  /* Use a mask that is evaluated in multiple chunks, with gaps between indices. */
+  const int size = 100000;
+  Vector<int64_t> indices;
+  for (const int i : IndexRange(size)) {
+    if (i % 3 != 0) {
+      indices.append(i);
+    }
+  }
+  const IndexMask mask{indices.as_span()};
+
+  Array<int> result(size, -1);
+
+  FieldContext context;
+  FieldEvaluator evaluator{context, &mask};
+  evaluator.add_with_destination(result_field, result.as_mutable_span());
+  evaluator.evaluate();
+  for (const int i : IndexRange(size)) {
+    EXPECT_EQ(result[i], i % 3 == 0 ? -1 : i * 2 + 10);
+  }
+}
+
 class TwoOutputFunction : public mf::MultiFunction {
  private:
   mf::Signature signature_;
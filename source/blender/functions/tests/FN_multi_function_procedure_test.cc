@@ -5,6 +5,7 @@
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_procedure_builder.hh"
 #include "FN_multi_function_procedure_executor.hh"
+#include "FN_multi_function_procedure_optimization.hh"
 #include "FN_multi_function_test_common.hh"
 
 namespace blender::fn::multi_function::tests {
@@ -408,4 +409,89 @@ TEST(multi_function_procedure, OutputBufferReplaced)
   EXPECT_EQ(output[2], output_value);
 }
 
+TEST(multi_function_procedure, FuseElementWiseCalls)
+{
+  /**
+   * procedure(int var1, int var2, int *var6, int *var7) {
+   *   int var3 = var1 + var2;
+   *   int var4 = var3 * var3;
+   *   int var5 = var2 * var2;
+   *   var6 = var4 + var5;
+   *   var7 = var6 + var1;
+   *   var7 += 10;
+   * }
+   */
+
+  auto add_fn = build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+  auto mul_fn = build::SI2_SO<int, int, int>("mul", [](int a, int b) { return a * b; });
+  auto add_10_fn = build::SM<int>("add_10", [](int &a) { a += 10; });
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var1 = &builder.add_single_input_parameter<int>();
+  Variable *var2 = &builder.add_single_input_parameter<int>();
+  auto [var3] = builder.add_call<1>(add_fn, {var1, var2});
+  auto [var4] = builder.add_call<1>(mul_fn, {var3, var3});
+  auto [var5] = builder.add_call<1>(mul_fn, {var2, var2});
+  auto [var6] = builder.add_call<1>(add_fn, {var4, var5});
+  auto [var7] = builder.add_call<1>(add_fn, {var6, var1});
+  builder.add_call(add_10_fn, {var7});
+  builder.add_destruct({var1, var2, var3, var4, var5});
+  ReturnInstruction &return_instr = builder.add_return();
+  builder.add_output_parameter(*var6);
+  builder.add_output_parameter(*var7);
+
+  procedure_optimization::move_destructs_up(procedure, return_instr);
+  procedure_optimization::fuse_element_wise_calls(procedure, return_instr);
+  EXPECT_TRUE(procedure.validate());
+
+  /* The five element-wise calls are fused into one, the mutable call is kept. */
+  const Instruction *entry = procedure.entry();
+  ASSERT_EQ(entry->type(), InstructionType::Call);
+  const CallInstruction &fused_instr = *static_cast<const CallInstruction *>(entry);
+  EXPECT_EQ(fused_instr.fn().param_amount(), 4);
+  EXPECT_EQ(var3->users().size(), 0);
+  EXPECT_EQ(var4->users().size(), 0);
+  EXPECT_EQ(var5->users().size(), 0);
+
+  ProcedureExecutor executor{procedure};
+
+  /* Use enough indices to get multiple tiles and skip some of them. */
+  const int size = 5000;
+  Array<int> input_array(size);
+  Vector<int64_t> mask_indices;
+  for (const int i : IndexRange(size)) {
+    input_array[i] = i;
+    if (i % 7 != 0) {
+      mask_indices.append(i);
+    }
+  }
+  const IndexMask mask{mask_indices.as_span()};
+
+  ParamsBuilder params{executor, &mask};
+  ContextBuilder context;
+
+  params.add_readonly_single_input(input_array.as_span());
+  params.add_readonly_single_input_value(3);
+
+  Array<int> output_array_1(size, -1);
+  Array<int> output_array_2(size, -1);
+  params.add_uninitialized_single_output(output_array_1.as_mutable_span());
+  params.add_uninitialized_single_output(output_array_2.as_mutable_span());
+
+  executor.call(mask, params, context);
+
+  for (const int i : IndexRange(size)) {
+    if (i % 7 == 0) {
+      EXPECT_EQ(output_array_1[i], -1);
+      EXPECT_EQ(output_array_2[i], -1);
+    }
+    else {
+      EXPECT_EQ(output_array_1[i], (i + 3) * (i + 3) + 9);
+      EXPECT_EQ(output_array_2[i], (i + 3) * (i + 3) + 9 + i + 10);
+    }
+  }
+}
+
 }  // namespace blender::fn::multi_function::tests
@@ -0,0 +1,158 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_pointcloud_types.h"
+
+#include "BKE_anonymous_attribute_id.hh"
+#include "BKE_attribute.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.h"
+#include "BKE_instances.hh"
+#include "BKE_pointcloud.h"
+
+#include "GEO_realize_instances.hh"
+
+namespace blender::geometry::tests {
+
+using bke::AnonymousAttributeID;
+using bke::AutoAnonymousAttributeID;
+
+class realize_instances_test : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+class TestAnonymousAttributeID : public AnonymousAttributeID {
+ public:
+  TestAnonymousAttributeID(std::string name)
+  {
+    name_ = std::move(name);
+  }
+};
+
+static AutoAnonymousAttributeID create_anonymous_id(std::string name)
+{
+  return AutoAnonymousAttributeID(MEM_new<TestAnonymousAttributeID>(__func__, std::move(name)));
+}
+
+/** A point cloud with three points, a float attribute and the given anonymous attributes. */
+static PointCloud *create_pointcloud(const Span<const AnonymousAttributeID *> anonymous_ids)
+{
+  PointCloud *pointcloud = BKE_pointcloud_new_nomain(3);
+  bke::MutableAttributeAccessor attributes = pointcloud->attributes_for_write();
+  bke::SpanAttributeWriter<float3> positions = attributes.lookup_for_write_span<float3>(
+      "position");
+  positions.span.copy_from({float3(0, 0, 0), float3(1, 0, 0), float3(2, 0, 0)});
+  positions.finish();
+
+  bke::SpanAttributeWriter<float> weights =
+      attributes.lookup_or_add_for_write_only_span<float>("weight", ATTR_DOMAIN_POINT);
+  weights.span.copy_from({0.5f, 0.25f, 1.0f});
+  weights.finish();
+
+  for (const AnonymousAttributeID *anonymous_id : anonymous_ids) {
+    bke::SpanAttributeWriter<int> values =
+        attributes.lookup_or_add_for_write_only_span<int>(*anonymous_id, ATTR_DOMAIN_POINT);
+    values.span.fill(7);
+    values.finish();
+  }
+  return pointcloud;
+}
+
+/** Two instances of the point cloud with an integer instance attribute. */
+static GeometrySet create_instances(PointCloud *pointcloud)
+{
+  bke::Instances *instances = new bke::Instances();
+  const int handle = instances->add_reference(
+      bke::InstanceReference(GeometrySet::create_with_pointcloud(pointcloud)));
+  instances->add_instance(handle, float4x4::identity());
+  instances->add_instance(handle, float4x4::from_location(float3(0, 10, 0)));
+
+  bke::SpanAttributeWriter<int> values =
+      instances->attributes_for_write().lookup_or_add_for_write_only_span<int>(
+          "instance_value", ATTR_DOMAIN_INSTANCE);
+  values.span.copy_from({3, 4});
+  values.finish();
+  return GeometrySet::create_with_instances(instances);
+}
+
+TEST_F(realize_instances_test, pointcloud_attributes)
+{
+  const GeometrySet geometry = create_instances(create_pointcloud({}));
+  const GeometrySet result = realize_instances(geometry, {});
+
+  EXPECT_FALSE(result.has_instances());
+  const PointCloud *pointcloud = result.get_pointcloud_for_read();
+  ASSERT_NE(pointcloud, nullptr);
+  ASSERT_EQ(pointcloud->totpoint, 6);
+  const bke::AttributeAccessor attributes = pointcloud->attributes();
+
+  const VArraySpan<float3> positions = attributes.lookup<float3>("position");
+  EXPECT_EQ(positions[1], float3(1, 0, 0));
+  EXPECT_EQ(positions[5], float3(2, 10, 0));
+
+  const VArraySpan<float> weights = attributes.lookup<float>("weight");
+  ASSERT_FALSE(weights.is_empty());
+  for (const int i : IndexRange(2)) {
+    EXPECT_EQ(weights[i * 3 + 0], 0.5f);
+    EXPECT_EQ(weights[i * 3 + 1], 0.25f);
+    EXPECT_EQ(weights[i * 3 + 2], 1.0f);
+  }
+
+  /* Instance attributes are propagated to the points of every instance. */
+  const VArraySpan<int> instance_values = attributes.lookup<int>("instance_value");
+  ASSERT_FALSE(instance_values.is_empty());
+  EXPECT_EQ(attributes.lookup_meta_data("instance_value")->domain, ATTR_DOMAIN_POINT);
+  EXPECT_EQ(instance_values[0], 3);
+  EXPECT_EQ(instance_values[2], 3);
+  EXPECT_EQ(instance_values[3], 4);
+  EXPECT_EQ(instance_values[5], 4);
+}
+
+TEST_F(realize_instances_test, skip_unused_anonymous_attributes)
+{
+  const AutoAnonymousAttributeID used_id = create_anonymous_id("used");
+  const AutoAnonymousAttributeID unused_id = create_anonymous_id("unused");
+  const GeometrySet geometry = create_instances(
+      create_pointcloud({used_id.get(), unused_id.get()}));
+
+  RealizeInstancesOptions options;
+  options.propagation_info.propagate_all = false;
+  options.propagation_info.names = std::make_shared<Set<std::string>>();
+  options.propagation_info.names->add(used_id->name());
+  const GeometrySet result = realize_instances(geometry, options);
+
+  const PointCloud *pointcloud = result.get_pointcloud_for_read();
+  ASSERT_NE(pointcloud, nullptr);
+  const bke::AttributeAccessor attributes = pointcloud->attributes();
+  /* Only attributes that are used later on are allocated and copied. */
+  EXPECT_FALSE(attributes.contains(*unused_id));
+  const VArraySpan<int> values = attributes.lookup<int>(*used_id);
+  ASSERT_EQ(values.size(), 6);
+  for (const int value : values) {
+    EXPECT_EQ(value, 7);
+  }
+  /* Named attributes are always propagated. */
+  EXPECT_TRUE(attributes.contains("weight"));
+  EXPECT_TRUE(attributes.contains("instance_value"));
+}
+
+TEST_F(realize_instances_test, ignore_instance_attributes)
+{
+  const GeometrySet geometry = create_instances(create_pointcloud({}));
+  RealizeInstancesOptions options;
+  options.realize_instance_attributes = false;
+  const GeometrySet result = realize_instances(geometry, options);
+
+  const bke::AttributeAccessor attributes = result.get_pointcloud_for_read()->attributes();
+  EXPECT_TRUE(attributes.contains("weight"));
+  EXPECT_FALSE(attributes.contains("instance_value"));
+}
+
+}  // namespace blender::geometry::tests
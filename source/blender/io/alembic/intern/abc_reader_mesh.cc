@@ -24,6 +24,8 @@
 #include "BLI_index_range.hh"
 #include "BLI_listbase.h"
 #include "BLI_math_geom.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
 
 #include "BKE_attribute.hh"
 #include "BKE_lib_id.h"
@@ -469,11 +471,10 @@ static void read_velocity(const V3fArraySamplePtr &velocities,
 static void read_mesh_sample(const std::string &iobject_full_name,
                              ImportSettings *settings,
                              const IPolyMeshSchema &schema,
+                             const IPolyMeshSchema::Sample &sample,
                              const ISampleSelector &selector,
                              CDStreamConfig &config)
 {
-  const IPolyMeshSchema::Sample sample = schema.getValue(selector);
-
   AbcMeshData abc_mesh_data;
   abc_mesh_data.face_counts = sample.getFaceCounts();
   abc_mesh_data.face_indices = sample.getFaceIndices();
@@ -533,7 +534,8 @@ CDStreamConfig get_config(Mesh *mesh, const bool use_vertex_interpolation)
 /* ************************************************************************** */
 
 AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
-    : AbcObjectReader(object, settings)
+    : AbcObjectReader(object, settings),
+      m_prefetch_pool(nullptr)
 {
   m_settings->read_flag |= MOD_MESHSEQ_READ_ALL;
 
@@ -543,6 +545,15 @@ AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
   get_min_max_time(m_iobject, m_schema, m_min_time, m_max_time);
 }
 
+AbcMeshReader::~AbcMeshReader()
+{
+  if (m_prefetch_pool) {
+    /* A prefetch may still be reading from the archive. */
+    BLI_task_pool_cancel(m_prefetch_pool);
+    BLI_task_pool_free(m_prefetch_pool);
+  }
+}
+
 bool AbcMeshReader::valid() const
 {
   return m_schema.valid();
@@ -606,6 +617,88 @@ template<> bool has_animations(Alembic::AbcGeom::IPolyMeshSchema &schema, Import
   return false;
 }
 
+/**
+ * Read the sample into a new mesh that is not in #Main, so that this can be done for many
+ * objects in parallel.
+ */
+static Mesh *read_mesh_nomain(AbcObjectReader &reader, const ISampleSelector &sample_sel)
+{
+  Mesh *template_mesh = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+  Mesh *mesh = reader.read_mesh(
+      template_mesh, sample_sel, MOD_MESHSEQ_READ_ALL, "", 0.0f, nullptr);
+  if (mesh != template_mesh) {
+    BKE_id_free(nullptr, template_mesh);
+  }
+  return mesh;
+}
+
+void AbcMeshReader::prefetchObjectData(const ISampleSelector &sample_sel)
+{
+  m_prefetched_mesh = read_mesh_nomain(*this, sample_sel);
+}
+
+void AbcMeshReader::prefetch_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  AbcMeshReader *reader = static_cast<AbcMeshReader *>(BLI_task_pool_user_data(pool));
+  const Alembic::AbcGeom::index_t index = *static_cast<Alembic::AbcGeom::index_t *>(taskdata);
+
+  IPolyMeshSchema::Sample sample;
+  try {
+    sample = reader->m_schema.getValue(ISampleSelector(index));
+  }
+  catch (Alembic::Util::Exception & /*ex*/) {
+    /* The error is reported when the sample is needed for a frame. The prefetch is tried again
+     * for the next frame, the failure may have been temporary (e.g. a file on a network drive
+     * that was not available for a moment). */
+    reader->m_prefetch.fail(index);
+    return;
+  }
+  reader->m_prefetch.finish(index, sample);
+}
+
+void AbcMeshReader::prefetch_next_sample(const ISampleSelector &sample_sel)
+{
+#ifdef WITH_TBB
+  if (m_schema.isConstant()) {
+    return;
+  }
+  const Alembic::AbcGeom::index_t samples_num = m_schema.getNumSamples();
+  const Alembic::AbcGeom::index_t next_index =
+      sample_sel.getIndex(m_schema.getTimeSampling(), samples_num) + 1;
+  if (next_index >= samples_num) {
+    return;
+  }
+
+  if (!m_prefetch.request(next_index)) {
+    return;
+  }
+  {
+    std::lock_guard lock(m_prefetch_pool_mutex);
+    if (m_prefetch_pool == nullptr) {
+      m_prefetch_pool = BLI_task_pool_create(this, TASK_PRIORITY_LOW);
+    }
+  }
+
+  /* Pushed without holding the lock, since the task may run immediately. */
+  Alembic::AbcGeom::index_t *task_index = static_cast<Alembic::AbcGeom::index_t *>(
+      MEM_mallocN(sizeof(Alembic::AbcGeom::index_t), __func__));
+  *task_index = next_index;
+  BLI_task_pool_push(m_prefetch_pool, prefetch_task_run, task_index, true, nullptr);
+#else
+  UNUSED_VARS(sample_sel);
+#endif
+}
+
+IPolyMeshSchema::Sample AbcMeshReader::get_sample(const ISampleSelector &sample_sel)
+{
+  IPolyMeshSchema::Sample sample;
+  if (m_prefetch.get(sample_sel.getIndex(m_schema.getTimeSampling(), m_schema.getNumSamples()),
+                     sample)) {
+    return sample;
+  }
+  return m_schema.getValue(sample_sel);
+}
+
 void AbcMeshReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel)
 {
   Mesh *mesh = BKE_mesh_add(bmain, m_data_name.c_str());
@@ -613,7 +706,10 @@ void AbcMeshReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSelec
   m_object = BKE_object_add_only_object(bmain, OB_MESH, m_object_name.c_str());
   m_object->data = mesh;
 
-  Mesh *read_mesh = this->read_mesh(mesh, sample_sel, MOD_MESHSEQ_READ_ALL, "", 0.0f, nullptr);
+  Mesh *read_mesh = m_prefetched_mesh ?
+                        m_prefetched_mesh :
+                        this->read_mesh(mesh, sample_sel, MOD_MESHSEQ_READ_ALL, "", 0.0f, nullptr);
+  m_prefetched_mesh = nullptr;
   if (read_mesh != mesh) {
     BKE_mesh_nomain_to_mesh(read_mesh, mesh, m_object);
   }
@@ -653,7 +749,7 @@ bool AbcMeshReader::topology_changed(const Mesh *existing_mesh, const ISampleSel
 {
   IPolyMeshSchema::Sample sample;
   try {
-    sample = m_schema.getValue(sample_sel);
+    sample = get_sample(sample_sel);
   }
   catch (Alembic::Util::Exception &ex) {
     printf("Alembic: error reading mesh sample for '%s/%s' at time %f: %s\n",
@@ -683,7 +779,7 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
 {
   IPolyMeshSchema::Sample sample;
   try {
-    sample = m_schema.getValue(sample_sel);
+    sample = get_sample(sample_sel);
   }
   catch (Alembic::Util::Exception &ex) {
     if (err_str != nullptr) {
@@ -752,7 +848,7 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
   config.time = sample_sel.getRequestedTime();
   config.modifier_error_message = err_str;
 
-  read_mesh_sample(m_iobject.getFullName(), &settings, m_schema, sample_sel, config);
+  read_mesh_sample(m_iobject.getFullName(), &settings, m_schema, sample, sample_sel, config);
 
   if (new_mesh) {
     /* Here we assume that the number of materials doesn't change, i.e. that
@@ -985,6 +1081,11 @@ bool AbcSubDReader::accepts_object_type(
   return true;
 }
 
+void AbcSubDReader::prefetchObjectData(const ISampleSelector &sample_sel)
+{
+  m_prefetched_mesh = read_mesh_nomain(*this, sample_sel);
+}
+
 void AbcSubDReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel)
 {
   Mesh *mesh = BKE_mesh_add(bmain, m_data_name.c_str());
@@ -992,7 +1093,10 @@ void AbcSubDReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSelec
   m_object = BKE_object_add_only_object(bmain, OB_MESH, m_object_name.c_str());
   m_object->data = mesh;
 
-  Mesh *read_mesh = this->read_mesh(mesh, sample_sel, MOD_MESHSEQ_READ_ALL, "", 0.0f, nullptr);
+  Mesh *read_mesh = m_prefetched_mesh ?
+                        m_prefetched_mesh :
+                        this->read_mesh(mesh, sample_sel, MOD_MESHSEQ_READ_ALL, "", 0.0f, nullptr);
+  m_prefetched_mesh = nullptr;
   if (read_mesh != mesh) {
     BKE_mesh_nomain_to_mesh(read_mesh, mesh, m_object);
   }
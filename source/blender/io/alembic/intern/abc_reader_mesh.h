@@ -5,26 +5,38 @@
  * \ingroup balembic
  */
 
+#include <mutex>
+
 #include "BLI_span.hh"
 
 #include "abc_customdata.h"
 #include "abc_reader_object.h"
+#include "abc_sample_prefetch.h"
 
 struct Mesh;
+struct TaskPool;
 
 namespace blender::io::alembic {
 
 class AbcMeshReader final : public AbcObjectReader {
   Alembic::AbcGeom::IPolyMeshSchema m_schema;
 
+  /* Sample of the next frame that is read in the background during playback. */
+  SamplePrefetch<Alembic::AbcGeom::IPolyMeshSchema::Sample> m_prefetch;
+  std::mutex m_prefetch_pool_mutex;
+  TaskPool *m_prefetch_pool;
+
  public:
   AbcMeshReader(const Alembic::Abc::IObject &object, ImportSettings &settings);
+  ~AbcMeshReader() override;
 
   bool valid() const override;
   bool accepts_object_type(const Alembic::AbcCoreAbstract::ObjectHeader &alembic_header,
                            const Object *const ob,
                            const char **err_str) const override;
   void readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel) override;
+  void prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel) override;
+  void prefetch_next_sample(const Alembic::Abc::ISampleSelector &sample_sel) override;
 
   struct Mesh *read_mesh(struct Mesh *existing_mesh,
                          const Alembic::Abc::ISampleSelector &sample_sel,
@@ -36,6 +48,11 @@ class AbcMeshReader final : public AbcObjectReader {
                         const Alembic::Abc::ISampleSelector &sample_sel) override;
 
  private:
+  static void prefetch_task_run(TaskPool *__restrict pool, void *taskdata);
+  /** Get the sample from the background prefetch if it is available, or read it otherwise. */
+  Alembic::AbcGeom::IPolyMeshSchema::Sample get_sample(
+      const Alembic::Abc::ISampleSelector &sample_sel);
+
   void readFaceSetsSample(Main *bmain,
                           Mesh *mesh,
                           const Alembic::AbcGeom::ISampleSelector &sample_sel);
@@ -56,6 +73,7 @@ class AbcSubDReader final : public AbcObjectReader {
                            const Object *const ob,
                            const char **err_str) const override;
   void readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel) override;
+  void prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel) override;
   struct Mesh *read_mesh(struct Mesh *existing_mesh,
                          const Alembic::Abc::ISampleSelector &sample_sel,
                          int read_flag,
@@ -36,6 +36,7 @@ AbcObjectReader::AbcObjectReader(const IObject &object, ImportSettings &settings
       m_min_time(std::numeric_limits<chrono_t>::max()),
       m_max_time(std::numeric_limits<chrono_t>::min()),
       m_refcount(0),
+      m_prefetched_mesh(nullptr),
       parent_reader(nullptr)
 {
   m_name = object.getFullName();
@@ -53,6 +54,21 @@ AbcObjectReader::AbcObjectReader(const IObject &object, ImportSettings &settings
   determine_inherits_xform();
 }
 
+AbcObjectReader::~AbcObjectReader()
+{
+  if (m_prefetched_mesh) {
+    BKE_id_free(nullptr, m_prefetched_mesh);
+  }
+}
+
+void AbcObjectReader::prefetchObjectData(const Alembic::Abc::ISampleSelector & /*sample_sel*/)
+{
+}
+
+void AbcObjectReader::prefetch_next_sample(const Alembic::Abc::ISampleSelector & /*sample_sel*/)
+{
+}
+
 void AbcObjectReader::determine_inherits_xform()
 {
   m_inherits_xform = false;
@@ -88,13 +88,16 @@ class AbcObjectReader {
 
   bool m_inherits_xform;
 
+  /** Geometry read by #prefetchObjectData, owned by the reader until it is used. */
+  Mesh *m_prefetched_mesh;
+
  public:
   AbcObjectReader *parent_reader;
 
  public:
   explicit AbcObjectReader(const Alembic::Abc::IObject &object, ImportSettings &settings);
 
-  virtual ~AbcObjectReader() = default;
+  virtual ~AbcObjectReader();
 
   const Alembic::Abc::IObject &iobject() const;
 
@@ -133,6 +136,19 @@ class AbcObjectReader {
 
   virtual void readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel) = 0;
 
+  /**
+   * Read the geometry of the object into memory owned by the reader, without creating any data
+   * in #Main. This is called for many readers in parallel before #readObjectData, which then
+   * only has to move the geometry into the new data-block. Does nothing by default.
+   */
+  virtual void prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel);
+
+  /**
+   * Start reading the sample that follows the given one in the background, so that it is ready
+   * when playback reaches the next frame. Does nothing by default.
+   */
+  virtual void prefetch_next_sample(const Alembic::Abc::ISampleSelector &sample_sel);
+
   virtual struct Mesh *read_mesh(struct Mesh *mesh,
                                  const Alembic::Abc::ISampleSelector &sample_sel,
                                  int read_flag,
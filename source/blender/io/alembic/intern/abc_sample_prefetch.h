@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+#pragma once
+
+/** \file
+ * \ingroup balembic
+ */
+
+#include <cstdint>
+#include <mutex>
+
+namespace blender::io::alembic {
+
+/**
+ * Bookkeeping for a sample that is read in the background, before it is needed for a frame.
+ * At most one sample is requested or available at a time. All functions are thread-safe.
+ */
+template<typename Sample> class SamplePrefetch {
+  std::mutex m_mutex;
+  /* Index of the sample that is being read, or -1. */
+  int64_t m_requested_index = -1;
+  /* Index of #m_sample, or -1 when no sample was read yet. */
+  int64_t m_index = -1;
+  Sample m_sample;
+
+ public:
+  /**
+   * \return True when the sample with the index is neither available nor being read,
+   * so the caller has to start reading it.
+   */
+  bool request(const int64_t index)
+  {
+    std::lock_guard lock(m_mutex);
+    if (index == m_requested_index || index == m_index) {
+      return false;
+    }
+    m_requested_index = index;
+    return true;
+  }
+
+  /** Store the sample that was read for a request. */
+  void finish(const int64_t index, const Sample &sample)
+  {
+    std::lock_guard lock(m_mutex);
+    m_index = index;
+    m_sample = sample;
+    if (m_requested_index == index) {
+      m_requested_index = -1;
+    }
+  }
+
+  /**
+   * Reading the sample failed. The request is forgotten, so that the sample is requested again
+   * for a later frame, instead of the failure being remembered for the rest of the session.
+   */
+  void fail(const int64_t index)
+  {
+    std::lock_guard lock(m_mutex);
+    if (m_requested_index == index) {
+      m_requested_index = -1;
+    }
+  }
+
+  /** \return True and the sample when the sample with the index was read already. */
+  bool get(const int64_t index, Sample &r_sample)
+  {
+    std::lock_guard lock(m_mutex);
+    if (m_index == -1 || m_index != index) {
+      return false;
+    }
+    r_sample = m_sample;
+    return true;
+  }
+};
+
+}  // namespace blender::io::alembic
@@ -50,6 +50,7 @@
 #include "BLI_math.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 #include "BLI_timeit.hh"
 
 #include "WM_api.h"
@@ -512,6 +513,25 @@ static void import_startjob(void *user_data, bool *stop, bool *do_update, float
   chrono_t max_time = std::numeric_limits<chrono_t>::min();
 
   ISampleSelector sample_sel(0.0);
+
+  /* Reading and decoding the samples of different objects is independent, and the archive
+   * has a stream per thread, so do that in parallel first. Creating the Blender data
+   * afterwards has to happen one object at a time. */
+  blender::threading::parallel_for(
+      blender::IndexRange(data->readers.size()), 1, [&](const blender::IndexRange range) {
+        for (const int64_t i : range) {
+          AbcObjectReader *reader = data->readers[i];
+          if (reader->valid() && !G.is_break) {
+            reader->prefetchObjectData(sample_sel);
+          }
+        }
+      });
+
+  if (G.is_break) {
+    data->was_cancelled = true;
+    return;
+  }
+
   std::vector<AbcObjectReader *>::iterator iter;
   for (iter = data->readers.begin(); iter != data->readers.end(); ++iter) {
     AbcObjectReader *reader = *iter;
@@ -803,12 +823,15 @@ Mesh *ABC_read_mesh(CacheReader *reader,
   }
 
   ISampleSelector sample_sel = sample_selector_for_time(params->time);
-  return abc_reader->read_mesh(existing_mesh,
-                               sample_sel,
-                               params->read_flags,
-                               params->velocity_name,
-                               params->velocity_scale,
-                               err_str);
+  Mesh *mesh = abc_reader->read_mesh(existing_mesh,
+                                     sample_sel,
+                                     params->read_flags,
+                                     params->velocity_name,
+                                     params->velocity_scale,
+                                     err_str);
+  /* Read the next frame in the background while this one is drawn. */
+  abc_reader->prefetch_next_sample(sample_sel);
+  return mesh;
 }
 
 bool ABC_mesh_topology_changed(CacheReader *reader,
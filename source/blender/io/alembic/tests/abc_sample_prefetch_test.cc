@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "intern/abc_sample_prefetch.h"
+
+namespace blender::io::alembic {
+
+TEST(abc_sample_prefetch, request_once)
+{
+  SamplePrefetch<int> prefetch;
+  EXPECT_TRUE(prefetch.request(1));
+  /* Already being read. */
+  EXPECT_FALSE(prefetch.request(1));
+
+  int sample = 0;
+  EXPECT_FALSE(prefetch.get(1, sample));
+  prefetch.finish(1, 10);
+  EXPECT_TRUE(prefetch.get(1, sample));
+  EXPECT_EQ(sample, 10);
+  /* Already available. */
+  EXPECT_FALSE(prefetch.request(1));
+}
+
+TEST(abc_sample_prefetch, next_sample)
+{
+  SamplePrefetch<int> prefetch;
+  EXPECT_TRUE(prefetch.request(1));
+  prefetch.finish(1, 10);
+  EXPECT_TRUE(prefetch.request(2));
+  /* The previous sample stays available until the next one is read. */
+  int sample = 0;
+  EXPECT_TRUE(prefetch.get(1, sample));
+  EXPECT_FALSE(prefetch.get(2, sample));
+  prefetch.finish(2, 20);
+  EXPECT_FALSE(prefetch.get(1, sample));
+  EXPECT_TRUE(prefetch.get(2, sample));
+  EXPECT_EQ(sample, 20);
+}
+
+TEST(abc_sample_prefetch, retry_after_failure)
+{
+  SamplePrefetch<int> prefetch;
+  EXPECT_TRUE(prefetch.request(3));
+  prefetch.fail(3);
+  int sample = 0;
+  EXPECT_FALSE(prefetch.get(3, sample));
+  /* The failure is not remembered, so the sample is read again. */
+  EXPECT_TRUE(prefetch.request(3));
+  prefetch.finish(3, 30);
+  EXPECT_TRUE(prefetch.get(3, sample));
+  EXPECT_EQ(sample, 30);
+}
+
+TEST(abc_sample_prefetch, stale_failure)
+{
+  SamplePrefetch<int> prefetch;
+  EXPECT_TRUE(prefetch.request(3));
+  EXPECT_TRUE(prefetch.request(4));
+  /* A failure of an older request does not cancel the current one. */
+  prefetch.fail(3);
+  EXPECT_FALSE(prefetch.request(4));
+}
+
+}  // namespace blender::io::alembic
@@ -26,6 +26,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 struct Depsgraph;
 struct DupliObject;
@@ -85,6 +86,13 @@ struct HierarchyContext {
    * refers to a different object). */
   std::string higher_up_export_path;
 
+  /* Dupli-objects that are exported as the points of a single point instancer, instead of as
+   * objects of their own. Only set for contexts passed to create_point_instancer_writer(), in
+   * which case this is the context of the duplicator. The original_export_path of these
+   * dupli-objects is the export path of the original object data, which is what gets instanced.
+   * The pointers are only valid while the current frame is written. */
+  std::vector<const HierarchyContext *> point_instances;
+
   bool operator<(const HierarchyContext &other) const;
 
   /* Return a HierarchyContext representing the root of the export hierarchy. */
@@ -200,10 +208,13 @@ class AbstractHierarchyIterator {
   /* Mapping from ID to its export path. This is used for instancing; given an
    * instanced datablock, the export path of the original can be looked up. */
   typedef std::map<ID *, std::string> ExportPathMap;
+  /* Mapping from a duplicator to the dupli-objects that are exported as its point instances. */
+  typedef std::map<ObjectIdentifier, std::vector<HierarchyContext *>> PointInstancesMap;
 
  protected:
   ExportGraph export_graph_;
   ExportPathMap duplisource_export_path_;
+  PointInstancesMap point_instances_;
   Main *bmain_;
   Depsgraph *depsgraph_;
   WriterMap writers_;
@@ -263,11 +274,15 @@ class AbstractHierarchyIterator {
   void determine_export_paths(const HierarchyContext *parent_context);
   void determine_duplication_references(const HierarchyContext *parent_context,
                                         std::string indent);
+  /* Move the dupli-objects for which should_export_as_point_instance() returns true from the
+   * export graph to point_instances_. */
+  void determine_point_instances();
 
-  /* These three functions create writers and call their write() method. */
+  /* These functions create writers and call their write() method. */
   void make_writers(const HierarchyContext *parent_context);
   void make_writer_object_data(const HierarchyContext *context);
   void make_writers_particle_systems(const HierarchyContext *transform_context);
+  void make_writer_point_instancer(const HierarchyContext *duplicator_context);
 
   /* Return the appropriate HierarchyContext for the data of the object represented by
    * object_context. */
@@ -308,6 +323,16 @@ class AbstractHierarchyIterator {
 
   virtual bool should_visit_dupli_object(const DupliObject *dupli_object) const;
 
+  /* Return whether this dupli-object should be exported as a point of a point instancer that
+   * contains all such instances of its duplicator, instead of as an object of its own. This is
+   * only called for instances of an object whose data is exported elsewhere (see
+   * HierarchyContext::is_instance()), that are direct export-children of their duplicator and
+   * have no export-children themselves.
+   *
+   * When this returns true, create_point_instancer_writer() must create a writer, otherwise the
+   * dupli-object is not exported at all. */
+  virtual bool should_export_as_point_instance(const HierarchyContext *context) const;
+
   virtual ExportGraph::key_type determine_graph_index_object(const HierarchyContext *context);
   virtual ExportGraph::key_type determine_graph_index_dupli(
       const HierarchyContext *context,
@@ -327,6 +352,9 @@ class AbstractHierarchyIterator {
   virtual AbstractHierarchyWriter *create_data_writer(const HierarchyContext *context) = 0;
   virtual AbstractHierarchyWriter *create_hair_writer(const HierarchyContext *context) = 0;
   virtual AbstractHierarchyWriter *create_particle_writer(const HierarchyContext *context) = 0;
+  /* Only called when should_export_as_point_instance() returned true for some dupli-objects,
+   * see HierarchyContext::point_instances. */
+  virtual AbstractHierarchyWriter *create_point_instancer_writer(const HierarchyContext *context);
 
   /* Called by release_writers() to free what the create_XXX_writer() functions allocated. */
   virtual void release_writer(AbstractHierarchyWriter *writer) = 0;
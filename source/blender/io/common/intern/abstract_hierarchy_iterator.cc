@@ -183,6 +183,7 @@ void AbstractHierarchyIterator::iterate_and_write()
   export_graph_prune();
   determine_export_paths(HierarchyContext::root());
   determine_duplication_references(HierarchyContext::root(), "");
+  determine_point_instances();
   make_writers(HierarchyContext::root());
   export_graph_clear();
 }
@@ -399,6 +400,13 @@ void AbstractHierarchyIterator::export_graph_clear()
     }
   }
   export_graph_.clear();
+
+  for (PointInstancesMap::value_type &it : point_instances_) {
+    for (HierarchyContext *context : it.second) {
+      delete context;
+    }
+  }
+  point_instances_.clear();
 }
 
 void AbstractHierarchyIterator::visit_object(Object *object,
@@ -561,6 +569,46 @@ void AbstractHierarchyIterator::determine_duplication_references(
   }
 }
 
+void AbstractHierarchyIterator::determine_point_instances()
+{
+  for (ExportGraph::value_type &map_iter : export_graph_) {
+    const ObjectIdentifier &graph_key = map_iter.first;
+    if (graph_key.object == nullptr || graph_key.duplicated_by != nullptr) {
+      /* Only dupli-objects that are export-children of a real duplicator are considered. */
+      continue;
+    }
+
+    ExportChildren &children = map_iter.second;
+    for (ExportChildren::iterator it = children.begin(); it != children.end();) {
+      HierarchyContext *context = *it;
+      if (context->duplicator != graph_key.object || !context->is_instance() ||
+          context->object->data == nullptr) {
+        ++it;
+        continue;
+      }
+      /* Instances that are export-parents of other objects need their own transform. */
+      const ExportGraph::const_iterator found_children = export_graph_.find(
+          ObjectIdentifier::for_hierarchy_context(context));
+      if (found_children != export_graph_.end() && !found_children->second.empty()) {
+        ++it;
+        continue;
+      }
+      if (!should_export_as_point_instance(context)) {
+        ++it;
+        continue;
+      }
+
+      /* The point instancer instances the original object data, see
+       * HierarchyContext::point_instances. */
+      ID *source_data_id = static_cast<ID *>(context->object->data);
+      context->mark_as_instance_of(duplisource_export_path_[source_data_id]);
+
+      point_instances_[graph_key].push_back(context);
+      it = children.erase(it);
+    }
+  }
+}
+
 void AbstractHierarchyIterator::make_writers(const HierarchyContext *parent_context)
 {
   float parent_matrix_inv_world[4][4];
@@ -600,6 +648,7 @@ void AbstractHierarchyIterator::make_writers(const HierarchyContext *parent_cont
     if (!context->weak_export) {
       make_writers_particle_systems(context);
       make_writer_object_data(context);
+      make_writer_point_instancer(context);
     }
 
     /* Recurse into this object's children. */
@@ -694,6 +743,34 @@ void AbstractHierarchyIterator::make_writers_particle_systems(
   }
 }
 
+void AbstractHierarchyIterator::make_writer_point_instancer(
+    const HierarchyContext *duplicator_context)
+{
+  const PointInstancesMap::const_iterator found = point_instances_.find(
+      ObjectIdentifier::for_hierarchy_context(duplicator_context));
+  if (found == point_instances_.end()) {
+    return;
+  }
+
+  HierarchyContext instancer_context = *duplicator_context;
+  instancer_context.export_name = make_valid_name("instances");
+  instancer_context.export_path = path_concatenate(duplicator_context->export_path,
+                                                   instancer_context.export_name);
+  instancer_context.higher_up_export_path = duplicator_context->export_path;
+  instancer_context.point_instances.assign(found->second.begin(), found->second.end());
+
+  EnsuredWriter writer = ensure_writer(&instancer_context,
+                                       &AbstractHierarchyIterator::create_point_instancer_writer);
+  if (!writer) {
+    return;
+  }
+
+  /* Always write upon creation, otherwise depend on which subset is active. */
+  if (writer.is_newly_created() || export_subset_.shapes) {
+    writer->write(instancer_context);
+  }
+}
+
 std::string AbstractHierarchyIterator::get_object_name(const Object *object) const
 {
   return get_id_name(&object->id);
@@ -749,4 +826,16 @@ bool AbstractHierarchyIterator::should_visit_dupli_object(const DupliObject *dup
   return !dupli_object->no_draw;
 }
 
+bool AbstractHierarchyIterator::should_export_as_point_instance(
+    const HierarchyContext * /*context*/) const
+{
+  return false;
+}
+
+AbstractHierarchyWriter *AbstractHierarchyIterator::create_point_instancer_writer(
+    const HierarchyContext * /*context*/)
+{
+  return nullptr;
+}
+
 }  // namespace blender::io
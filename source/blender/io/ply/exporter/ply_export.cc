@@ -0,0 +1,299 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "BKE_attribute.hh"
+#include "BKE_blender_version.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_array.hh"
+#include "BLI_color.hh"
+#include "BLI_endian_defines.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_rotation.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "IO_orientation.h"
+
+#include "ply_export.hh"
+#include "ply_export_binary_writer.hh"
+
+namespace blender::io::ply {
+
+/** Amount of vertices or faces that are gathered before they are written. */
+static const int64_t records_block_size = 1024 * 1024;
+
+void ExportMesh::set_transform(const float new_transform[4][4])
+{
+  copy_m4_m4(transform, new_transform);
+  /* Normals need inverse transpose of the regular matrix to handle non-uniform scale. */
+  float normal_matrix[3][3];
+  copy_m3_m4(normal_matrix, transform);
+  invert_m3_m3(normal_transform, normal_matrix);
+  transpose_m3(normal_transform);
+  flip_winding = is_negative_m4(transform);
+}
+
+static Vector<ExportMesh> gather_meshes(Depsgraph *depsgraph,
+                                        const PLYExportParams &export_params)
+{
+  float axes_transform[3][3];
+  unit_m3(axes_transform);
+  /* +Y-forward and +Z-up are the default Blender axis settings. */
+  mat3_from_axis_conversion(
+      export_params.forward_axis, export_params.up_axis, IO_AXIS_Y, IO_AXIS_Z, axes_transform);
+  mul_m3_fl(axes_transform, export_params.global_scale);
+
+  Vector<ExportMesh> meshes;
+  DEGObjectIterSettings deg_iter_settings{};
+  deg_iter_settings.depsgraph = depsgraph;
+  deg_iter_settings.flags = DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
+                            DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET | DEG_ITER_OBJECT_FLAG_VISIBLE |
+                            DEG_ITER_OBJECT_FLAG_DUPLI;
+  DEG_OBJECT_ITER_BEGIN (&deg_iter_settings, object) {
+    if (object->type != OB_MESH) {
+      continue;
+    }
+    if (export_params.export_selected_objects && !(object->base_flag & BASE_SELECTED)) {
+      continue;
+    }
+    Object *obj_eval = DEG_get_evaluated_object(depsgraph, object);
+    const Mesh *mesh = export_params.apply_modifiers ?
+                           BKE_object_get_evaluated_mesh(obj_eval) :
+                           BKE_object_get_pre_modified_mesh(obj_eval);
+    if (mesh == nullptr || mesh->totvert == 0) {
+      continue;
+    }
+    ExportMesh export_mesh;
+    export_mesh.mesh = mesh;
+    /* Dupli objects are temporary, so the transform is copied here. */
+    float transform[4][4];
+    mul_m4_m3m4(transform, axes_transform, object->object_to_world);
+    /* #mul_m4_m3m4 does not transform last row of the matrix, i.e. location data. */
+    mul_v3_m3v3(transform[3], axes_transform, object->object_to_world[3]);
+    transform[3][3] = object->object_to_world[3][3];
+    export_mesh.set_transform(transform);
+    if (export_params.export_colors && mesh->active_color_attribute != nullptr) {
+      export_mesh.colors = mesh->attributes().lookup<ColorGeometry4b>(
+          mesh->active_color_attribute, ATTR_DOMAIN_POINT);
+    }
+    meshes.append(std::move(export_mesh));
+  }
+  DEG_OBJECT_ITER_END;
+  return meshes;
+}
+
+static std::string make_header(const int64_t verts_num,
+                               const int64_t polys_num,
+                               const bool use_uchar_counts,
+                               const bool export_normals,
+                               const bool export_colors)
+{
+  std::string header = "ply\nformat binary_little_endian 1.0\n";
+  header += std::string("comment Created by Blender ") + BKE_blender_version_string() + "\n";
+  header += "element vertex " + std::to_string(verts_num) + "\n";
+  header += "property float x\nproperty float y\nproperty float z\n";
+  if (export_normals) {
+    header += "property float nx\nproperty float ny\nproperty float nz\n";
+  }
+  if (export_colors) {
+    header += "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+    header += "property uchar alpha\n";
+  }
+  header += "element face " + std::to_string(polys_num) + "\n";
+  header += use_uchar_counts ? "property list uchar uint vertex_indices\n" :
+                               "property list uint uint vertex_indices\n";
+  header += "end_header\n";
+  return header;
+}
+
+/* Binary PLY files are always written in little endian order, so the bytes of every value are
+ * swapped on big endian platforms. */
+template<typename T> static char *write_value(char *dst, const T value)
+{
+  static_assert(std::is_arithmetic_v<T>);
+  memcpy(dst, &value, sizeof(T));
+  if constexpr (ENDIAN_ORDER == B_ENDIAN) {
+    std::reverse(dst, dst + sizeof(T));
+  }
+  return dst + sizeof(T);
+}
+
+static char *write_value(char *dst, const float3 &value)
+{
+  dst = write_value(dst, value.x);
+  dst = write_value(dst, value.y);
+  return write_value(dst, value.z);
+}
+
+static char *write_value(char *dst, const ColorGeometry4b &value)
+{
+  dst = write_value(dst, value.r);
+  dst = write_value(dst, value.g);
+  dst = write_value(dst, value.b);
+  return write_value(dst, value.a);
+}
+
+static void write_vertices(const ExportMesh &export_mesh,
+                           const bool export_normals,
+                           const bool export_colors,
+                           Array<char> &buffer,
+                           BinaryFileWriter &writer)
+{
+  const int64_t stride = sizeof(float3) + (export_normals ? sizeof(float3) : 0) +
+                         (export_colors ? sizeof(ColorGeometry4b) : 0);
+  const Span<float3> positions = export_mesh.mesh->vert_positions();
+  const Span<float3> normals = export_normals ? export_mesh.mesh->vertex_normals() :
+                                                Span<float3>();
+  VArraySpan<ColorGeometry4b> colors;
+  if (export_colors && export_mesh.colors) {
+    colors = VArraySpan<ColorGeometry4b>(export_mesh.colors);
+  }
+
+  for (int64_t start = 0; start < positions.size(); start += records_block_size) {
+    const IndexRange block(start, std::min(records_block_size, positions.size() - start));
+    const int64_t block_size = block.size() * stride;
+    if (buffer.size() < block_size) {
+      buffer.reinitialize(block_size);
+    }
+    threading::parallel_for(IndexRange(block.size()), 8192, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        const int64_t vert = block[i];
+        char *dst = buffer.data() + i * stride;
+        float3 position;
+        mul_v3_m4v3(position, export_mesh.transform, positions[vert]);
+        dst = write_value(dst, position);
+        if (export_normals) {
+          float3 normal;
+          mul_v3_m3v3(normal, export_mesh.normal_transform, normals[vert]);
+          normalize_v3(normal);
+          dst = write_value(dst, normal);
+        }
+        if (export_colors) {
+          const ColorGeometry4b color = colors.is_empty() ? ColorGeometry4b(0, 0, 0, 255) :
+                                                            colors[vert];
+          dst = write_value(dst, color);
+        }
+      }
+    });
+    writer.write_bytes(buffer.as_span().take_front(block_size));
+  }
+}
+
+static void write_faces(const ExportMesh &export_mesh,
+                        const uint32_t vertex_offset,
+                        const bool use_uchar_counts,
+                        Array<char> &buffer,
+                        BinaryFileWriter &writer)
+{
+  const Span<MPoly> polys = export_mesh.mesh->polys();
+  const Span<MLoop> loops = export_mesh.mesh->loops();
+  const int64_t count_size = use_uchar_counts ? sizeof(uint8_t) : sizeof(uint32_t);
+  Array<int64_t> record_offsets(std::min(records_block_size, polys.size()) + 1);
+
+  for (int64_t start = 0; start < polys.size(); start += records_block_size) {
+    const IndexRange block(start, std::min(records_block_size, polys.size() - start));
+    /* Records have different sizes, so compute where each of them starts first. */
+    record_offsets[0] = 0;
+    for (const int64_t i : IndexRange(block.size())) {
+      record_offsets[i + 1] = record_offsets[i] + count_size +
+                              polys[block[i]].totloop * sizeof(uint32_t);
+    }
+    const int64_t block_size = record_offsets[block.size()];
+    if (buffer.size() < block_size) {
+      buffer.reinitialize(block_size);
+    }
+    threading::parallel_for(IndexRange(block.size()), 8192, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        const MPoly &poly = polys[block[i]];
+        char *dst = buffer.data() + record_offsets[i];
+        if (use_uchar_counts) {
+          dst = write_value(dst, uint8_t(poly.totloop));
+        }
+        else {
+          dst = write_value(dst, uint32_t(poly.totloop));
+        }
+        const Span<MLoop> poly_loops = loops.slice(poly.loopstart, poly.totloop);
+        if (export_mesh.flip_winding) {
+          for (int corner = poly_loops.size() - 1; corner >= 0; corner--) {
+            dst = write_value(dst, uint32_t(vertex_offset + poly_loops[corner].v));
+          }
+        }
+        else {
+          for (const MLoop &loop : poly_loops) {
+            dst = write_value(dst, uint32_t(vertex_offset + loop.v));
+          }
+        }
+      }
+    });
+    writer.write_bytes(buffer.as_span().take_front(block_size));
+  }
+}
+
+void write_meshes(const Span<ExportMesh> meshes, const PLYExportParams &export_params)
+{
+  int64_t verts_num = 0, polys_num = 0;
+  int max_poly_size = 0;
+  bool export_colors = false;
+  for (const ExportMesh &export_mesh : meshes) {
+    verts_num += export_mesh.mesh->totvert;
+    polys_num += export_mesh.mesh->totpoly;
+    for (const MPoly &poly : export_mesh.mesh->polys()) {
+      max_poly_size = std::max(max_poly_size, poly.totloop);
+    }
+    export_colors |= bool(export_mesh.colors);
+  }
+  if (verts_num > UINT32_MAX) {
+    fprintf(stderr, "PLY Exporter: too many vertices to export (%lld).\n", (long long)verts_num);
+    return;
+  }
+  const bool use_uchar_counts = max_poly_size <= UINT8_MAX;
+
+  BinaryFileWriter writer(export_params.filepath);
+  writer.write_header(make_header(
+      verts_num, polys_num, use_uchar_counts, export_params.export_normals, export_colors));
+
+  /* Buffer that is reused for all blocks of records. */
+  Array<char> buffer;
+  for (const ExportMesh &export_mesh : meshes) {
+    write_vertices(export_mesh, export_params.export_normals, export_colors, buffer, writer);
+  }
+  uint32_t vertex_offset = 0;
+  for (const ExportMesh &export_mesh : meshes) {
+    write_faces(export_mesh, vertex_offset, use_uchar_counts, buffer, writer);
+    vertex_offset += uint32_t(export_mesh.mesh->totvert);
+  }
+}
+
+void exporter_main(Depsgraph *depsgraph, const PLYExportParams &export_params)
+{
+  const Vector<ExportMesh> meshes = gather_meshes(depsgraph, export_params);
+  write_meshes(meshes, export_params);
+}
+
+void exporter_main(bContext *C, const PLYExportParams &export_params)
+{
+  Depsgraph *depsgraph = CTX_data_ensure_evaluated_depsgraph(C);
+  exporter_main(depsgraph, export_params);
+}
+
+}  // namespace blender::io::ply
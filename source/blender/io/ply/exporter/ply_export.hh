@@ -0,0 +1,45 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#pragma once
+
+#include "BLI_color.hh"
+#include "BLI_span.hh"
+#include "BLI_virtual_array.hh"
+
+#include "IO_ply.h"
+
+struct Depsgraph;
+struct Mesh;
+
+namespace blender::io::ply {
+
+struct ExportMesh {
+  const Mesh *mesh;
+  float transform[4][4];
+  float normal_transform[3][3];
+  /** The transform mirrors the mesh, so the order of face corners is reversed to keep the
+   * faces pointing outwards. */
+  bool flip_winding;
+  VArray<ColorGeometry4b> colors;
+
+  /** Set the transform and the values derived from it. */
+  void set_transform(const float transform[4][4]);
+};
+
+/* Main export function used from within Blender. */
+void exporter_main(bContext *C, const PLYExportParams &export_params);
+
+/* Used from tests, where full bContext does not exist. */
+void exporter_main(Depsgraph *depsgraph, const PLYExportParams &export_params);
+
+/**
+ * Write the meshes to a binary PLY file. Only the file path and the normals option of the
+ * parameters are used. Used from tests, to export meshes without a depsgraph.
+ */
+void write_meshes(Span<ExportMesh> meshes, const PLYExportParams &export_params);
+
+}  // namespace blender::io::ply
@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include "BLI_fileops.h"
+
+#include "ply_export_binary_writer.hh"
+
+namespace blender::io::ply {
+
+BinaryFileWriter::BinaryFileWriter(const char *filepath)
+{
+  file_ = BLI_fopen(filepath, "wb");
+  if (file_ == nullptr) {
+    fprintf(stderr, "PLY Exporter: failed to open file '%s'.\n", filepath);
+    failed_ = true;
+  }
+}
+
+BinaryFileWriter::~BinaryFileWriter()
+{
+  if (file_ != nullptr) {
+    if (fclose(file_) != 0) {
+      fprintf(stderr, "PLY Exporter: error closing file.\n");
+    }
+  }
+}
+
+bool BinaryFileWriter::is_valid() const
+{
+  return !failed_;
+}
+
+void BinaryFileWriter::write_header(const StringRef header)
+{
+  this->write_bytes(Span<char>(header.data(), header.size()));
+}
+
+void BinaryFileWriter::write_bytes(const Span<char> data)
+{
+  if (failed_ || data.is_empty()) {
+    return;
+  }
+  if (fwrite(data.data(), 1, size_t(data.size()), file_) != size_t(data.size())) {
+    fprintf(stderr, "PLY Exporter: failed to write to file.\n");
+    failed_ = true;
+  }
+}
+
+}  // namespace blender::io::ply
@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#pragma once
+
+#include <cstdio>
+
+#include "BLI_span.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_utility_mixins.hh"
+
+namespace blender::io::ply {
+
+/**
+ * Writer for binary PLY files. Callers fill whole blocks of records (in parallel) and hand
+ * them over with one call, so the file is written in few large writes.
+ */
+class BinaryFileWriter : NonCopyable, NonMovable {
+ private:
+  FILE *file_ = nullptr;
+  bool failed_ = false;
+
+ public:
+  BinaryFileWriter(const char *filepath);
+  ~BinaryFileWriter();
+
+  /**
+   * Whether the file could be opened and all writes so far succeeded.
+   */
+  bool is_valid() const;
+
+  void write_header(StringRef header);
+  void write_bytes(Span<char> data);
+};
+
+}  // namespace blender::io::ply
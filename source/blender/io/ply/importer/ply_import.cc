@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <cstdio>
+#include <fcntl.h>
+#ifdef WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+#include "BKE_pointcloud.h"
+
+#include "BLI_fileops.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_rotation.h"
+#include "BLI_memory_utils.hh"
+#include "BLI_mmap.h"
+#include "BLI_string.h"
+
+#include "DNA_collection_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcloud_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "ply_import.hh"
+#include "ply_import_header.hh"
+#include "ply_import_mesh.hh"
+#include "ply_import_pointcloud.hh"
+
+namespace blender::io::ply {
+
+void importer_main(bContext *C, const PLYImportParams &import_params)
+{
+  Main *bmain = CTX_data_main(C);
+  Scene *scene = CTX_data_scene(C);
+  ViewLayer *view_layer = CTX_data_view_layer(C);
+  importer_main(bmain, scene, view_layer, import_params);
+}
+
+void importer_main(Main *bmain,
+                   Scene *scene,
+                   ViewLayer *view_layer,
+                   const PLYImportParams &import_params)
+{
+  const int file = BLI_open(import_params.filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    fprintf(stderr, "Failed to open PLY file:'%s'.\n", import_params.filepath);
+    return;
+  }
+  const size_t file_size = BLI_file_descriptor_size(file);
+  /* Binary data is decoded straight from the mapping, without reading it into a buffer first. */
+  BLI_mmap_file *mmap_file = BLI_mmap_open(file);
+  close(file);
+  if (mmap_file == nullptr) {
+    fprintf(stderr, "Failed to map PLY file:'%s'.\n", import_params.filepath);
+    return;
+  }
+  BLI_SCOPED_DEFER([&]() { BLI_mmap_free(mmap_file); });
+  const Span<char> file_data(static_cast<const char *>(BLI_mmap_get_pointer(mmap_file)),
+                             int64_t(file_size));
+
+  PlyHeader header;
+  const char *error = read_header(StringRef(file_data.data(), file_data.size()), header);
+  if (error != nullptr) {
+    fprintf(stderr, "PLY Importer: %s: '%s'\n", error, import_params.filepath);
+    return;
+  }
+  const Span<char> element_data = file_data.drop_front(header.header_size);
+
+  /* Name used for both the object and its data. */
+  char ob_name[FILE_MAX];
+  STRNCPY(ob_name, BLI_path_basename(import_params.filepath));
+  BLI_path_extension_replace(ob_name, FILE_MAX, "");
+
+  Object *obj;
+  if (import_params.use_point_cloud) {
+    PointCloud *pointcloud_nomain = read_point_cloud(header, element_data, error);
+    if (pointcloud_nomain == nullptr) {
+      fprintf(stderr, "PLY Importer: %s: '%s'\n", error, import_params.filepath);
+      return;
+    }
+    obj = BKE_object_add_only_object(bmain, OB_POINTCLOUD, ob_name);
+    PointCloud *pointcloud = static_cast<PointCloud *>(BKE_pointcloud_add(bmain, ob_name));
+    /* Takes over the attribute arrays, so the points are never copied. */
+    BKE_pointcloud_nomain_to_pointcloud(pointcloud_nomain, pointcloud, true);
+    /* The user count of 1 from #BKE_pointcloud_add is used by the object. */
+    obj->data = pointcloud;
+  }
+  else {
+    Mesh *mesh_nomain = read_mesh(header, element_data, error);
+    if (mesh_nomain == nullptr) {
+      fprintf(stderr, "PLY Importer: %s: '%s'\n", error, import_params.filepath);
+      return;
+    }
+    if (import_params.use_mesh_validate) {
+      bool verbose_validate = false;
+#ifdef DEBUG
+      verbose_validate = true;
+#endif
+      BKE_mesh_validate(mesh_nomain, verbose_validate, false);
+    }
+    obj = BKE_object_add_only_object(bmain, OB_MESH, ob_name);
+    Mesh *mesh = BKE_mesh_add(bmain, ob_name);
+    BKE_mesh_nomain_to_mesh(mesh_nomain, mesh, obj);
+    BKE_mesh_assign_object(bmain, obj, mesh);
+    /* User count was already 1 after #BKE_mesh_add. */
+    id_us_min(&mesh->id);
+  }
+
+  BKE_view_layer_base_deselect_all(scene, view_layer);
+  LayerCollection *lc = BKE_layer_collection_get_active(view_layer);
+  BKE_collection_object_add(bmain, lc->collection, obj);
+  BKE_view_layer_synced_ensure(scene, view_layer);
+  Base *base = BKE_view_layer_base_find(view_layer, obj);
+  BKE_view_layer_base_select_and_set_active(view_layer, base);
+
+  float global_scale = import_params.global_scale;
+  if ((scene->unit.system != USER_UNIT_NONE) && import_params.use_scene_unit) {
+    global_scale *= scene->unit.scale_length;
+  }
+  float scale_vec[3] = {global_scale, global_scale, global_scale};
+  float obmat3x3[3][3];
+  unit_m3(obmat3x3);
+  float obmat4x4[4][4];
+  unit_m4(obmat4x4);
+  /* +Y-forward and +Z-up are the Blender's default axis settings. */
+  mat3_from_axis_conversion(
+      IO_AXIS_Y, IO_AXIS_Z, import_params.forward_axis, import_params.up_axis, obmat3x3);
+  copy_m4_m3(obmat4x4, obmat3x3);
+  rescale_m4(obmat4x4, scale_vec);
+  BKE_object_apply_mat4(obj, obmat4x4, true, false);
+
+  DEG_id_tag_update(&lc->collection->id, ID_RECALC_COPY_ON_WRITE);
+  int flags = ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY | ID_RECALC_ANIMATION |
+              ID_RECALC_BASE_FLAGS;
+  DEG_id_tag_update_ex(bmain, &obj->id, flags);
+  DEG_id_tag_update(&scene->id, ID_RECALC_BASE_FLAGS);
+  DEG_relations_tag_update(bmain);
+}
+
+}  // namespace blender::io::ply
@@ -0,0 +1,262 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+/* NOTE: see the STL importer for why fast_float is used instead of <charconv>. */
+#include "fast_float.h"
+
+#include <cmath>
+#include <limits>
+
+#include "ply_import_data.hh"
+
+namespace blender::io::ply {
+
+/* -------------------------------------------------------------------- */
+/** \name Binary Element Layout
+ * \{ */
+
+int64_t scan_binary_records(const PlyElement &element,
+                            const Span<char> data,
+                            int64_t offset,
+                            const bool swap,
+                            const int list_property,
+                            Vector<std::pair<int64_t, int>> *r_lists)
+{
+  for (int64_t record = 0; record < element.count; record++) {
+    for (const int i : element.properties.index_range()) {
+      const PlyProperty &property = element.properties[i];
+      if (!property.is_list()) {
+        offset += ply_data_type_size(property.type);
+        continue;
+      }
+      const int64_t count_size = ply_data_type_size(property.count_type);
+      if (offset + count_size > data.size()) {
+        return -1;
+      }
+      const int64_t count = load_binary_count(property.count_type, data.data() + offset, swap);
+      if (count < 0) {
+        return -1;
+      }
+      offset += count_size;
+      const int64_t list_size = count * ply_data_type_size(property.type);
+      if (list_size > data.size() - offset) {
+        return -1;
+      }
+      if (i == list_property && r_lists) {
+        r_lists->append({offset, int(count)});
+      }
+      offset += list_size;
+    }
+    if (offset > data.size()) {
+      return -1;
+    }
+  }
+  return offset;
+}
+
+int64_t skip_binary_element(const PlyElement &element,
+                            const Span<char> data,
+                            const int64_t offset,
+                            const bool swap)
+{
+  const int64_t stride = element.binary_stride();
+  if (stride >= 0) {
+    /* The element count comes from the header, so avoid overflowing the offset. */
+    if (stride > 0 && element.count > (data.size() - offset) / stride) {
+      return -1;
+    }
+    return offset + stride * element.count;
+  }
+  return scan_binary_records(element, data, offset, swap, -1, nullptr);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name ASCII Files
+ * \{ */
+
+/**
+ * \return False if the value does not fit into the type, converting it would be undefined.
+ */
+template<typename T> static bool append_binary_value(const double value, Vector<char> &r_data)
+{
+  if constexpr (std::is_integral_v<T>) {
+    /* Also rejects NaN. */
+    if (!(value >= double(std::numeric_limits<T>::min()) &&
+          value <= double(std::numeric_limits<T>::max()))) {
+      return false;
+    }
+  }
+  else if constexpr (std::is_same_v<T, float>) {
+    if (std::isfinite(value) && std::abs(value) > double(std::numeric_limits<float>::max())) {
+      return false;
+    }
+  }
+  const T typed_value = T(value);
+  const char *bytes = reinterpret_cast<const char *>(&typed_value);
+  r_data.extend(Span<char>(bytes, sizeof(T)));
+  return true;
+}
+
+static bool append_binary_value(const PlyDataType type, const double value, Vector<char> &r_data)
+{
+  switch (type) {
+    case PlyDataType::Char:
+      return append_binary_value<int8_t>(value, r_data);
+    case PlyDataType::UChar:
+      return append_binary_value<uint8_t>(value, r_data);
+    case PlyDataType::Short:
+      return append_binary_value<int16_t>(value, r_data);
+    case PlyDataType::UShort:
+      return append_binary_value<uint16_t>(value, r_data);
+    case PlyDataType::Int:
+      return append_binary_value<int32_t>(value, r_data);
+    case PlyDataType::UInt:
+      return append_binary_value<uint32_t>(value, r_data);
+    case PlyDataType::Float:
+      return append_binary_value<float>(value, r_data);
+    case PlyDataType::Double:
+      return append_binary_value<double>(value, r_data);
+    case PlyDataType::None:
+      BLI_assert_unreachable();
+      break;
+  }
+  return false;
+}
+
+/** List sizes have to be stored in an `int`, like the sizes of binary lists. */
+static bool is_valid_list_size(const double value)
+{
+  return value >= 0.0 && value <= double(INT32_MAX);
+}
+
+bool AsciiDataReader::next_value(double &r_value)
+{
+  /* Treat any ASCII control character as white-space. */
+  while (pos_ < end_ && *pos_ <= ' ') {
+    pos_++;
+  }
+  const fast_float::from_chars_result res = fast_float::from_chars(pos_, end_, r_value);
+  if (res.ec != std::errc()) {
+    return false;
+  }
+  pos_ = res.ptr;
+  return true;
+}
+
+bool AsciiDataReader::read_records(const PlyElement &element,
+                                   const int64_t count,
+                                   Vector<char> &r_data)
+{
+  for (int64_t record = 0; record < count; record++) {
+    for (const PlyProperty &property : element.properties) {
+      double value;
+      if (!property.is_list()) {
+        if (!this->next_value(value) || !append_binary_value(property.type, value, r_data)) {
+          return false;
+        }
+        continue;
+      }
+      if (!this->next_value(value) || !is_valid_list_size(value)) {
+        return false;
+      }
+      const int64_t list_size = int64_t(value);
+      if (!append_binary_value(property.count_type, value, r_data)) {
+        return false;
+      }
+      for (int64_t i = 0; i < list_size; i++) {
+        if (!this->next_value(value) || !append_binary_value(property.type, value, r_data)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool AsciiDataReader::skip_element(const PlyElement &element)
+{
+  for (int64_t record = 0; record < element.count; record++) {
+    for (const PlyProperty &property : element.properties) {
+      double value;
+      if (!this->next_value(value)) {
+        return false;
+      }
+      if (!property.is_list()) {
+        continue;
+      }
+      if (!is_valid_list_size(value)) {
+        return false;
+      }
+      const int64_t list_size = int64_t(value);
+      for (int64_t i = 0; i < list_size; i++) {
+        if (!this->next_value(value)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Vertex Properties
+ * \{ */
+
+VertexSink vertex_sink_from_property(const PlyProperty &property)
+{
+  if (property.is_list()) {
+    return VertexSink::None;
+  }
+  const StringRef name = property.name;
+  if (name == "x") {
+    return VertexSink::PositionX;
+  }
+  if (name == "y") {
+    return VertexSink::PositionY;
+  }
+  if (name == "z") {
+    return VertexSink::PositionZ;
+  }
+  if (name == "nx") {
+    return VertexSink::NormalX;
+  }
+  if (name == "ny") {
+    return VertexSink::NormalY;
+  }
+  if (name == "nz") {
+    return VertexSink::NormalZ;
+  }
+  if (ELEM(name, "red", "r", "diffuse_red")) {
+    return VertexSink::ColorR;
+  }
+  if (ELEM(name, "green", "g", "diffuse_green")) {
+    return VertexSink::ColorG;
+  }
+  if (ELEM(name, "blue", "b", "diffuse_blue")) {
+    return VertexSink::ColorB;
+  }
+  if (ELEM(name, "alpha", "a", "diffuse_alpha")) {
+    return VertexSink::ColorA;
+  }
+  if (ELEM(name, "s", "u", "texture_u", "texture_s")) {
+    return VertexSink::U;
+  }
+  if (ELEM(name, "t", "v", "texture_v", "texture_t")) {
+    return VertexSink::V;
+  }
+  if (ELEM(name, "radius", "scale")) {
+    return VertexSink::Radius;
+  }
+  return VertexSink::None;
+}
+
+/** \} */
+
+}  // namespace blender::io::ply
@@ -0,0 +1,283 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ *
+ * Decoding of element data that is shared by the mesh and the point cloud readers.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "BLI_math_base.h"
+#include "BLI_span.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "ply_data.hh"
+
+namespace blender::io::ply {
+
+/* -------------------------------------------------------------------- */
+/** \name Binary Value Loading
+ * \{ */
+
+template<typename T, bool SwapEndian> struct BinaryLoader {
+  static T load(const char *ptr)
+  {
+    T value;
+    memcpy(&value, ptr, sizeof(T));
+    if constexpr (SwapEndian) {
+      char *bytes = reinterpret_cast<char *>(&value);
+      std::reverse(bytes, bytes + sizeof(T));
+    }
+    return value;
+  }
+};
+
+/**
+ * Call the function with a #BinaryLoader for the given type, so that loops over values
+ * are compiled once per type and byte order.
+ */
+template<bool SwapEndian, typename Fn>
+inline void with_binary_loader(const PlyDataType type, const Fn &fn)
+{
+  switch (type) {
+    case PlyDataType::Char:
+      fn(BinaryLoader<int8_t, SwapEndian>());
+      break;
+    case PlyDataType::UChar:
+      fn(BinaryLoader<uint8_t, SwapEndian>());
+      break;
+    case PlyDataType::Short:
+      fn(BinaryLoader<int16_t, SwapEndian>());
+      break;
+    case PlyDataType::UShort:
+      fn(BinaryLoader<uint16_t, SwapEndian>());
+      break;
+    case PlyDataType::Int:
+      fn(BinaryLoader<int32_t, SwapEndian>());
+      break;
+    case PlyDataType::UInt:
+      fn(BinaryLoader<uint32_t, SwapEndian>());
+      break;
+    case PlyDataType::Float:
+      fn(BinaryLoader<float, SwapEndian>());
+      break;
+    case PlyDataType::Double:
+      fn(BinaryLoader<double, SwapEndian>());
+      break;
+    case PlyDataType::None:
+      BLI_assert_unreachable();
+      break;
+  }
+}
+
+template<typename Fn>
+inline void with_binary_loader(const PlyDataType type, const bool swap, const Fn &fn)
+{
+  if (swap) {
+    with_binary_loader<true>(type, fn);
+  }
+  else {
+    with_binary_loader<false>(type, fn);
+  }
+}
+
+/**
+ * Load the size of a list property.
+ * \return The size, or -1 when it is negative, not a number or does not fit into an `int`.
+ */
+inline int64_t load_binary_count(const PlyDataType type, const char *ptr, const bool swap)
+{
+  double count = 0.0;
+  with_binary_loader(type, swap, [&](auto loader) {
+    count = double(decltype(loader)::load(ptr));
+  });
+  if (!(count >= 0.0 && count <= double(INT32_MAX))) {
+    return -1;
+  }
+  return int64_t(count);
+}
+
+/**
+ * Convert a loaded value to a vertex index.
+ * \return The index, or -1 when it is negative or not a number.
+ */
+template<typename T> inline int64_t value_to_index(const T value)
+{
+  if constexpr (std::is_floating_point_v<T>) {
+    /* Converting values that don't fit is undefined. */
+    if (!(value >= T(0) && value <= T(INT32_MAX))) {
+      return -1;
+    }
+  }
+  return int64_t(value);
+}
+
+/**
+ * Load one scalar property of every record of an element in parallel.
+ * \param start: Position of the property in the first record.
+ */
+template<typename StoreFn>
+inline void read_binary_column(const char *start,
+                               const int64_t stride,
+                               const int64_t count,
+                               const PlyDataType type,
+                               const bool swap,
+                               const StoreFn &store)
+{
+  with_binary_loader(type, swap, [&](auto loader) {
+    using Loader = decltype(loader);
+    threading::parallel_for(IndexRange(count), 8192, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        store(i, Loader::load(start + i * stride));
+      }
+    });
+  });
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Binary Element Layout
+ * \{ */
+
+/**
+ * Walk over the records of an element that contains list properties.
+ *
+ * \param list_property: Index of the list property whose position and size is recorded
+ * in `r_lists`, or -1.
+ * \return Offset after the element, or -1 when the data is truncated.
+ */
+int64_t scan_binary_records(const PlyElement &element,
+                            Span<char> data,
+                            int64_t offset,
+                            bool swap,
+                            int list_property,
+                            Vector<std::pair<int64_t, int>> *r_lists);
+
+/**
+ * \return Offset after the element, or -1 when the data is truncated.
+ */
+int64_t skip_binary_element(const PlyElement &element,
+                            Span<char> data,
+                            int64_t offset,
+                            bool swap);
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name ASCII Files
+ * \{ */
+
+/**
+ * Converts the records of an ASCII file to binary records in native byte order,
+ * so that they can be decoded with the same code as binary files. Records are read
+ * sequentially, so large elements can be converted in batches.
+ */
+class AsciiDataReader {
+  const char *pos_;
+  const char *end_;
+
+ public:
+  AsciiDataReader(Span<char> text) : pos_(text.begin()), end_(text.end())
+  {
+  }
+
+  /**
+   * Append the next `count` records of the element to `r_data`.
+   * \return False if the text is invalid or truncated.
+   */
+  bool read_records(const PlyElement &element, int64_t count, Vector<char> &r_data);
+
+  /** Skip all records of the element. */
+  bool skip_element(const PlyElement &element);
+
+ private:
+  bool next_value(double &r_value);
+};
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Vertex Properties
+ * \{ */
+
+enum class VertexSink {
+  None,
+  PositionX,
+  PositionY,
+  PositionZ,
+  NormalX,
+  NormalY,
+  NormalZ,
+  ColorR,
+  ColorG,
+  ColorB,
+  ColorA,
+  U,
+  V,
+  Radius,
+};
+
+VertexSink vertex_sink_from_property(const PlyProperty &property);
+
+template<typename Fn> inline void with_vertex_sink(const VertexSink sink, const Fn &fn)
+{
+#define SINK_CASE(NAME) \
+  case VertexSink::NAME: \
+    fn(std::integral_constant<VertexSink, VertexSink::NAME>()); \
+    break;
+
+  switch (sink) {
+    SINK_CASE(PositionX)
+    SINK_CASE(PositionY)
+    SINK_CASE(PositionZ)
+    SINK_CASE(NormalX)
+    SINK_CASE(NormalY)
+    SINK_CASE(NormalZ)
+    SINK_CASE(ColorR)
+    SINK_CASE(ColorG)
+    SINK_CASE(ColorB)
+    SINK_CASE(ColorA)
+    SINK_CASE(U)
+    SINK_CASE(V)
+    SINK_CASE(Radius)
+    case VertexSink::None:
+      break;
+  }
+
+#undef SINK_CASE
+}
+
+inline bool vertex_has_sink(const PlyElement &element, const Span<VertexSink> sinks)
+{
+  for (const PlyProperty &property : element.properties) {
+    if (sinks.contains(vertex_sink_from_property(property))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename T> inline uint8_t color_component_to_byte(const T value)
+{
+  if constexpr (std::is_floating_point_v<T>) {
+    return unit_float_to_uchar_clamp(float(value));
+  }
+  else if constexpr (std::is_same_v<T, uint16_t>) {
+    return uint8_t(value >> 8);
+  }
+  else {
+    return uint8_t(std::clamp<int64_t>(int64_t(value), 0, 255));
+  }
+}
+
+/** \} */
+
+}  // namespace blender::io::ply
@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <charconv>
+
+#include "ply_import_header.hh"
+
+namespace blender::io::ply {
+
+static PlyDataType data_type_from_string(StringRef name)
+{
+  if (ELEM(name, "char", "int8")) {
+    return PlyDataType::Char;
+  }
+  if (ELEM(name, "uchar", "uint8")) {
+    return PlyDataType::UChar;
+  }
+  if (ELEM(name, "short", "int16")) {
+    return PlyDataType::Short;
+  }
+  if (ELEM(name, "ushort", "uint16")) {
+    return PlyDataType::UShort;
+  }
+  if (ELEM(name, "int", "int32")) {
+    return PlyDataType::Int;
+  }
+  if (ELEM(name, "uint", "uint32")) {
+    return PlyDataType::UInt;
+  }
+  if (ELEM(name, "float", "float32")) {
+    return PlyDataType::Float;
+  }
+  if (ELEM(name, "double", "float64")) {
+    return PlyDataType::Double;
+  }
+  return PlyDataType::None;
+}
+
+/** Split off the next white-space separated word of the line. */
+static StringRef next_word(StringRef &line)
+{
+  line = line.trim();
+  int64_t end = line.find_first_of(" \t");
+  if (end == StringRef::not_found) {
+    end = line.size();
+  }
+  const StringRef word = line.substr(0, end);
+  line = line.drop_prefix(end);
+  return word;
+}
+
+const char *read_header(StringRef buffer, PlyHeader &r_header)
+{
+  const char *buffer_start = buffer.data();
+  bool is_first_line = true;
+  bool has_format = false;
+  while (!buffer.is_empty()) {
+    const int64_t newline = buffer.find('\n');
+    if (newline == StringRef::not_found) {
+      break;
+    }
+    StringRef line = buffer.substr(0, newline);
+    buffer = buffer.drop_prefix(newline + 1);
+    /* Windows line endings. */
+    if (line.endswith("\r")) {
+      line = line.drop_suffix(1);
+    }
+
+    const StringRef keyword = next_word(line);
+    if (is_first_line) {
+      if (keyword != "ply") {
+        return "Not a PLY file";
+      }
+      is_first_line = false;
+      continue;
+    }
+    if (keyword == "format") {
+      const StringRef format = next_word(line);
+      if (format == "ascii") {
+        r_header.format = PlyFormat::Ascii;
+      }
+      else if (format == "binary_little_endian") {
+        r_header.format = PlyFormat::BinaryLittleEndian;
+      }
+      else if (format == "binary_big_endian") {
+        r_header.format = PlyFormat::BinaryBigEndian;
+      }
+      else {
+        return "Unknown PLY format";
+      }
+      has_format = true;
+    }
+    else if (keyword == "element") {
+      PlyElement element;
+      element.name = next_word(line);
+      const StringRef count_str = next_word(line);
+      const std::from_chars_result res = std::from_chars(
+          count_str.begin(), count_str.end(), element.count);
+      if (res.ec != std::errc() || element.count < 0) {
+        return "Invalid PLY element count";
+      }
+      r_header.elements.append(std::move(element));
+    }
+    else if (keyword == "property") {
+      if (r_header.elements.is_empty()) {
+        return "PLY property defined outside of an element";
+      }
+      PlyProperty property;
+      StringRef type = next_word(line);
+      if (type == "list") {
+        property.count_type = data_type_from_string(next_word(line));
+        if (property.count_type == PlyDataType::None) {
+          return "Unknown PLY list count type";
+        }
+        type = next_word(line);
+      }
+      property.type = data_type_from_string(type);
+      if (property.type == PlyDataType::None) {
+        return "Unknown PLY property type";
+      }
+      property.name = next_word(line);
+      r_header.elements.last().properties.append(std::move(property));
+    }
+    else if (keyword == "end_header") {
+      if (!has_format) {
+        return "PLY header has no format";
+      }
+      r_header.header_size = buffer.data() - buffer_start;
+      return nullptr;
+    }
+    /* Other lines like `comment` and `obj_info` are ignored. */
+  }
+  return "PLY header has no end";
+}
+
+}  // namespace blender::io::ply
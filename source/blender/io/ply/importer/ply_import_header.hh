@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#pragma once
+
+#include "ply_data.hh"
+
+namespace blender::io::ply {
+
+/**
+ * Parse the ASCII header at the start of a PLY file.
+ *
+ * \return An error message, or nullptr when the header is valid.
+ */
+const char *read_header(StringRef buffer, PlyHeader &r_header);
+
+}  // namespace blender::io::ply
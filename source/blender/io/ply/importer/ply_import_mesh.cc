@@ -0,0 +1,603 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include "BKE_attribute.h"
+#include "BKE_attribute.hh"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_array.hh"
+#include "BLI_color.hh"
+#include "BLI_endian_defines.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "ply_import_data.hh"
+#include "ply_import_mesh.hh"
+
+namespace blender::io::ply {
+
+/* -------------------------------------------------------------------- */
+/** \name Vertex Properties
+ * \{ */
+
+/** Destination arrays of the vertex properties. */
+struct VertexData {
+  MutableSpan<float3> positions;
+  Array<float3> normals;
+  MutableSpan<ColorGeometry4b> colors;
+  Array<float2> uvs;
+};
+
+template<VertexSink Sink, typename T>
+inline void store_vertex_value(VertexData &data, const int64_t i, const T value)
+{
+  if constexpr (Sink == VertexSink::PositionX) {
+    data.positions[i].x = float(value);
+  }
+  else if constexpr (Sink == VertexSink::PositionY) {
+    data.positions[i].y = float(value);
+  }
+  else if constexpr (Sink == VertexSink::PositionZ) {
+    data.positions[i].z = float(value);
+  }
+  else if constexpr (Sink == VertexSink::NormalX) {
+    data.normals[i].x = float(value);
+  }
+  else if constexpr (Sink == VertexSink::NormalY) {
+    data.normals[i].y = float(value);
+  }
+  else if constexpr (Sink == VertexSink::NormalZ) {
+    data.normals[i].z = float(value);
+  }
+  else if constexpr (Sink == VertexSink::ColorR) {
+    data.colors[i].r = color_component_to_byte(value);
+  }
+  else if constexpr (Sink == VertexSink::ColorG) {
+    data.colors[i].g = color_component_to_byte(value);
+  }
+  else if constexpr (Sink == VertexSink::ColorB) {
+    data.colors[i].b = color_component_to_byte(value);
+  }
+  else if constexpr (Sink == VertexSink::ColorA) {
+    data.colors[i].a = color_component_to_byte(value);
+  }
+  else if constexpr (Sink == VertexSink::U) {
+    data.uvs[i].x = float(value);
+  }
+  else if constexpr (Sink == VertexSink::V) {
+    data.uvs[i].y = float(value);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Creation
+ * \{ */
+
+/**
+ * Decode binary vertex records, starting at the first vertex of the batch.
+ */
+static void read_binary_vertices(const PlyElement &element,
+                                 const char *records,
+                                 const IndexRange batch,
+                                 const bool swap,
+                                 VertexData &vertex_data)
+{
+  const int64_t stride = element.binary_stride();
+  int64_t property_offset = 0;
+  for (const PlyProperty &property : element.properties) {
+    with_vertex_sink(vertex_sink_from_property(property), [&](auto sink) {
+      read_binary_column(records + property_offset,
+                         stride,
+                         batch.size(),
+                         property.type,
+                         swap,
+                         [&](const int64_t i, const auto value) {
+                           store_vertex_value<decltype(sink)::value>(
+                               vertex_data, batch[i], value);
+                         });
+    });
+    property_offset += ply_data_type_size(property.type);
+  }
+}
+
+/** Find out which optional vertex data the element contains. */
+static void vertex_data_init(const PlyElement &element,
+                             const int verts_num,
+                             VertexData &vertex_data,
+                             bool &r_has_normals,
+                             bool &r_has_colors,
+                             bool &r_has_uvs)
+{
+  r_has_normals = vertex_has_sink(
+      element, {VertexSink::NormalX, VertexSink::NormalY, VertexSink::NormalZ});
+  r_has_colors = vertex_has_sink(element,
+                                 {VertexSink::ColorR, VertexSink::ColorG, VertexSink::ColorB});
+  r_has_uvs = vertex_has_sink(element, {VertexSink::U, VertexSink::V});
+  if (r_has_normals) {
+    vertex_data.normals.reinitialize(verts_num);
+    vertex_data.normals.fill(float3(0.0f));
+  }
+  if (r_has_uvs) {
+    vertex_data.uvs.reinitialize(verts_num);
+    vertex_data.uvs.fill(float2(0.0f));
+  }
+}
+
+/**
+ * Decode the corner vertex indices of all faces.
+ * \return False if a face references a vertex that does not exist.
+ */
+static bool read_binary_face_loops(const char *data,
+                                   const PlyDataType index_type,
+                                   const Span<std::pair<int64_t, int>> lists,
+                                   const bool swap,
+                                   const int verts_num,
+                                   MutableSpan<MPoly> polys,
+                                   MutableSpan<MLoop> loops)
+{
+  int loop_start = 0;
+  for (const int i : polys.index_range()) {
+    polys[i].loopstart = loop_start;
+    polys[i].totloop = lists[i].second;
+    loop_start += lists[i].second;
+  }
+
+  const int64_t index_size = ply_data_type_size(index_type);
+  bool all_valid = true;
+  with_binary_loader(index_type, swap, [&](auto loader) {
+    using Loader = decltype(loader);
+    all_valid = threading::parallel_reduce(
+        polys.index_range(),
+        4096,
+        true,
+        [&](const IndexRange range, bool valid) {
+          for (const int i : range) {
+            const char *list = data + lists[i].first;
+            MLoop *poly_loops = &loops[polys[i].loopstart];
+            for (int j = 0; j < polys[i].totloop; j++) {
+              const int64_t vert = value_to_index(Loader::load(list + j * index_size));
+              if (vert < 0 || vert >= verts_num) {
+                valid = false;
+                poly_loops[j].v = 0;
+                continue;
+              }
+              poly_loops[j].v = uint(vert);
+            }
+          }
+          return valid;
+        },
+        [](const bool a, const bool b) { return a && b; });
+  });
+  return all_valid;
+}
+
+/**
+ * Decode the vertex indices of binary edge records, starting at the first edge of the batch.
+ */
+static void read_binary_edges(const PlyElement &element,
+                              const char *records,
+                              const IndexRange batch,
+                              const bool swap,
+                              MutableSpan<MEdge> edges)
+{
+  const int64_t stride = element.binary_stride();
+  int64_t property_offset = 0;
+  for (const PlyProperty &property : element.properties) {
+    if (ELEM(property.name, "vertex1", "vertex2")) {
+      const bool is_first = property.name == "vertex1";
+      read_binary_column(records + property_offset,
+                         stride,
+                         batch.size(),
+                         property.type,
+                         swap,
+                         [&](const int64_t i, const auto value) {
+                           MEdge &edge = edges[batch[i]];
+                           (is_first ? edge.v1 : edge.v2) = uint(value_to_index(value));
+                         });
+    }
+    property_offset += ply_data_type_size(property.type);
+  }
+}
+
+static bool edges_are_valid(const Span<MEdge> edges, const int verts_num)
+{
+  for (const MEdge &edge : edges) {
+    if (edge.v1 >= verts_num || edge.v2 >= verts_num) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool is_edge_element(const PlyElement &element)
+{
+  return element.name == "edge" && element.find_property("vertex1") != -1 &&
+         element.find_property("vertex2") != -1 && element.binary_stride() >= 0;
+}
+
+/** \return Index of the list property with the vertex indices of a face element, or -1. */
+static int face_indices_property(const PlyElement &element)
+{
+  int index = element.find_property("vertex_indices");
+  if (index == -1) {
+    index = element.find_property("vertex_index");
+  }
+  if (index == -1 || !element.properties[index].is_list()) {
+    return -1;
+  }
+  return index;
+}
+
+/**
+ * Add the vertex data that is not part of the mesh topology, once the topology is complete.
+ */
+static void mesh_finish(Mesh *mesh,
+                        VertexData &vertex_data,
+                        const bool use_edges,
+                        bke::SpanAttributeWriter<ColorGeometry4b> &colors)
+{
+  BKE_mesh_calc_edges(mesh, use_edges, false);
+
+  if (colors) {
+    colors.finish();
+    BKE_id_attributes_active_color_set(&mesh->id, "Col");
+    BKE_id_attributes_default_color_set(&mesh->id, "Col");
+  }
+  if (!vertex_data.uvs.is_empty() && mesh->totloop > 0) {
+    const Span<MLoop> loops = mesh->loops();
+    bke::MutableAttributeAccessor attributes = mesh->attributes_for_write();
+    bke::SpanAttributeWriter<float2> uv_map =
+        attributes.lookup_or_add_for_write_only_span<float2>("UVMap", ATTR_DOMAIN_CORNER);
+    threading::parallel_for(loops.index_range(), 8192, [&](const IndexRange range) {
+      for (const int i : range) {
+        uv_map.span[i] = vertex_data.uvs[loops[i].v];
+      }
+    });
+    uv_map.finish();
+  }
+  /* Custom normals are stored on face corners, so they can only be set when there are faces. */
+  if (!vertex_data.normals.is_empty() && mesh->totpoly > 0) {
+    BKE_mesh_set_custom_normals_from_verts(
+        mesh, reinterpret_cast<float(*)[3]>(vertex_data.normals.data()));
+    mesh->flag |= ME_AUTOSMOOTH;
+  }
+}
+
+static Mesh *read_binary_mesh(const Span<PlyElement> elements,
+                              const Span<char> data,
+                              const bool swap,
+                              const char *&r_error)
+{
+  const PlyElement *vertex_element = nullptr;
+  const PlyElement *face_element = nullptr;
+  const PlyElement *edge_element = nullptr;
+  int64_t vertex_offset = 0, edge_offset = 0;
+  int face_indices = -1;
+  /* Position and size of the vertex index list of every face. */
+  Vector<std::pair<int64_t, int>> face_lists;
+
+  int64_t offset = 0;
+  for (const PlyElement &element : elements) {
+    const int64_t element_offset = offset;
+    if (element.name == "vertex" && vertex_element == nullptr) {
+      if (element.binary_stride() < 0) {
+        r_error = "PLY vertices with list properties are not supported";
+        return nullptr;
+      }
+      vertex_element = &element;
+      vertex_offset = element_offset;
+      offset = skip_binary_element(element, data, offset, swap);
+    }
+    else if (element.name == "face" && face_element == nullptr &&
+             face_indices_property(element) != -1) {
+      face_element = &element;
+      face_indices = face_indices_property(element);
+      face_lists.reserve(std::min<int64_t>(element.count, data.size()));
+      offset = scan_binary_records(element, data, offset, swap, face_indices, &face_lists);
+    }
+    else if (edge_element == nullptr && is_edge_element(element)) {
+      edge_element = &element;
+      edge_offset = element_offset;
+      offset = skip_binary_element(element, data, offset, swap);
+    }
+    else {
+      offset = skip_binary_element(element, data, offset, swap);
+    }
+    if (offset < 0 || offset > data.size()) {
+      r_error = "PLY file is truncated";
+      return nullptr;
+    }
+  }
+  if (vertex_element == nullptr) {
+    r_error = "PLY file has no vertices";
+    return nullptr;
+  }
+  if (vertex_element->count > INT32_MAX) {
+    r_error = "PLY file has too many vertices";
+    return nullptr;
+  }
+  if (edge_element && edge_element->count > INT32_MAX) {
+    r_error = "PLY file has too many edges";
+    return nullptr;
+  }
+
+  /* Faces with fewer than three corners cannot be represented in a mesh. */
+  face_lists.remove_if([](const std::pair<int64_t, int> &list) { return list.second < 3; });
+  int64_t loops_num = 0;
+  for (const std::pair<int64_t, int> &list : face_lists) {
+    loops_num += list.second;
+  }
+  if (loops_num > INT32_MAX) {
+    r_error = "PLY file has too many faces";
+    return nullptr;
+  }
+
+  const int verts_num = int(vertex_element->count);
+  const int edges_num = edge_element ? int(edge_element->count) : 0;
+  Mesh *mesh = BKE_mesh_new_nomain(
+      verts_num, edges_num, 0, int(loops_num), int(face_lists.size()));
+
+  VertexData vertex_data;
+  vertex_data.positions = mesh->vert_positions_for_write();
+  vertex_data.positions.fill(float3(0.0f));
+  bool has_normals, has_colors, has_uvs;
+  vertex_data_init(*vertex_element, verts_num, vertex_data, has_normals, has_colors, has_uvs);
+  bke::SpanAttributeWriter<ColorGeometry4b> colors;
+  if (has_colors) {
+    bke::MutableAttributeAccessor attributes = mesh->attributes_for_write();
+    colors = attributes.lookup_or_add_for_write_only_span<ColorGeometry4b>("Col",
+                                                                          ATTR_DOMAIN_POINT);
+    colors.span.fill(ColorGeometry4b(0, 0, 0, 255));
+    vertex_data.colors = colors.span;
+  }
+  read_binary_vertices(*vertex_element,
+                       data.data() + vertex_offset,
+                       IndexRange(verts_num),
+                       swap,
+                       vertex_data);
+
+  bool valid = true;
+  if (face_element) {
+    valid &= read_binary_face_loops(data.data(),
+                                    face_element->properties[face_indices].type,
+                                    face_lists,
+                                    swap,
+                                    verts_num,
+                                    mesh->polys_for_write(),
+                                    mesh->loops_for_write());
+  }
+  if (edge_element) {
+    MutableSpan<MEdge> edges = mesh->edges_for_write();
+    read_binary_edges(
+        *edge_element, data.data() + edge_offset, IndexRange(edges_num), swap, edges);
+    valid &= edges_are_valid(edges, verts_num);
+  }
+  if (!valid) {
+    if (colors) {
+      colors.finish();
+    }
+    BKE_id_free(nullptr, mesh);
+    r_error = "PLY file references vertices that do not exist";
+    return nullptr;
+  }
+
+  mesh_finish(mesh, vertex_data, edge_element != nullptr, colors);
+  return mesh;
+}
+
+/**
+ * Amount of records that are converted from ASCII to binary at once. This bounds the size of
+ * the temporary binary buffer, rather than converting the whole file first.
+ */
+static const int64_t ascii_batch_size = 64 * 1024;
+
+/**
+ * Convert the records of an element to binary in batches, and pass each batch to `fn`.
+ * \return False if the text is invalid or truncated.
+ */
+template<typename Fn>
+static bool read_ascii_batches(AsciiDataReader &reader, const PlyElement &element, const Fn &fn)
+{
+  Vector<char> records;
+  for (int64_t start = 0; start < element.count; start += ascii_batch_size) {
+    const IndexRange batch(start, std::min(ascii_batch_size, element.count - start));
+    records.clear();
+    if (!reader.read_records(element, batch.size(), records)) {
+      return false;
+    }
+    fn(records.as_span(), batch);
+  }
+  return true;
+}
+
+/**
+ * Append the sizes and corner vertex indices of the faces in binary records. Faces with fewer
+ * than three corners are skipped.
+ * \return False if a vertex index is negative or too large.
+ */
+static bool append_face_loops(const char *data,
+                              const PlyDataType index_type,
+                              const Span<std::pair<int64_t, int>> lists,
+                              Vector<int> &r_face_sizes,
+                              Vector<int> &r_corner_verts)
+{
+  const int64_t index_size = ply_data_type_size(index_type);
+  bool valid = true;
+  with_binary_loader<false>(index_type, [&](auto loader) {
+    using Loader = decltype(loader);
+    for (const std::pair<int64_t, int> &list : lists) {
+      if (list.second < 3) {
+        continue;
+      }
+      r_face_sizes.append(list.second);
+      for (int j = 0; j < list.second; j++) {
+        const int64_t vert = value_to_index(Loader::load(data + list.first + j * index_size));
+        if (vert < 0 || vert > INT32_MAX) {
+          valid = false;
+          r_corner_verts.append(0);
+          continue;
+        }
+        r_corner_verts.append(int(vert));
+      }
+    }
+  });
+  return valid;
+}
+
+/**
+ * ASCII records are converted to binary and decoded one batch at a time. Since the amount of face
+ * corners is only known after reading all faces, the data is decoded into temporary arrays first
+ * and copied into the mesh afterwards.
+ */
+static Mesh *read_ascii_mesh(const Span<PlyElement> elements,
+                             const Span<char> text,
+                             const char *&r_error)
+{
+  AsciiDataReader reader(text);
+  const PlyElement *vertex_element = nullptr;
+  const PlyElement *face_element = nullptr;
+  const PlyElement *edge_element = nullptr;
+  VertexData vertex_data;
+  Array<float3> positions;
+  Array<ColorGeometry4b> vertex_colors;
+  bool has_normals = false, has_colors = false, has_uvs = false;
+  Vector<int> face_sizes;
+  Vector<int> corner_verts;
+  Array<MEdge> edges;
+  bool valid = true;
+
+  for (const PlyElement &element : elements) {
+    bool read_ok;
+    if (element.name == "vertex" && vertex_element == nullptr) {
+      if (element.binary_stride() < 0) {
+        r_error = "PLY vertices with list properties are not supported";
+        return nullptr;
+      }
+      if (element.count > INT32_MAX) {
+        r_error = "PLY file has too many vertices";
+        return nullptr;
+      }
+      vertex_element = &element;
+      positions.reinitialize(element.count);
+      positions.fill(float3(0.0f));
+      vertex_data.positions = positions;
+      vertex_data_init(
+          element, int(element.count), vertex_data, has_normals, has_colors, has_uvs);
+      if (has_colors) {
+        vertex_colors.reinitialize(element.count);
+        vertex_colors.fill(ColorGeometry4b(0, 0, 0, 255));
+        vertex_data.colors = vertex_colors;
+      }
+      read_ok = read_ascii_batches(
+          reader, element, [&](const Span<char> records, const IndexRange batch) {
+            read_binary_vertices(element, records.data(), batch, false, vertex_data);
+          });
+    }
+    else if (element.name == "face" && face_element == nullptr &&
+             face_indices_property(element) != -1) {
+      face_element = &element;
+      const int face_indices = face_indices_property(element);
+      const PlyDataType index_type = element.properties[face_indices].type;
+      PlyElement batch_element = element;
+      Vector<std::pair<int64_t, int>> lists;
+      read_ok = read_ascii_batches(
+          reader, element, [&](const Span<char> records, const IndexRange batch) {
+            batch_element.count = batch.size();
+            lists.clear();
+            /* The records were just converted, so they can't be truncated. */
+            scan_binary_records(batch_element, records, 0, false, face_indices, &lists);
+            valid &= append_face_loops(
+                records.data(), index_type, lists, face_sizes, corner_verts);
+          });
+    }
+    else if (edge_element == nullptr && is_edge_element(element)) {
+      if (element.count > INT32_MAX) {
+        r_error = "PLY file has too many edges";
+        return nullptr;
+      }
+      edge_element = &element;
+      edges.reinitialize(element.count);
+      edges.fill(MEdge{});
+      read_ok = read_ascii_batches(
+          reader, element, [&](const Span<char> records, const IndexRange batch) {
+            read_binary_edges(element, records.data(), batch, false, edges);
+          });
+    }
+    else {
+      read_ok = reader.skip_element(element);
+    }
+    if (!read_ok) {
+      r_error = "PLY file contains invalid ASCII data";
+      return nullptr;
+    }
+  }
+  if (vertex_element == nullptr) {
+    r_error = "PLY file has no vertices";
+    return nullptr;
+  }
+  if (corner_verts.size() > INT32_MAX) {
+    r_error = "PLY file has too many faces";
+    return nullptr;
+  }
+
+  const int verts_num = int(vertex_element->count);
+  for (const int vert : corner_verts) {
+    valid &= vert < verts_num;
+  }
+  valid &= edges_are_valid(edges, verts_num);
+  if (!valid) {
+    r_error = "PLY file references vertices that do not exist";
+    return nullptr;
+  }
+
+  Mesh *mesh = BKE_mesh_new_nomain(
+      verts_num, int(edges.size()), 0, int(corner_verts.size()), int(face_sizes.size()));
+  mesh->vert_positions_for_write().copy_from(positions);
+  mesh->edges_for_write().copy_from(edges);
+  MutableSpan<MPoly> polys = mesh->polys_for_write();
+  int loop_start = 0;
+  for (const int i : polys.index_range()) {
+    polys[i].loopstart = loop_start;
+    polys[i].totloop = face_sizes[i];
+    loop_start += face_sizes[i];
+  }
+  MutableSpan<MLoop> loops = mesh->loops_for_write();
+  threading::parallel_for(loops.index_range(), 8192, [&](const IndexRange range) {
+    for (const int i : range) {
+      loops[i].v = uint(corner_verts[i]);
+    }
+  });
+
+  bke::SpanAttributeWriter<ColorGeometry4b> colors;
+  if (has_colors) {
+    bke::MutableAttributeAccessor attributes = mesh->attributes_for_write();
+    colors = attributes.lookup_or_add_for_write_only_span<ColorGeometry4b>("Col",
+                                                                          ATTR_DOMAIN_POINT);
+    colors.span.copy_from(vertex_colors);
+  }
+  mesh_finish(mesh, vertex_data, edge_element != nullptr, colors);
+  return mesh;
+}
+
+/** \} */
+
+Mesh *read_mesh(const PlyHeader &header, const Span<char> data, const char *&r_error)
+{
+  if (header.format == PlyFormat::Ascii) {
+    return read_ascii_mesh(header.elements, data, r_error);
+  }
+  const PlyFormat native_format = ENDIAN_ORDER == L_ENDIAN ? PlyFormat::BinaryLittleEndian :
+                                                             PlyFormat::BinaryBigEndian;
+  return read_binary_mesh(header.elements, data, header.format != native_format, r_error);
+}
+
+}  // namespace blender::io::ply
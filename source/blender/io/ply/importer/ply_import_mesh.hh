@@ -0,0 +1,26 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#pragma once
+
+#include "BLI_span.hh"
+
+#include "ply_data.hh"
+
+struct Mesh;
+
+namespace blender::io::ply {
+
+/**
+ * Decode the vertex, face and edge elements that follow the header into a new mesh that is not
+ * in #Main. Binary data is decoded property by property, directly into the mesh arrays.
+ *
+ * \param data: The file contents after the header.
+ * \return The mesh, or nullptr with an error message in `r_error`.
+ */
+Mesh *read_mesh(const PlyHeader &header, Span<char> data, const char *&r_error);
+
+}  // namespace blender::io::ply
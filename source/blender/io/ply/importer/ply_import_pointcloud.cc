@@ -0,0 +1,211 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include "BKE_attribute.h"
+#include "BKE_attribute.hh"
+#include "BKE_lib_id.h"
+#include "BKE_pointcloud.h"
+
+#include "BLI_color.hh"
+#include "BLI_endian_defines.h"
+#include "BLI_math_vector_types.hh"
+
+#include "DNA_pointcloud_types.h"
+
+#include "ply_import_data.hh"
+#include "ply_import_pointcloud.hh"
+
+namespace blender::io::ply {
+
+/**
+ * Amount of vertices that are decoded at once. ASCII files are converted to binary one batch
+ * at a time, so this also bounds the size of the temporary buffer.
+ */
+static const int64_t points_batch_size = 1024 * 1024;
+
+/** Destination arrays of the vertex properties. */
+struct PointData {
+  MutableSpan<float3> positions;
+  MutableSpan<float> radii;
+  MutableSpan<ColorGeometry4b> colors;
+};
+
+template<VertexSink Sink, typename T>
+inline void store_point_value(PointData &data, const int64_t i, const T value)
+{
+  if constexpr (Sink == VertexSink::PositionX) {
+    data.positions[i].x = float(value);
+  }
+  else if constexpr (Sink == VertexSink::PositionY) {
+    data.positions[i].y = float(value);
+  }
+  else if constexpr (Sink == VertexSink::PositionZ) {
+    data.positions[i].z = float(value);
+  }
+  else if constexpr (Sink == VertexSink::ColorR) {
+    data.colors[i].r = color_component_to_byte(value);
+  }
+  else if constexpr (Sink == VertexSink::ColorG) {
+    data.colors[i].g = color_component_to_byte(value);
+  }
+  else if constexpr (Sink == VertexSink::ColorB) {
+    data.colors[i].b = color_component_to_byte(value);
+  }
+  else if constexpr (Sink == VertexSink::ColorA) {
+    data.colors[i].a = color_component_to_byte(value);
+  }
+  else if constexpr (Sink == VertexSink::Radius) {
+    data.radii[i] = float(value);
+  }
+}
+
+/**
+ * Decode a batch of binary vertex records, starting at the given point index.
+ */
+static void read_binary_points(const PlyElement &element,
+                               const char *records,
+                               const IndexRange batch,
+                               const bool swap,
+                               PointData &point_data)
+{
+  const int64_t stride = element.binary_stride();
+  int64_t property_offset = 0;
+  for (const PlyProperty &property : element.properties) {
+    with_vertex_sink(vertex_sink_from_property(property), [&](auto sink) {
+      read_binary_column(records + property_offset,
+                         stride,
+                         batch.size(),
+                         property.type,
+                         swap,
+                         [&](const int64_t i, const auto value) {
+                           store_point_value<decltype(sink)::value>(
+                               point_data, batch[i], value);
+                         });
+    });
+    property_offset += ply_data_type_size(property.type);
+  }
+}
+
+PointCloud *read_point_cloud(const PlyHeader &header, const Span<char> data, const char *&r_error)
+{
+  const bool is_ascii = header.format == PlyFormat::Ascii;
+  const PlyFormat native_format = ENDIAN_ORDER == L_ENDIAN ? PlyFormat::BinaryLittleEndian :
+                                                             PlyFormat::BinaryBigEndian;
+  /* ASCII data is converted to binary in native byte order. */
+  const bool swap = !is_ascii && header.format != native_format;
+
+  /* Find the vertex element, skipping over the elements in front of it. */
+  AsciiDataReader ascii_reader(data);
+  const PlyElement *vertex_element = nullptr;
+  int64_t offset = 0;
+  for (const PlyElement &element : header.elements) {
+    if (element.name == "vertex") {
+      vertex_element = &element;
+      break;
+    }
+    if (is_ascii) {
+      if (!ascii_reader.skip_element(element)) {
+        r_error = "PLY file contains invalid ASCII data";
+        return nullptr;
+      }
+    }
+    else {
+      offset = skip_binary_element(element, data, offset, swap);
+      if (offset < 0 || offset > data.size()) {
+        r_error = "PLY file is truncated";
+        return nullptr;
+      }
+    }
+  }
+  if (vertex_element == nullptr) {
+    r_error = "PLY file has no vertices";
+    return nullptr;
+  }
+  if (vertex_element->count > INT32_MAX) {
+    r_error = "PLY file has too many vertices";
+    return nullptr;
+  }
+  const int64_t stride = vertex_element->binary_stride();
+  if (stride < 0) {
+    r_error = "PLY vertices with list properties are not supported";
+    return nullptr;
+  }
+  if (!is_ascii && offset + stride * vertex_element->count > data.size()) {
+    r_error = "PLY file is truncated";
+    return nullptr;
+  }
+
+  const int points_num = int(vertex_element->count);
+  PointCloud *pointcloud = BKE_pointcloud_new_nomain(points_num);
+  bke::MutableAttributeAccessor attributes = pointcloud->attributes_for_write();
+
+  const bool has_all_positions = vertex_element->find_property("x") != -1 &&
+                                 vertex_element->find_property("y") != -1 &&
+                                 vertex_element->find_property("z") != -1;
+  PointData point_data;
+  bke::SpanAttributeWriter<float3> positions = attributes.lookup_for_write_span<float3>(
+      POINTCLOUD_ATTR_POSITION);
+  point_data.positions = positions.span;
+  /* Only add the optional attributes when the file has them, to avoid using more memory. */
+  bke::SpanAttributeWriter<float> radii;
+  if (vertex_has_sink(*vertex_element, {VertexSink::Radius})) {
+    radii = attributes.lookup_or_add_for_write_only_span<float>(POINTCLOUD_ATTR_RADIUS,
+                                                                ATTR_DOMAIN_POINT);
+    point_data.radii = radii.span;
+  }
+  bke::SpanAttributeWriter<ColorGeometry4b> colors;
+  const bool has_colors = vertex_has_sink(
+      *vertex_element, {VertexSink::ColorR, VertexSink::ColorG, VertexSink::ColorB});
+  if (has_colors) {
+    colors = attributes.lookup_or_add_for_write_only_span<ColorGeometry4b>("Col",
+                                                                          ATTR_DOMAIN_POINT);
+    point_data.colors = colors.span;
+  }
+
+  Vector<char> ascii_batch;
+  bool valid = true;
+  for (int64_t start = 0; start < points_num; start += points_batch_size) {
+    const IndexRange batch(start, std::min<int64_t>(points_batch_size, points_num - start));
+    /* New attribute values are not initialized, so fill components the file does not have. */
+    if (!has_all_positions) {
+      point_data.positions.slice(batch).fill(float3(0.0f));
+    }
+    if (has_colors) {
+      point_data.colors.slice(batch).fill(ColorGeometry4b(0, 0, 0, 255));
+    }
+    const char *records;
+    if (is_ascii) {
+      ascii_batch.clear();
+      if (!ascii_reader.read_records(*vertex_element, batch.size(), ascii_batch)) {
+        valid = false;
+        break;
+      }
+      records = ascii_batch.data();
+    }
+    else {
+      records = data.data() + offset + batch.start() * stride;
+    }
+    read_binary_points(*vertex_element, records, batch, swap, point_data);
+  }
+
+  positions.finish();
+  if (radii) {
+    radii.finish();
+  }
+  if (colors) {
+    colors.finish();
+    BKE_id_attributes_active_color_set(&pointcloud->id, "Col");
+    BKE_id_attributes_default_color_set(&pointcloud->id, "Col");
+  }
+  if (!valid) {
+    BKE_id_free(nullptr, pointcloud);
+    r_error = "PLY file contains invalid ASCII data";
+    return nullptr;
+  }
+  return pointcloud;
+}
+
+}  // namespace blender::io::ply
@@ -0,0 +1,27 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#pragma once
+
+#include "BLI_span.hh"
+
+#include "ply_data.hh"
+
+struct PointCloud;
+
+namespace blender::io::ply {
+
+/**
+ * Decode the vertex element into a new point cloud that is not in #Main. Faces and edges are
+ * ignored. Vertices are streamed into the point cloud attributes in fixed-size batches, so
+ * ASCII files never need a full binary copy of the data.
+ *
+ * \param data: The file contents after the header.
+ * \return The point cloud, or nullptr with an error message in `r_error`.
+ */
+PointCloud *read_point_cloud(const PlyHeader &header, Span<char> data, const char *&r_error);
+
+}  // namespace blender::io::ply
@@ -0,0 +1,108 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup ply
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+
+namespace blender::io::ply {
+
+enum class PlyFormat {
+  Ascii,
+  BinaryLittleEndian,
+  BinaryBigEndian,
+};
+
+enum class PlyDataType {
+  None,
+  Char,
+  UChar,
+  Short,
+  UShort,
+  Int,
+  UInt,
+  Float,
+  Double,
+};
+
+/**
+ * Size in bytes of a value of the given type in binary files.
+ */
+inline int64_t ply_data_type_size(const PlyDataType type)
+{
+  switch (type) {
+    case PlyDataType::None:
+      return 0;
+    case PlyDataType::Char:
+    case PlyDataType::UChar:
+      return 1;
+    case PlyDataType::Short:
+    case PlyDataType::UShort:
+      return 2;
+    case PlyDataType::Int:
+    case PlyDataType::UInt:
+    case PlyDataType::Float:
+      return 4;
+    case PlyDataType::Double:
+      return 8;
+  }
+  return 0;
+}
+
+struct PlyProperty {
+  std::string name;
+  PlyDataType type = PlyDataType::None;
+  /** Type of the element count for list properties, #PlyDataType::None for scalars. */
+  PlyDataType count_type = PlyDataType::None;
+
+  bool is_list() const
+  {
+    return count_type != PlyDataType::None;
+  }
+};
+
+struct PlyElement {
+  std::string name;
+  int64_t count = 0;
+  Vector<PlyProperty> properties;
+
+  /** Index of the property with the given name, or -1. */
+  int find_property(StringRef property_name) const
+  {
+    for (const int i : properties.index_range()) {
+      if (properties[i].name == property_name) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  /** Size in bytes of one binary record, or -1 when the element contains lists. */
+  int64_t binary_stride() const
+  {
+    int64_t stride = 0;
+    for (const PlyProperty &property : properties) {
+      if (property.is_list()) {
+        return -1;
+      }
+      stride += ply_data_type_size(property.type);
+    }
+    return stride;
+  }
+};
+
+struct PlyHeader {
+  PlyFormat format = PlyFormat::Ascii;
+  Vector<PlyElement> elements;
+  /** Size of the header in bytes, including the trailing `end_header` line. */
+  int64_t header_size = 0;
+};
+
+}  // namespace blender::io::ply
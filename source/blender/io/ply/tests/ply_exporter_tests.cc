@@ -0,0 +1,170 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include "testing/testing.h"
+#include "tests/blendfile_loading_base_test.h"
+
+#include "BKE_appdir.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_fileops.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "ply_export.hh"
+#include "ply_import_header.hh"
+#include "ply_import_mesh.hh"
+
+namespace blender::io::ply {
+
+/* The base class is only used to initialize just enough of Blender to create meshes. */
+class ply_exporter_test : public BlendfileLoadingBaseTest {
+ public:
+  /** Create a mesh with a single quad in the XY plane, facing +Z. */
+  static Mesh *create_quad_mesh()
+  {
+    Mesh *mesh = BKE_mesh_new_nomain(4, 0, 0, 4, 1);
+    MutableSpan<float3> positions = mesh->vert_positions_for_write();
+    positions[0] = float3(0, 0, 0);
+    positions[1] = float3(1, 0, 0);
+    positions[2] = float3(1, 1, 0);
+    positions[3] = float3(0, 1, 0);
+    MutableSpan<MPoly> polys = mesh->polys_for_write();
+    polys[0].loopstart = 0;
+    polys[0].totloop = 4;
+    MutableSpan<MLoop> loops = mesh->loops_for_write();
+    for (const int i : loops.index_range()) {
+      loops[i].v = i;
+      loops[i].e = 0;
+    }
+    BKE_mesh_calc_edges(mesh, false, false);
+    return mesh;
+  }
+
+  /** Export the meshes and import the file again as a single mesh. */
+  static Mesh *export_and_import(const Span<ExportMesh> meshes, const bool export_normals)
+  {
+    PLYExportParams params{};
+    BLI_path_join(
+        params.filepath, sizeof(params.filepath), BKE_tempdir_base(), "io_ply_exporter.ply");
+    params.export_normals = export_normals;
+    write_meshes(meshes, params);
+
+    size_t size = 0;
+    char *data = static_cast<char *>(BLI_file_read_binary_as_mem(params.filepath, 0, &size));
+    BLI_delete(params.filepath, false, false);
+    EXPECT_NE(data, nullptr);
+    if (data == nullptr) {
+      return nullptr;
+    }
+    const StringRef file(data, int64_t(size));
+    PlyHeader header;
+    const char *error = read_header(file, header);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_EQ(header.format, PlyFormat::BinaryLittleEndian);
+    Mesh *mesh = nullptr;
+    if (error == nullptr) {
+      mesh = read_mesh(header, Span<char>(data, int64_t(size)).drop_front(header.header_size),
+                       error);
+      EXPECT_EQ(error, nullptr);
+    }
+    MEM_freeN(data);
+    return mesh;
+  }
+};
+
+TEST_F(ply_exporter_test, round_trip)
+{
+  Mesh *mesh = create_quad_mesh();
+  float transform[4][4];
+  unit_m4(transform);
+  transform[0][0] = 2.0f;
+  transform[3][2] = 5.0f;
+  ExportMesh export_mesh{};
+  export_mesh.mesh = mesh;
+  export_mesh.set_transform(transform);
+
+  Mesh *result = export_and_import({&export_mesh, 1}, false);
+  ASSERT_NE(result, nullptr);
+  ASSERT_EQ(result->totvert, 4);
+  ASSERT_EQ(result->totpoly, 1);
+  ASSERT_EQ(result->totloop, 4);
+  EXPECT_EQ(result->totedge, 4);
+  const Span<float3> positions = result->vert_positions();
+  EXPECT_EQ(positions[0], float3(0, 0, 5));
+  EXPECT_EQ(positions[1], float3(2, 0, 5));
+  EXPECT_EQ(positions[2], float3(2, 1, 5));
+  EXPECT_EQ(positions[3], float3(0, 1, 5));
+  const Span<MLoop> loops = result->loops();
+  for (const int i : loops.index_range()) {
+    EXPECT_EQ(loops[i].v, i);
+  }
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(ply_exporter_test, round_trip_multiple_meshes)
+{
+  Mesh *mesh = create_quad_mesh();
+  float transform[4][4];
+  unit_m4(transform);
+  ExportMesh export_meshes[2] = {};
+  export_meshes[0].mesh = mesh;
+  export_meshes[0].set_transform(transform);
+  transform[3][0] = 3.0f;
+  export_meshes[1].mesh = mesh;
+  export_meshes[1].set_transform(transform);
+
+  Mesh *result = export_and_import({export_meshes, 2}, true);
+  ASSERT_NE(result, nullptr);
+  ASSERT_EQ(result->totvert, 8);
+  ASSERT_EQ(result->totpoly, 2);
+  EXPECT_EQ(result->vert_positions()[5], float3(4, 0, 0));
+  /* The vertex indices of the second mesh are offset by the vertices of the first. */
+  EXPECT_EQ(result->loops()[4].v, 4);
+  EXPECT_EQ(result->loops()[7].v, 7);
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(ply_exporter_test, negative_scale_flips_winding)
+{
+  Mesh *mesh = create_quad_mesh();
+  /* Mirror on the X axis. Without flipping the winding, the face would point to -Z. */
+  float transform[4][4];
+  unit_m4(transform);
+  transform[0][0] = -1.0f;
+  ExportMesh export_mesh{};
+  export_mesh.mesh = mesh;
+  export_mesh.set_transform(transform);
+  EXPECT_TRUE(export_mesh.flip_winding);
+
+  Mesh *result = export_and_import({&export_mesh, 1}, false);
+  ASSERT_NE(result, nullptr);
+  ASSERT_EQ(result->totloop, 4);
+  const Span<MLoop> loops = result->loops();
+  EXPECT_EQ(loops[0].v, 3);
+  EXPECT_EQ(loops[1].v, 2);
+  EXPECT_EQ(loops[2].v, 1);
+  EXPECT_EQ(loops[3].v, 0);
+  float3 normal;
+  BKE_mesh_calc_poly_normal(
+      &result->polys()[0], &loops[0], BKE_mesh_vert_positions(result), normal);
+  EXPECT_EQ(normal, float3(0, 0, 1));
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::io::ply
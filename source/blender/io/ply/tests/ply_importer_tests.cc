@@ -0,0 +1,318 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "testing/testing.h"
+#include "tests/blendfile_loading_base_test.h"
+
+#include "BKE_attribute.hh"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_color.hh"
+#include "BLI_endian_defines.h"
+#include "BLI_math_vector_types.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "ply_import_header.hh"
+#include "ply_import_mesh.hh"
+
+namespace blender::io::ply {
+
+/* The base class is only used to initialize just enough of Blender to create meshes. */
+class ply_importer_test : public BlendfileLoadingBaseTest {
+ public:
+  /** Parse the header and decode the mesh. Fails the test if the header is invalid. */
+  static Mesh *import_mesh(const std::string &file, const char *&r_error)
+  {
+    PlyHeader header;
+    r_error = read_header(file, header);
+    EXPECT_EQ(r_error, nullptr);
+    if (r_error != nullptr) {
+      return nullptr;
+    }
+    const Span<char> data = Span<char>(file.data(), int64_t(file.size()))
+                                .drop_front(header.header_size);
+    return read_mesh(header, data, r_error);
+  }
+
+  /** Check that the mesh contains the square that is stored in all test files. */
+  static void check_square_mesh(const Mesh &mesh)
+  {
+    ASSERT_EQ(mesh.totvert, 4);
+    ASSERT_EQ(mesh.totpoly, 2);
+    ASSERT_EQ(mesh.totloop, 6);
+    EXPECT_EQ(mesh.totedge, 5);
+    const Span<float3> positions = mesh.vert_positions();
+    EXPECT_EQ(positions[0], float3(0, 0, 0));
+    EXPECT_EQ(positions[1], float3(1, 0, 0));
+    EXPECT_EQ(positions[2], float3(1, 1, 0));
+    EXPECT_EQ(positions[3], float3(0, 1, -0.5f));
+    const Span<MPoly> polys = mesh.polys();
+    const Span<MLoop> loops = mesh.loops();
+    const int expected_verts[6] = {0, 1, 2, 0, 2, 3};
+    for (const int i : IndexRange(6)) {
+      EXPECT_EQ(loops[i].v, expected_verts[i]);
+    }
+    EXPECT_EQ(polys[0].loopstart, 0);
+    EXPECT_EQ(polys[0].totloop, 3);
+    EXPECT_EQ(polys[1].loopstart, 3);
+    EXPECT_EQ(polys[1].totloop, 3);
+  }
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Test Files
+ * \{ */
+
+/* The face with two corners cannot be represented in a mesh and is ignored. */
+static const char *square_ascii =
+    "ply\n"
+    "format ascii 1.0\n"
+    "comment Two triangles forming a square\n"
+    "element vertex 4\n"
+    "property float x\n"
+    "property float y\n"
+    "property float z\n"
+    "property uchar red\n"
+    "property uchar green\n"
+    "property uchar blue\n"
+    "element face 3\n"
+    "property list uchar int vertex_indices\n"
+    "end_header\n"
+    "0 0 0 255 0 0\n"
+    "1 0 0 0 255 0\n"
+    "1 1 0 0 0 255\n"
+    "0 1 -0.5 255 255 255\n"
+    "3 0 1 2\n"
+    "2 0 1\n"
+    "3 0 2 3\n";
+
+/** Appends values to a binary file in the given byte order. */
+struct BinaryFileBuilder {
+  std::string data;
+  bool big_endian;
+
+  template<typename T> void append(const T value)
+  {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    if (big_endian != (ENDIAN_ORDER == B_ENDIAN)) {
+      std::reverse(bytes, bytes + sizeof(T));
+    }
+    data.append(bytes, sizeof(T));
+  }
+};
+
+/** The same square as #square_ascii, but with a double coordinate and a short list count. */
+static std::string square_binary(const bool big_endian)
+{
+  BinaryFileBuilder builder{"", big_endian};
+  builder.data = "ply\n";
+  builder.data += big_endian ? "format binary_big_endian 1.0\n" :
+                               "format binary_little_endian 1.0\n";
+  builder.data +=
+      "element vertex 4\n"
+      "property float x\n"
+      "property float y\n"
+      "property double z\n"
+      "element face 3\n"
+      "property list ushort uint vertex_indices\n"
+      "end_header\n";
+  const float3 positions[4] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, -0.5f}};
+  for (const float3 &position : positions) {
+    builder.append(position.x);
+    builder.append(position.y);
+    builder.append(double(position.z));
+  }
+  builder.append(uint16_t(3));
+  builder.append(uint32_t(0));
+  builder.append(uint32_t(1));
+  builder.append(uint32_t(2));
+  builder.append(uint16_t(2));
+  builder.append(uint32_t(0));
+  builder.append(uint32_t(1));
+  builder.append(uint16_t(3));
+  builder.append(uint32_t(0));
+  builder.append(uint32_t(2));
+  builder.append(uint32_t(3));
+  return builder.data;
+}
+
+/** \} */
+
+TEST_F(ply_importer_test, ascii)
+{
+  const char *error = nullptr;
+  Mesh *mesh = import_mesh(square_ascii, error);
+  ASSERT_NE(mesh, nullptr) << error;
+  check_square_mesh(*mesh);
+
+  const VArray<ColorGeometry4b> colors = mesh->attributes().lookup<ColorGeometry4b>(
+      "Col", ATTR_DOMAIN_POINT);
+  ASSERT_TRUE(bool(colors));
+  EXPECT_EQ(colors[0], ColorGeometry4b(255, 0, 0, 255));
+  EXPECT_EQ(colors[2], ColorGeometry4b(0, 0, 255, 255));
+  EXPECT_EQ(colors[3], ColorGeometry4b(255, 255, 255, 255));
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(ply_importer_test, binary_little_endian)
+{
+  const char *error = nullptr;
+  Mesh *mesh = import_mesh(square_binary(false), error);
+  ASSERT_NE(mesh, nullptr) << error;
+  check_square_mesh(*mesh);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(ply_importer_test, binary_big_endian)
+{
+  const char *error = nullptr;
+  Mesh *mesh = import_mesh(square_binary(true), error);
+  ASSERT_NE(mesh, nullptr) << error;
+  check_square_mesh(*mesh);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(ply_importer_test, binary_truncated)
+{
+  const std::string file = square_binary(false);
+  const char *error = nullptr;
+  Mesh *mesh = import_mesh(file.substr(0, file.size() - 1), error);
+  EXPECT_EQ(mesh, nullptr);
+  EXPECT_NE(error, nullptr);
+}
+
+TEST_F(ply_importer_test, binary_oversize_list)
+{
+  std::string file =
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex 1\n"
+      "property float x\n"
+      "element face 1\n"
+      "property list uint uint vertex_indices\n"
+      "end_header\n";
+  BinaryFileBuilder builder{file, false};
+  builder.append(0.0f);
+  /* Does not fit into an `int`, and there is no data for the list anyway. */
+  builder.append(uint32_t(0x80000000u));
+  builder.append(uint32_t(0));
+  const char *error = nullptr;
+  Mesh *mesh = import_mesh(builder.data, error);
+  EXPECT_EQ(mesh, nullptr);
+  EXPECT_NE(error, nullptr);
+}
+
+TEST_F(ply_importer_test, binary_float_list_count)
+{
+  std::string file =
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex 1\n"
+      "property float x\n"
+      "element face 1\n"
+      "property list float uint vertex_indices\n"
+      "end_header\n";
+  BinaryFileBuilder builder{file, false};
+  builder.append(0.0f);
+  builder.append(-3.0f);
+  const char *error = nullptr;
+  Mesh *mesh = import_mesh(builder.data, error);
+  EXPECT_EQ(mesh, nullptr);
+  EXPECT_NE(error, nullptr);
+}
+
+TEST_F(ply_importer_test, ascii_invalid_list_size)
+{
+  const std::string header =
+      "ply\n"
+      "format ascii 1.0\n"
+      "element vertex 1\n"
+      "property float x\n"
+      "element face 1\n"
+      "property list uchar int vertex_indices\n"
+      "end_header\n"
+      "0\n";
+  for (const char *face : {"-1 0\n", "3000000000 0 0 0\n"}) {
+    const char *error = nullptr;
+    Mesh *mesh = import_mesh(header + face, error);
+    EXPECT_EQ(mesh, nullptr);
+    EXPECT_NE(error, nullptr);
+  }
+}
+
+TEST_F(ply_importer_test, invalid_vertex_index)
+{
+  const std::string file =
+      "ply\n"
+      "format ascii 1.0\n"
+      "element vertex 3\n"
+      "property float x\n"
+      "element face 1\n"
+      "property list uchar int vertex_indices\n"
+      "end_header\n"
+      "0 1 2\n"
+      "3 0 1 3\n";
+  const char *error = nullptr;
+  Mesh *mesh = import_mesh(file, error);
+  EXPECT_EQ(mesh, nullptr);
+  EXPECT_NE(error, nullptr);
+}
+
+TEST_F(ply_importer_test, ascii_value_out_of_range)
+{
+  const std::string header =
+      "ply\n"
+      "format ascii 1.0\n"
+      "element vertex 1\n"
+      "property float x\n"
+      "property uchar red\n"
+      "end_header\n";
+  /* Values that don't fit into the property type are rejected instead of wrapping around. */
+  for (const char *vertex : {"0 256\n", "0 -1\n", "0 nan\n", "1e300 0\n"}) {
+    const char *error = nullptr;
+    Mesh *mesh = import_mesh(header + vertex, error);
+    EXPECT_EQ(mesh, nullptr) << vertex;
+    EXPECT_NE(error, nullptr);
+  }
+}
+
+TEST_F(ply_importer_test, ascii_multiple_batches)
+{
+  /* More vertices and faces than are converted to binary at once. */
+  const int verts_num = 100000;
+  std::string file = "ply\nformat ascii 1.0\nelement vertex " + std::to_string(verts_num) +
+                     "\nproperty float x\nelement face " + std::to_string(verts_num - 2) +
+                     "\nproperty list uchar int vertex_indices\nend_header\n";
+  for (const int i : IndexRange(verts_num)) {
+    file += std::to_string(i) + "\n";
+  }
+  for (const int i : IndexRange(verts_num - 2)) {
+    file += "3 " + std::to_string(i) + " " + std::to_string(i + 1) + " " +
+            std::to_string(i + 2) + "\n";
+  }
+  const char *error = nullptr;
+  Mesh *mesh = import_mesh(file, error);
+  ASSERT_NE(mesh, nullptr) << error;
+  ASSERT_EQ(mesh->totvert, verts_num);
+  ASSERT_EQ(mesh->totpoly, verts_num - 2);
+  ASSERT_EQ(mesh->totloop, (verts_num - 2) * 3);
+  EXPECT_EQ(mesh->vert_positions()[verts_num - 1].x, float(verts_num - 1));
+  const Span<MPoly> polys = mesh->polys();
+  const Span<MLoop> loops = mesh->loops();
+  const MPoly &last_poly = polys.last();
+  EXPECT_EQ(last_poly.loopstart, (verts_num - 3) * 3);
+  EXPECT_EQ(loops[last_poly.loopstart + 2].v, verts_num - 1);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::io::ply
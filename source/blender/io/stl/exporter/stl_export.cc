@@ -0,0 +1,157 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup stl
+ */
+
+#include <cstdio>
+
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_array.hh"
+#include "BLI_float4x4.hh"
+#include "BLI_math_geom.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_rotation.h"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "IO_orientation.h"
+
+#include "stl_export.hh"
+#include "stl_export_binary_writer.hh"
+
+namespace blender::io::stl {
+
+/**
+ * Triangles are gathered into blocks of this size before they are written,
+ * so that memory use stays bounded for very dense meshes.
+ */
+static const int64_t tris_block_size = 1024 * 1024;
+
+struct ExportMesh {
+  const Mesh *mesh;
+  float4x4 transform;
+};
+
+static Vector<ExportMesh> gather_meshes(Depsgraph *depsgraph,
+                                        const Scene *scene,
+                                        const STLExportParams &export_params)
+{
+  float scale = export_params.global_scale;
+  if ((scene->unit.system != USER_UNIT_NONE) && export_params.use_scene_unit) {
+    scale *= scene->unit.scale_length;
+  }
+  float axes_transform[3][3];
+  unit_m3(axes_transform);
+  /* +Y-forward and +Z-up are the default Blender axis settings. */
+  mat3_from_axis_conversion(
+      export_params.forward_axis, export_params.up_axis, IO_AXIS_Y, IO_AXIS_Z, axes_transform);
+  mul_m3_fl(axes_transform, scale);
+
+  Vector<ExportMesh> meshes;
+  DEGObjectIterSettings deg_iter_settings{};
+  deg_iter_settings.depsgraph = depsgraph;
+  deg_iter_settings.flags = DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
+                            DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET | DEG_ITER_OBJECT_FLAG_VISIBLE |
+                            DEG_ITER_OBJECT_FLAG_DUPLI;
+  DEG_OBJECT_ITER_BEGIN (&deg_iter_settings, object) {
+    if (object->type != OB_MESH) {
+      continue;
+    }
+    if (export_params.export_selected_objects && !(object->base_flag & BASE_SELECTED)) {
+      continue;
+    }
+    Object *obj_eval = DEG_get_evaluated_object(depsgraph, object);
+    const Mesh *mesh = export_params.apply_modifiers ?
+                           BKE_object_get_evaluated_mesh(obj_eval) :
+                           BKE_object_get_pre_modified_mesh(obj_eval);
+    if (mesh == nullptr || mesh->totpoly == 0) {
+      continue;
+    }
+    ExportMesh export_mesh;
+    export_mesh.mesh = mesh;
+    /* Dupli objects are temporary, so the transform is copied here. */
+    mul_m4_m3m4(export_mesh.transform.ptr(), axes_transform, object->object_to_world);
+    /* #mul_m4_m3m4 does not transform last row of the matrix, i.e. location data. */
+    mul_v3_m3v3(export_mesh.transform[3], axes_transform, object->object_to_world[3]);
+    export_mesh.transform[3][3] = object->object_to_world[3][3];
+    meshes.append(export_mesh);
+  }
+  DEG_OBJECT_ITER_END;
+  return meshes;
+}
+
+void gather_triangles(const Mesh &mesh,
+                      const float4x4 &transform,
+                      const IndexRange looptris_range,
+                      MutableSpan<PackedTriangle> r_tris)
+{
+  const Span<float3> positions = mesh.vert_positions();
+  const Span<MLoop> loops = mesh.loops();
+  const Span<MLoopTri> looptris = mesh.looptris().slice(looptris_range);
+  /* A transform with negative scale mirrors the mesh, which would turn the triangles inside out.
+   * Reverse the corner order to keep the face normals pointing outwards. */
+  const bool flip_winding = transform.is_negative();
+  const int corner_order[2][3] = {{0, 1, 2}, {0, 2, 1}};
+  const int *corners = corner_order[flip_winding];
+  threading::parallel_for(looptris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      PackedTriangle &tri = r_tris[i];
+      for (int j = 0; j < 3; j++) {
+        const float3 &position = positions[loops[looptris[i].tri[corners[j]]].v];
+        mul_v3_m4v3(tri.vertices[j], transform.ptr(), position);
+      }
+      normal_tri_v3(tri.normal, tri.vertices[0], tri.vertices[1], tri.vertices[2]);
+      tri.attribute_byte_count = 0;
+    }
+  });
+}
+
+bool exporter_main(Depsgraph *depsgraph, Scene *scene, const STLExportParams &export_params)
+{
+  const Vector<ExportMesh> meshes = gather_meshes(depsgraph, scene, export_params);
+
+  int64_t tris_num = 0;
+  for (const ExportMesh &export_mesh : meshes) {
+    tris_num += export_mesh.mesh->looptris().size();
+  }
+  if (tris_num > UINT32_MAX) {
+    fprintf(stderr, "STL Exporter: too many triangles to export (%lld).\n", (long long)tris_num);
+    return false;
+  }
+
+  BinaryFileWriter writer(export_params.filepath, uint32_t(tris_num));
+  if (!writer.is_valid()) {
+    return false;
+  }
+
+  Array<PackedTriangle> tris_block(std::min(tris_num, tris_block_size));
+  for (const ExportMesh &export_mesh : meshes) {
+    const int64_t mesh_tris_num = export_mesh.mesh->looptris().size();
+    for (int64_t start = 0; start < mesh_tris_num; start += tris_block_size) {
+      const IndexRange range(start, std::min(tris_block_size, mesh_tris_num - start));
+      MutableSpan<PackedTriangle> tris = tris_block.as_mutable_span().take_front(range.size());
+      gather_triangles(*export_mesh.mesh, export_mesh.transform, range, tris);
+      writer.write_triangles(tris);
+    }
+  }
+  return writer.is_valid();
+}
+
+bool exporter_main(bContext *C, const STLExportParams &export_params)
+{
+  Depsgraph *depsgraph = CTX_data_ensure_evaluated_depsgraph(C);
+  Scene *scene = CTX_data_scene(C);
+  return exporter_main(depsgraph, scene, export_params);
+}
+
+}  // namespace blender::io::stl
@@ -0,0 +1,38 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup stl
+ */
+
+#pragma once
+
+#include "BLI_float4x4.hh"
+#include "BLI_index_range.hh"
+#include "BLI_span.hh"
+
+#include "IO_stl.h"
+
+struct Depsgraph;
+struct Mesh;
+
+namespace blender::io::stl {
+
+/* Main export function used from within Blender. Returns false when the file can't be written. */
+bool exporter_main(bContext *C, const STLExportParams &export_params);
+
+/* Used from tests, where full bContext does not exist. */
+bool exporter_main(Depsgraph *depsgraph, Scene *scene, const STLExportParams &export_params);
+
+struct PackedTriangle;
+
+/**
+ * Transform a range of the mesh triangles into export space and fill in their face normals.
+ * The winding order is reversed for transforms with negative scale, so that the normals still
+ * point outwards.
+ */
+void gather_triangles(const Mesh &mesh,
+                      const float4x4 &transform,
+                      IndexRange looptris_range,
+                      MutableSpan<PackedTriangle> r_tris);
+
+}  // namespace blender::io::stl
@@ -0,0 +1,83 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup stl
+ */
+
+#include <cstring>
+
+#include "BLI_array.hh"
+#include "BLI_endian_defines.h"
+#include "BLI_endian_switch.h"
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+
+#include "stl_export_binary_writer.hh"
+
+namespace blender::io::stl {
+
+static const size_t BINARY_HEADER_SIZE = 80;
+
+BinaryFileWriter::BinaryFileWriter(const char *filepath, const uint32_t tris_num)
+{
+  file_ = BLI_fopen(filepath, "wb");
+  if (file_ == nullptr) {
+    fprintf(stderr, "STL Exporter: failed to open file '%s'.\n", filepath);
+    failed_ = true;
+    return;
+  }
+
+  /* The header must not start with "solid", otherwise readers may take the file for ASCII. */
+  char header[BINARY_HEADER_SIZE] = {};
+  STRNCPY(header, "Binary STL exported by Blender");
+  failed_ |= fwrite(header, 1, BINARY_HEADER_SIZE, file_) != BINARY_HEADER_SIZE;
+  /* Binary STL is little-endian. */
+  uint32_t tris_num_le = tris_num;
+  if constexpr (ENDIAN_ORDER == B_ENDIAN) {
+    BLI_endian_switch_uint32(&tris_num_le);
+  }
+  failed_ |= fwrite(&tris_num_le, sizeof(uint32_t), 1, file_) != 1;
+}
+
+BinaryFileWriter::~BinaryFileWriter()
+{
+  if (file_ != nullptr) {
+    if (fclose(file_) != 0) {
+      fprintf(stderr, "STL Exporter: error closing file.\n");
+    }
+  }
+}
+
+bool BinaryFileWriter::is_valid() const
+{
+  return !failed_;
+}
+
+void BinaryFileWriter::write_triangles(const Span<PackedTriangle> tris)
+{
+  if (failed_ || tris.is_empty()) {
+    return;
+  }
+  if constexpr (ENDIAN_ORDER == B_ENDIAN) {
+    Array<PackedTriangle> tris_le(tris);
+    for (PackedTriangle &tri : tris_le) {
+      BLI_endian_switch_float_array(tri.normal, 3);
+      BLI_endian_switch_float_array(&tri.vertices[0][0], 9);
+      BLI_endian_switch_uint16(&tri.attribute_byte_count);
+    }
+    this->write_packed(tris_le);
+    return;
+  }
+  this->write_packed(tris);
+}
+
+void BinaryFileWriter::write_packed(const Span<PackedTriangle> tris)
+{
+  if (fwrite(tris.data(), sizeof(PackedTriangle), size_t(tris.size()), file_) !=
+      size_t(tris.size())) {
+    fprintf(stderr, "STL Exporter: failed to write to file.\n");
+    failed_ = true;
+  }
+}
+
+}  // namespace blender::io::stl
@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup stl
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include "BLI_span.hh"
+
+/*  Binary STL spec.:
+ *   UINT8[80]    – Header                  - 80 bytes
+ *   UINT32       – Number of triangles     - 4 bytes
+ *   For each triangle                      - 50 bytes:
+ *     REAL32[3]   – Normal vector          - 12 bytes
+ *     REAL32[3]   – Vertex 1               - 12 bytes
+ *     REAL32[3]   – Vertex 2               - 12 bytes
+ *     REAL32[3]   – Vertex 3               - 12 bytes
+ *     UINT16      – Attribute byte count   -  2 bytes
+ */
+
+namespace blender::io::stl {
+
+#pragma pack(push, 1)
+struct PackedTriangle {
+  float normal[3];
+  float vertices[3][3];
+  uint16_t attribute_byte_count;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PackedTriangle) == 50, "Binary STL triangles are 50 bytes");
+
+class BinaryFileWriter {
+ private:
+  FILE *file_ = nullptr;
+  bool failed_ = false;
+
+  /** Write triangles that are already in the byte order of the file. */
+  void write_packed(Span<PackedTriangle> tris);
+
+ public:
+  /**
+   * Open the file and write the header for the given total amount of triangles.
+   * Check #is_valid to know whether the file could be opened.
+   */
+  BinaryFileWriter(const char *filepath, uint32_t tris_num);
+  ~BinaryFileWriter();
+
+  BinaryFileWriter(const BinaryFileWriter &other) = delete;
+  BinaryFileWriter &operator=(const BinaryFileWriter &other) = delete;
+
+  /**
+   * Whether the file could be opened and all writes so far succeeded.
+   */
+  bool is_valid() const;
+
+  /**
+   * Append a block of triangles with a single write call.
+   */
+  void write_triangles(Span<PackedTriangle> tris);
+};
+
+}  // namespace blender::io::stl
@@ -0,0 +1,130 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include "testing/testing.h"
+#include "tests/blendfile_loading_base_test.h"
+
+#include "BKE_appdir.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_fileops.h"
+#include "BLI_math_base.hh"
+#include "BLI_math_vector.h"
+#include "BLI_path_util.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "stl_export.hh"
+#include "stl_export_binary_writer.hh"
+
+namespace blender::io::stl {
+
+/* The base class is only used to initialize just enough of Blender to create meshes. */
+class stl_exporter_test : public BlendfileLoadingBaseTest {
+ public:
+  /** Create a mesh with a single triangle in the XY plane, facing +Z. */
+  static Mesh *create_triangle_mesh()
+  {
+    Mesh *mesh = BKE_mesh_new_nomain(3, 0, 0, 3, 1);
+    MutableSpan<float3> positions = mesh->vert_positions_for_write();
+    positions[0] = float3(0, 0, 0);
+    positions[1] = float3(1, 0, 0);
+    positions[2] = float3(0, 1, 0);
+    MutableSpan<MPoly> polys = mesh->polys_for_write();
+    polys[0].loopstart = 0;
+    polys[0].totloop = 3;
+    MutableSpan<MLoop> loops = mesh->loops_for_write();
+    for (const int i : loops.index_range()) {
+      loops[i].v = i;
+      loops[i].e = 0;
+    }
+    return mesh;
+  }
+};
+
+TEST_F(stl_exporter_test, gather_triangles_positive_scale)
+{
+  Mesh *mesh = create_triangle_mesh();
+  float4x4 transform = float4x4::identity();
+  transform.values[0][0] = 2.0f;
+  transform.values[3][2] = 5.0f;
+
+  PackedTriangle tri;
+  gather_triangles(*mesh, transform, IndexRange(1), {&tri, 1});
+
+  EXPECT_EQ(float3(tri.vertices[0]), float3(0, 0, 5));
+  EXPECT_EQ(float3(tri.vertices[1]), float3(2, 0, 5));
+  EXPECT_EQ(float3(tri.vertices[2]), float3(0, 1, 5));
+  EXPECT_EQ(float3(tri.normal), float3(0, 0, 1));
+  EXPECT_EQ(tri.attribute_byte_count, 0);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(stl_exporter_test, gather_triangles_negative_scale)
+{
+  Mesh *mesh = create_triangle_mesh();
+  /* Mirror on the X axis. Without flipping the winding, the normal would point to -Z. */
+  float4x4 transform = float4x4::identity();
+  transform.values[0][0] = -1.0f;
+
+  PackedTriangle tri;
+  gather_triangles(*mesh, transform, IndexRange(1), {&tri, 1});
+
+  EXPECT_EQ(float3(tri.vertices[0]), float3(0, 0, 0));
+  EXPECT_EQ(float3(tri.vertices[1]), float3(0, 1, 0));
+  EXPECT_EQ(float3(tri.vertices[2]), float3(-1, 0, 0));
+  EXPECT_EQ(float3(tri.normal), float3(0, 0, 1));
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(stl_exporter_test, binary_writer)
+{
+  char filepath[FILE_MAX];
+  BLI_path_join(filepath, sizeof(filepath), BKE_tempdir_base(), "io_stl_binary_writer.stl");
+
+  PackedTriangle tris[2] = {};
+  tris[0].normal[2] = 1.0f;
+  tris[1].vertices[2][1] = 3.0f;
+  {
+    BinaryFileWriter writer(filepath, 2);
+    ASSERT_TRUE(writer.is_valid());
+    writer.write_triangles({tris, 2});
+    EXPECT_TRUE(writer.is_valid());
+  }
+
+  size_t size = 0;
+  char *data = static_cast<char *>(BLI_file_read_binary_as_mem(filepath, 0, &size));
+  ASSERT_NE(data, nullptr);
+  ASSERT_EQ(size, 80 + sizeof(uint32_t) + 2 * sizeof(PackedTriangle));
+  EXPECT_NE(strncmp(data, "solid", 5), 0);
+  /* The triangle count is little-endian. */
+  const uint8_t *tris_num = reinterpret_cast<const uint8_t *>(data + 80);
+  EXPECT_EQ(tris_num[0], 2);
+  EXPECT_EQ(tris_num[1], 0);
+  EXPECT_EQ(tris_num[2], 0);
+  EXPECT_EQ(tris_num[3], 0);
+  EXPECT_EQ(memcmp(data + 84, tris, sizeof(tris)), 0);
+
+  MEM_freeN(data);
+  BLI_delete(filepath, false, false);
+}
+
+TEST_F(stl_exporter_test, binary_writer_invalid_path)
+{
+  char filepath[FILE_MAX];
+  BLI_path_join(
+      filepath, sizeof(filepath), BKE_tempdir_base(), "io_stl_missing_dir", "invalid.stl");
+
+  BinaryFileWriter writer(filepath, 1);
+  EXPECT_FALSE(writer.is_valid());
+  PackedTriangle tri = {};
+  writer.write_triangles({&tri, 1});
+  EXPECT_FALSE(writer.is_valid());
+}
+
+}  // namespace blender::io::stl
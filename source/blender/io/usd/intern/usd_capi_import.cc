@@ -30,6 +30,7 @@
 #include "BLI_math_rotation.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 #include "BLI_timeit.hh"
 
 #include "DEG_depsgraph.h"
@@ -251,6 +252,23 @@ static void import_startjob(void *customdata, bool *stop, bool *do_update, float
     }
   }
 
+  /* Converting the geometry of different prims is independent, so do that in parallel first.
+   * Reading the rest of the data afterwards modifies #Main and has to happen serially. */
+  const std::vector<USDPrimReader *> &readers = archive->readers();
+  threading::parallel_for(IndexRange(readers.size()), 1, [&](const IndexRange range) {
+    for (const int64_t reader_index : range) {
+      USDPrimReader *reader = readers[reader_index];
+      if (reader && !G.is_break) {
+        reader->prefetch_object_data(0.0);
+      }
+    }
+  });
+
+  if (G.is_break) {
+    data->was_canceled = true;
+    return;
+  }
+
   /* Setup parenthood and read actual object data. */
   i = 0;
   for (USDPrimReader *reader : archive->readers()) {
@@ -9,6 +9,7 @@
 #include "usd_writer_light.h"
 #include "usd_writer_mesh.h"
 #include "usd_writer_metaball.h"
+#include "usd_writer_point_instancer.h"
 #include "usd_writer_transform.h"
 #include "usd_writer_volume.h"
 
@@ -45,6 +46,23 @@ bool USDHierarchyIterator::mark_as_weak_export(const Object *object) const
   return false;
 }
 
+bool USDHierarchyIterator::should_export_as_point_instance(const HierarchyContext *context) const
+{
+  if (!params_.use_instancing || context->object->type != OB_MESH) {
+    return false;
+  }
+  /* Instances of geometry created by geometry nodes use the duplicator as object, their data
+   * is not the data of the original that would be referenced. */
+  if (context->object == context->duplicator) {
+    return false;
+  }
+  /* Invisible instances keep their own prim, so that they can be marked as such. */
+  if (params_.visible_objects_only && !context->is_object_visible(params_.evaluation_mode)) {
+    return false;
+  }
+  return true;
+}
+
 void USDHierarchyIterator::release_writer(AbstractHierarchyWriter *writer)
 {
   delete static_cast<USDAbstractWriter *>(writer);
@@ -151,4 +169,10 @@ AbstractHierarchyWriter *USDHierarchyIterator::create_particle_writer(
   return nullptr;
 }
 
+AbstractHierarchyWriter *USDHierarchyIterator::create_point_instancer_writer(
+    const HierarchyContext *context)
+{
+  return new USDPointInstancerWriter(create_usd_export_context(context));
+}
+
 }  // namespace blender::io::usd
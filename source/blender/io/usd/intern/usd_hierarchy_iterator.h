@@ -41,6 +41,7 @@ class USDHierarchyIterator : public AbstractHierarchyIterator {
 
  protected:
   virtual bool mark_as_weak_export(const Object *object) const override;
+  virtual bool should_export_as_point_instance(const HierarchyContext *context) const override;
 
   virtual AbstractHierarchyWriter *create_transform_writer(
       const HierarchyContext *context) override;
@@ -48,6 +49,8 @@ class USDHierarchyIterator : public AbstractHierarchyIterator {
   virtual AbstractHierarchyWriter *create_hair_writer(const HierarchyContext *context) override;
   virtual AbstractHierarchyWriter *create_particle_writer(
       const HierarchyContext *context) override;
+  virtual AbstractHierarchyWriter *create_point_instancer_writer(
+      const HierarchyContext *context) override;
 
   virtual void release_writer(AbstractHierarchyWriter *writer) override;
 
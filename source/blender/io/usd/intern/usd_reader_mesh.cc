@@ -8,6 +8,7 @@
 
 #include "BKE_attribute.hh"
 #include "BKE_customdata.h"
+#include "BKE_lib_id.h"
 #include "BKE_main.h"
 #include "BKE_material.h"
 #include "BKE_mesh.h"
@@ -227,10 +228,20 @@ USDMeshReader::USDMeshReader(const pxr::UsdPrim &prim,
       is_left_handed_(false),
       has_uvs_(false),
       is_time_varying_(false),
-      is_initial_load_(false)
+      is_initial_load_(false),
+      prefetched_mesh_(nullptr),
+      is_prefetched_(false)
 {
 }
 
+USDMeshReader::~USDMeshReader()
+{
+  /* The mesh was not moved into the object, e.g. because the import was canceled. */
+  if (prefetched_mesh_) {
+    BKE_id_free(nullptr, prefetched_mesh_);
+  }
+}
+
 void USDMeshReader::create_object(Main *bmain, const double /* motionSampleTime */)
 {
   Mesh *mesh = BKE_mesh_add(bmain, name_.c_str());
@@ -239,15 +250,41 @@ void USDMeshReader::create_object(Main *bmain, const double /* motionSampleTime
   object_->data = mesh;
 }
 
-void USDMeshReader::read_object_data(Main *bmain, const double motionSampleTime)
+void USDMeshReader::prefetch_object_data(const double motionSampleTime)
 {
+  /* Only the mesh of this reader is accessed, so this can run in parallel with other readers.
+   * Materials are created in #read_object_data. */
   Mesh *mesh = (Mesh *)object_->data;
 
   is_initial_load_ = true;
   Mesh *read_mesh = this->read_mesh(
       mesh, motionSampleTime, import_params_.mesh_read_flag, nullptr);
-
   is_initial_load_ = false;
+
+  if (read_mesh != mesh) {
+    prefetched_mesh_ = read_mesh;
+  }
+  is_prefetched_ = true;
+}
+
+void USDMeshReader::read_object_data(Main *bmain, const double motionSampleTime)
+{
+  Mesh *mesh = (Mesh *)object_->data;
+
+  Mesh *read_mesh = mesh;
+  if (is_prefetched_) {
+    if (prefetched_mesh_) {
+      read_mesh = prefetched_mesh_;
+      prefetched_mesh_ = nullptr;
+    }
+    is_prefetched_ = false;
+  }
+  else {
+    is_initial_load_ = true;
+    read_mesh = this->read_mesh(mesh, motionSampleTime, import_params_.mesh_read_flag, nullptr);
+    is_initial_load_ = false;
+  }
+
   if (read_mesh != mesh) {
     BKE_mesh_nomain_to_mesh(read_mesh, mesh, object_);
   }
@@ -92,6 +92,13 @@ class USDPrimReader {
   virtual void create_object(Main *bmain, double motionSampleTime) = 0;
   virtual void read_object_data(Main * /* bmain */, double /* motionSampleTime */){};
 
+  /**
+   * Read the part of the object data that does not need access to #Main, like mesh geometry.
+   * This is called for all readers in parallel, after #create_object and before
+   * #read_object_data.
+   */
+  virtual void prefetch_object_data(double /* motionSampleTime */){};
+
   Object *object() const;
   void object(Object *ob);
 
@@ -26,10 +26,12 @@
 #  include <pxr/usd/usdLux/light.h>
 #endif
 
+#include <algorithm>
 #include <iostream>
 
 #include "BLI_sort.hh"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 
 namespace blender::io::usd {
 
@@ -205,7 +207,9 @@ static bool merge_with_parent(USDPrimReader *reader)
   return true;
 }
 
-USDPrimReader *USDStageReader::collect_readers(Main *bmain, const pxr::UsdPrim &prim)
+USDPrimReader *USDStageReader::collect_readers(Main *bmain,
+                                               const pxr::UsdPrim &prim,
+                                               std::vector<USDPrimReader *> &r_readers)
 {
   if (prim.IsA<pxr::UsdGeomImageable>()) {
     pxr::UsdGeomImageable imageable(prim);
@@ -225,15 +229,24 @@ USDPrimReader *USDStageReader::collect_readers(Main *bmain, const pxr::UsdPrim &
     filter_predicate = pxr::UsdTraverseInstanceProxies(filter_predicate);
   }
 
-  pxr::UsdPrimSiblingRange children = prim.GetFilteredChildren(filter_predicate);
+  pxr::UsdPrimSiblingRange children_range = prim.GetFilteredChildren(filter_predicate);
+  const std::vector<pxr::UsdPrim> children(children_range.begin(), children_range.end());
 
-  std::vector<USDPrimReader *> child_readers;
-
-  for (const auto &childPrim : children) {
-    if (USDPrimReader *child_reader = collect_readers(bmain, childPrim)) {
-      child_readers.push_back(child_reader);
+  /* The sub-trees of the children are independent, so their readers are created in parallel.
+   * Every sub-tree collects its readers separately and they are concatenated in the order of
+   * the children afterwards, so the result is the same as with a serial traversal. */
+  std::vector<USDPrimReader *> child_readers(children.size(), nullptr);
+  std::vector<std::vector<USDPrimReader *>> child_tree_readers(children.size());
+  threading::parallel_for(IndexRange(children.size()), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      child_readers[i] = collect_readers(bmain, children[i], child_tree_readers[i]);
     }
+  });
+  for (const std::vector<USDPrimReader *> &tree_readers : child_tree_readers) {
+    r_readers.insert(r_readers.end(), tree_readers.begin(), tree_readers.end());
   }
+  child_readers.erase(std::remove(child_readers.begin(), child_readers.end(), nullptr),
+                      child_readers.end());
 
   if (prim.IsPseudoRoot()) {
     return nullptr;
@@ -255,7 +268,7 @@ USDPrimReader *USDStageReader::collect_readers(Main *bmain, const pxr::UsdPrim &
     return nullptr;
   }
 
-  readers_.push_back(reader);
+  r_readers.push_back(reader);
   reader->incref();
 
   /* Set each child reader's parent. */
@@ -291,7 +304,7 @@ void USDStageReader::collect_readers(Main *bmain)
   }
 
   stage_->SetInterpolationType(pxr::UsdInterpolationType::UsdInterpolationTypeHeld);
-  collect_readers(bmain, root);
+  collect_readers(bmain, root, readers_);
 }
 
 void USDStageReader::clear_readers()
@@ -66,7 +66,14 @@ class USDStageReader {
   void sort_readers();
 
  private:
-  USDPrimReader *collect_readers(Main *bmain, const pxr::UsdPrim &prim);
+  /**
+   * Create the readers for the prim and its descendants and append them to `r_readers`,
+   * children before their parents.
+   * \return The reader of the prim, or of the child it was merged with, if any.
+   */
+  USDPrimReader *collect_readers(Main *bmain,
+                                 const pxr::UsdPrim &prim,
+                                 std::vector<USDPrimReader *> &r_readers);
 
   /**
    * Returns true if the given prim should be included in the
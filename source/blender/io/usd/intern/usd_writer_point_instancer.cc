@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+#include "usd_writer_point_instancer.h"
+#include "usd_hierarchy_iterator.h"
+
+#include <pxr/base/gf/quath.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/usd/usd/references.h>
+#include <pxr/usd/usdGeom/pointInstancer.h>
+
+#include "BKE_object.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math_matrix.h"
+#include "BLI_span.hh"
+#include "BLI_task.hh"
+
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+pxr::SdfPathVector define_point_instancer_prototypes(const pxr::UsdStageRefPtr &stage,
+                                                     const pxr::SdfPath &instancer_path,
+                                                     const Span<std::string> source_paths)
+{
+  static const pxr::TfToken prototypes_name("Prototypes", pxr::TfToken::Immortal);
+  const pxr::SdfPath prototypes_path = instancer_path.AppendChild(prototypes_name);
+  stage->OverridePrim(prototypes_path);
+
+  pxr::SdfPathVector prototype_paths;
+  for (const int64_t i : source_paths.index_range()) {
+    const pxr::SdfPath path = prototypes_path.AppendChild(
+        pxr::TfToken("prototype_" + std::to_string(i)));
+    pxr::UsdPrim prototype = stage->DefinePrim(path);
+    prototype.GetReferences().ClearReferences();
+    prototype.GetReferences().AddInternalReference(pxr::SdfPath(source_paths[i]));
+    prototype_paths.push_back(path);
+  }
+  return prototype_paths;
+}
+
+USDPointInstancerWriter::USDPointInstancerWriter(const USDExporterContext &ctx)
+    : USDAbstractWriter(ctx)
+{
+}
+
+bool USDPointInstancerWriter::check_is_animated(const HierarchyContext &context) const
+{
+  /* The context is the one of the duplicator. The instance transforms are relative to it, so only
+   * the things that move the instances relative to the duplicator matter. */
+  if (!BLI_listbase_is_empty(&context.object->particlesystem)) {
+    return true;
+  }
+  if (AbstractHierarchyWriter::check_is_animated(context)) {
+    return true;
+  }
+  for (const HierarchyContext *instance : context.point_instances) {
+    if (BKE_object_moves_in_time(instance->object, true)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int USDPointInstancerWriter::ensure_prototype(const std::string &prototype_path)
+{
+  return prototype_indices_.lookup_or_add_cb(prototype_path, [&]() {
+    prototype_paths_.push_back(prototype_path);
+    return int(prototype_paths_.size()) - 1;
+  });
+}
+
+void USDPointInstancerWriter::do_write(HierarchyContext &context)
+{
+  const pxr::UsdTimeCode timecode = get_export_time_code();
+  pxr::UsdGeomPointInstancer usd_instancer = pxr::UsdGeomPointInstancer::Define(
+      usd_export_context_.stage, usd_export_context_.usd_path);
+
+  const Span<const HierarchyContext *> instances = context.point_instances;
+
+  /* All instances of the same object share a prototype, so only look up its path once. */
+  pxr::VtIntArray proto_indices(instances.size());
+  Map<const Object *, int> object_prototypes;
+  for (const int64_t i : instances.index_range()) {
+    const HierarchyContext *instance = instances[i];
+    proto_indices[i] = object_prototypes.lookup_or_add_cb(instance->object, [&]() {
+      return this->ensure_prototype(instance->original_export_path);
+    });
+  }
+
+  /* The instancer is a child of the duplicator, so the instance transforms are relative to it. */
+  float duplicator_world_inv[4][4];
+  invert_m4_m4(duplicator_world_inv, context.matrix_world);
+
+  pxr::VtVec3fArray positions(instances.size());
+  pxr::VtQuathArray orientations(instances.size());
+  pxr::VtVec3fArray scales(instances.size());
+  pxr::GfVec3f *positions_data = positions.data();
+  pxr::GfQuath *orientations_data = orientations.data();
+  pxr::GfVec3f *scales_data = scales.data();
+  threading::parallel_for(instances.index_range(), 1024, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      float matrix[4][4];
+      mul_m4_m4m4(matrix, duplicator_world_inv, instances[i]->matrix_world);
+      /* A point instancer cannot represent shear, it is lost here. */
+      float location[3], rotation[4], scale[3];
+      mat4_decompose(location, rotation, scale, matrix);
+      positions_data[i] = pxr::GfVec3f(location);
+      orientations_data[i] = pxr::GfQuath(rotation[0], rotation[1], rotation[2], rotation[3]);
+      scales_data[i] = pxr::GfVec3f(scale);
+    }
+  });
+
+  usd_instancer.CreatePrototypesRel().SetTargets(define_point_instancer_prototypes(
+      usd_export_context_.stage, usd_export_context_.usd_path, prototype_paths_));
+
+  pxr::UsdAttribute attr_proto_indices = usd_instancer.CreateProtoIndicesAttr(pxr::VtValue(),
+                                                                              true);
+  pxr::UsdAttribute attr_positions = usd_instancer.CreatePositionsAttr(pxr::VtValue(), true);
+  pxr::UsdAttribute attr_orientations = usd_instancer.CreateOrientationsAttr(pxr::VtValue(),
+                                                                            true);
+  pxr::UsdAttribute attr_scales = usd_instancer.CreateScalesAttr(pxr::VtValue(), true);
+  usd_value_writer_.SetAttribute(attr_proto_indices, pxr::VtValue(proto_indices), timecode);
+  usd_value_writer_.SetAttribute(attr_positions, pxr::VtValue(positions), timecode);
+  usd_value_writer_.SetAttribute(attr_orientations, pxr::VtValue(orientations), timecode);
+  usd_value_writer_.SetAttribute(attr_scales, pxr::VtValue(scales), timecode);
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,47 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+#pragma once
+
+#include "usd_writer_abstract.h"
+
+#include "BLI_map.hh"
+#include "BLI_span.hh"
+
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/stage.h>
+
+#include <string>
+#include <vector>
+
+namespace blender::io::usd {
+
+/* Define the prototypes of a point instancer below an `over` prim that is a child of the
+ * instancer. Every prototype references the exported prim that it instances. Prims below an
+ * `over` are not defined, so the prototypes are only drawn by the instancer and not a second time
+ * at the location of the referenced prims. Returns the paths of the prototypes, in the order of
+ * `source_paths`. */
+pxr::SdfPathVector define_point_instancer_prototypes(const pxr::UsdStageRefPtr &stage,
+                                                     const pxr::SdfPath &instancer_path,
+                                                     Span<std::string> source_paths);
+
+/* Writer for dupli-objects that instance the same object data, as the points of a
+ * UsdGeomPointInstancer. Every instanced object data becomes a prototype, so only a transform and
+ * a prototype index are written per instance. See #HierarchyContext::point_instances. */
+class USDPointInstancerWriter : public USDAbstractWriter {
+ private:
+  /* Export paths of the prototypes, in the order of their indices. Prototypes are only ever
+   * added, so that the indices written for earlier frames stay valid. */
+  std::vector<std::string> prototype_paths_;
+  Map<std::string, int> prototype_indices_;
+
+ public:
+  USDPointInstancerWriter(const USDExporterContext &ctx);
+
+ protected:
+  virtual bool check_is_animated(const HierarchyContext &context) const override;
+  virtual void do_write(HierarchyContext &context) override;
+
+ private:
+  int ensure_prototype(const std::string &prototype_path);
+};
+
+}  // namespace blender::io::usd
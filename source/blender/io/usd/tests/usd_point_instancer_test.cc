@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+#include "testing/testing.h"
+
+#include "usd_tests_common.h"
+
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/pointInstancer.h>
+#include <pxr/usd/usdGeom/xform.h>
+
+#include <string>
+#include <vector>
+
+#include "intern/usd_writer_point_instancer.h"
+
+namespace blender::io::usd {
+
+class USDPointInstancerTest : public testing::Test {
+};
+
+TEST_F(USDPointInstancerTest, PrototypesAreNotDefined)
+{
+  if (register_usd_plugins_for_tests().empty()) {
+    FAIL();
+    return;
+  }
+
+  pxr::UsdStageRefPtr stage = pxr::UsdStage::CreateInMemory();
+  ASSERT_TRUE(stage);
+
+  /* The exported originals and a duplicator with a point instancer, like the exporter writes
+   * them. */
+  pxr::UsdGeomXform::Define(stage, pxr::SdfPath("/root/Cube"));
+  pxr::UsdGeomMesh::Define(stage, pxr::SdfPath("/root/Cube/Cube"));
+  pxr::UsdGeomXform::Define(stage, pxr::SdfPath("/root/Sphere"));
+  pxr::UsdGeomMesh::Define(stage, pxr::SdfPath("/root/Sphere/Sphere"));
+  pxr::UsdGeomXform::Define(stage, pxr::SdfPath("/root/Scatter"));
+  const pxr::SdfPath instancer_path("/root/Scatter/Scatter");
+  pxr::UsdGeomPointInstancer instancer = pxr::UsdGeomPointInstancer::Define(stage,
+                                                                          instancer_path);
+
+  const std::vector<std::string> source_paths = {"/root/Cube/Cube", "/root/Sphere/Sphere"};
+  const pxr::SdfPathVector prototype_paths = define_point_instancer_prototypes(
+      stage, instancer_path, source_paths);
+  instancer.CreatePrototypesRel().SetTargets(prototype_paths);
+
+  ASSERT_EQ(prototype_paths.size(), 2);
+  const pxr::UsdPrim prototypes = stage->GetPrimAtPath(prototype_paths[0].GetParentPath());
+  ASSERT_TRUE(prototypes);
+  EXPECT_EQ(prototypes.GetParent().GetPath(), instancer_path);
+  EXPECT_EQ(prototypes.GetSpecifier(), pxr::SdfSpecifierOver);
+
+  for (const int i : IndexRange(2)) {
+    const pxr::UsdPrim prototype = stage->GetPrimAtPath(prototype_paths[i]);
+    ASSERT_TRUE(prototype);
+    /* The data comes from the referenced original. */
+    EXPECT_TRUE(prototype.IsA<pxr::UsdGeomMesh>());
+    EXPECT_TRUE(prototype.HasAuthoredReferences());
+    /* Prims below an `over` are not drawn by themselves. */
+    EXPECT_FALSE(prototype.IsDefined());
+  }
+
+  pxr::SdfPathVector targets;
+  instancer.GetPrototypesRel().GetTargets(&targets);
+  EXPECT_EQ(targets, prototype_paths);
+
+  /* Only the originals are drawn in place, the prototypes are skipped by a default traversal. */
+  int meshes_num = 0;
+  for (const pxr::UsdPrim &prim : stage->Traverse()) {
+    if (prim.IsA<pxr::UsdGeomMesh>()) {
+      EXPECT_TRUE(prim.GetPath() == pxr::SdfPath("/root/Cube/Cube") ||
+                  prim.GetPath() == pxr::SdfPath("/root/Sphere/Sphere"));
+      meshes_num++;
+    }
+  }
+  EXPECT_EQ(meshes_num, 2);
+
+  /* Writing the prototypes again for another frame does not add more of them. */
+  EXPECT_EQ(define_point_instancer_prototypes(stage, instancer_path, source_paths),
+            prototype_paths);
+  EXPECT_EQ(prototypes.GetChildren().size(), 0);
+  EXPECT_EQ(prototypes.GetAllChildren().size(), 2);
+}
+
+}  // namespace blender::io::usd
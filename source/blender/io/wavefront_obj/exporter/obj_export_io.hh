@@ -6,11 +6,16 @@
 
 #pragma once
 
+#include <cerrno>
 #include <cstdio>
 #include <string>
 #include <type_traits>
 #include <vector>
 
+#ifndef WIN32
+#  include <unistd.h>
+#endif
+
 #include "BLI_compiler_attrs.h"
 #include "BLI_fileops.h"
 #include "BLI_string_ref.hh"
@@ -49,6 +54,38 @@ class FormatHandler : NonCopyable, NonMovable {
     blocks_.clear();
   }
 
+#ifndef WIN32
+  /**
+   * Write contents of the buffer(s) at the given position of the file, and clear the buffers.
+   * Positioned writes do not use the file offset, so different buffers can be written into
+   * the same file from multiple threads at once.
+   * \return False if writing failed.
+   */
+  bool write_to_file_at(int fd, int64_t offset)
+  {
+    bool ok = true;
+    for (const auto &b : blocks_) {
+      const char *data = b.data();
+      size_t remaining = b.size();
+      while (ok && remaining > 0) {
+        const ssize_t written = pwrite(fd, data, remaining, off_t(offset));
+        if (written < 0 && errno == EINTR) {
+          continue;
+        }
+        if (written <= 0) {
+          ok = false;
+          break;
+        }
+        data += written;
+        remaining -= size_t(written);
+        offset += written;
+      }
+    }
+    blocks_.clear();
+    return ok;
+  }
+#endif
+
   std::string get_as_string() const
   {
     std::string s;
@@ -60,6 +97,21 @@ class FormatHandler : NonCopyable, NonMovable {
   {
     return blocks_.size();
   }
+  /* Total size of the contents of all buffers. */
+  size_t get_size() const
+  {
+    size_t size = 0;
+    for (const auto &b : blocks_)
+      size += b.size();
+    return size;
+  }
+
+  /* Ensure the next block has room for at least this amount of text, so that text of
+   * a known (or estimated) size ends up in one block instead of many small ones. */
+  void reserve(size_t size)
+  {
+    ensure_space(size);
+  }
 
   void append_from(FormatHandler &v)
   {
@@ -4,12 +4,15 @@
  * \ingroup obj
  */
 
+#include <atomic>
 #include <cstdio>
 #include <exception>
 #include <memory>
 
 #include "BKE_scene.h"
 
+#include "BLI_array.hh"
+#include "BLI_fileops.h"
 #include "BLI_path_util.h"
 #include "BLI_task.hh"
 #include "BLI_vector.hh"
@@ -135,6 +138,64 @@ filter_supported_objects(Depsgraph *depsgraph, const OBJExportParams &export_par
   return {std::move(r_exportable_meshes), std::move(r_exportable_nurbs)};
 }
 
+/**
+ * Rough size of the text of an object, based on typical line lengths. Used to reserve the
+ * object's buffer up-front, so that it is written with few calls.
+ */
+static size_t estimate_mesh_text_size(const OBJMesh &obj, const OBJExportParams &export_params)
+{
+  /* Assume quads, with up to three indices of about eight characters per corner. */
+  const size_t corner_size = 8 * (1 + export_params.export_uv + export_params.export_normals);
+  size_t size = 256;
+  size += size_t(obj.tot_vertices()) * (export_params.export_colors ? 64 : 40);
+  size += size_t(obj.tot_polygons()) * (4 + 4 * corner_size);
+  if (export_params.export_normals) {
+    size += size_t(obj.tot_normal_indices()) * 24;
+  }
+  if (export_params.export_uv) {
+    size += size_t(obj.tot_uv_vertices()) * 20;
+  }
+  return size;
+}
+
+/**
+ * Write the text buffers of all objects into the file. The size of every buffer is known at
+ * this point, so each buffer is written at its final position in the file in parallel, instead
+ * of concatenating them serially.
+ */
+static void write_buffers_to_file(MutableSpan<FormatHandler> buffers, FILE *f)
+{
+#ifdef WIN32
+  /* No positioned writes, write the buffers in order. */
+  for (FormatHandler &fh : buffers) {
+    fh.write_to_file(f);
+  }
+#else
+  /* Text already written with the stream has to be in the file before writing after it. */
+  fflush(f);
+  Array<int64_t> offsets(buffers.size() + 1);
+  offsets[0] = BLI_ftell(f);
+  for (const int64_t i : buffers.index_range()) {
+    offsets[i + 1] = offsets[i] + int64_t(buffers[i].get_size());
+  }
+
+  const int fd = fileno(f);
+  std::atomic<bool> all_written = true;
+  threading::parallel_for(buffers.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      if (!buffers[i].write_to_file_at(fd, offsets[i])) {
+        all_written = false;
+      }
+    }
+  });
+  if (!all_written) {
+    std::cerr << "Error: could not write object data to the OBJ file" << std::endl;
+  }
+  /* Continue writing with the stream after the object data. */
+  BLI_fseek(f, offsets.last(), SEEK_SET);
+#endif
+}
+
 static void write_mesh_objects(Vector<std::unique_ptr<OBJMesh>> exportable_as_mesh,
                                OBJWriter &obj_writer,
                                MTLWriter *mtl_writer,
@@ -193,6 +254,7 @@ static void write_mesh_objects(Vector<std::unique_ptr<OBJMesh>> exportable_as_me
     for (const int i : range) {
       OBJMesh &obj = *exportable_as_mesh[i];
       auto &fh = buffers[i];
+      fh.reserve(estimate_mesh_text_size(obj, export_params));
 
       obj_writer.write_object_name(fh, obj);
       obj_writer.write_vertex_coords(fh, obj, export_params.export_colors);
@@ -230,10 +292,8 @@ static void write_mesh_objects(Vector<std::unique_ptr<OBJMesh>> exportable_as_me
   });
 
   /* Write all the object text buffers into the output file. */
-  FILE *f = obj_writer.get_outfile();
-  for (auto &b : buffers) {
-    b.write_to_file(f);
-  }
+  write_buffers_to_file(MutableSpan<FormatHandler>(buffers.data(), int64_t(buffers.size())),
+                        obj_writer.get_outfile());
 }
 
 /**
@@ -8,6 +8,7 @@
 #include "BLI_math_color.h"
 #include "BLI_math_vector.h"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "obj_export_mtl.hh"
@@ -64,11 +65,31 @@ static Geometry *create_geometry(Geometry *const prev_geometry,
   return new_geometry();
 }
 
-static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+/**
+ * Append a color for the most recently added vertex, starting a new colors block
+ * if the previous vertex had no color.
+ */
+static void geom_add_last_vertex_color(const float3 &linear, GlobalVertices &r_global_vertices)
+{
+  auto &blocks = r_global_vertices.vertex_colors;
+  /* If we don't have vertex colors yet, or the previous vertex
+   * was without color, we need to start a new vertex colors block. */
+  if (blocks.is_empty() || (blocks.last().start_vertex_index + blocks.last().colors.size() !=
+                            r_global_vertices.vertices.size() - 1)) {
+    GlobalVertices::VertexColorsBlock block;
+    block.start_vertex_index = r_global_vertices.vertices.size() - 1;
+    blocks.append(block);
+  }
+  blocks.last().colors.append(linear);
+}
+
+/**
+ * Parse a vertex line. Returns true and fills in `r_linear_color` when the
+ * vertex has an `xyzrgb` color.
+ */
+static bool parse_vertex(const char *p, const char *end, float3 &r_vert, float3 &r_linear_color)
 {
-  float3 vert;
-  p = parse_floats(p, end, 0.0f, vert, 3);
-  r_global_vertices.vertices.append(vert);
+  p = parse_floats(p, end, 0.0f, r_vert, 3);
   /* OBJ extension: `xyzrgb` vertex colors, when the vertex position
    * is followed by 3 more RGB color components. See
    * http://paulbourke.net/dataformats/obj/colour.html */
@@ -76,21 +97,11 @@ static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_gl
     float3 srgb;
     p = parse_floats(p, end, -1.0f, srgb, 3);
     if (srgb.x >= 0 && srgb.y >= 0 && srgb.z >= 0) {
-      float3 linear;
-      srgb_to_linearrgb_v3_v3(linear, srgb);
-
-      auto &blocks = r_global_vertices.vertex_colors;
-      /* If we don't have vertex colors yet, or the previous vertex
-       * was without color, we need to start a new vertex colors block. */
-      if (blocks.is_empty() || (blocks.last().start_vertex_index + blocks.last().colors.size() !=
-                                r_global_vertices.vertices.size() - 1)) {
-        GlobalVertices::VertexColorsBlock block;
-        block.start_vertex_index = r_global_vertices.vertices.size() - 1;
-        blocks.append(block);
-      }
-      blocks.last().colors.append(linear);
+      srgb_to_linearrgb_v3_v3(r_linear_color, srgb);
+      return true;
     }
   }
+  return false;
 }
 
 static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices &r_global_vertices)
@@ -132,9 +143,7 @@ static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices
   }
 }
 
-static void geom_add_vertex_normal(const char *p,
-                                   const char *end,
-                                   GlobalVertices &r_global_vertices)
+static float3 parse_vertex_normal(const char *p, const char *end)
 {
   float3 normal;
   parse_floats(p, end, 0.0f, normal, 3);
@@ -142,14 +151,14 @@ static void geom_add_vertex_normal(const char *p,
    * making them ever-so-slightly non unit length. Make sure they are
    * normalized. */
   normalize_v3(normal);
-  r_global_vertices.vertex_normals.append(normal);
+  return normal;
 }
 
-static void geom_add_uv_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+static float2 parse_uv_vertex(const char *p, const char *end)
 {
   float2 uv;
   parse_floats(p, end, 0.0f, uv, 2);
-  r_global_vertices.uv_vertices.append(uv);
+  return uv;
 }
 
 static void geom_add_edge(Geometry *geom,
@@ -169,30 +178,26 @@ static void geom_add_edge(Geometry *geom,
   geom->track_vertex_index(edge_v2);
 }
 
-static void geom_add_polygon(Geometry *geom,
-                             const char *p,
-                             const char *end,
-                             const GlobalVertices &global_vertices,
-                             const int material_index,
-                             const int group_index,
-                             const bool shaded_smooth)
-{
-  PolyElem curr_face;
-  curr_face.shaded_smooth = shaded_smooth;
-  curr_face.material_index = material_index;
-  if (group_index >= 0) {
-    curr_face.vertex_group_index = group_index;
-    geom->has_vertex_groups_ = true;
-  }
-
-  const int orig_corners_size = geom->face_corners_.size();
-  curr_face.start_index_ = orig_corners_size;
+/**
+ * Face corner as spelled out in the file, before indices are made zero-based and validated.
+ */
+struct FaceCorner {
+  PolyCorner corner;
+  bool got_uv = false;
+  bool got_normal = false;
+};
 
+/**
+ * Parse the corners of a face line. Parsing stops after the first corner that has
+ * no valid vertex index.
+ */
+static void parse_face_corners(const char *p, const char *end, Vector<FaceCorner> &r_corners)
+{
   bool face_valid = true;
   p = drop_whitespace(p, end);
   while (p < end && face_valid) {
-    PolyCorner corner;
-    bool got_uv = false, got_normal = false;
+    FaceCorner face_corner;
+    PolyCorner &corner = face_corner.corner;
     /* Parse vertex index. */
     p = parse_int(p, end, INT32_MAX, corner.vert_index, false);
     face_valid &= corner.vert_index != INT32_MAX;
@@ -201,15 +206,45 @@ static void geom_add_polygon(Geometry *geom,
       ++p;
       if (p < end && *p != '/') {
         p = parse_int(p, end, INT32_MAX, corner.uv_vert_index, false);
-        got_uv = corner.uv_vert_index != INT32_MAX;
+        face_corner.got_uv = corner.uv_vert_index != INT32_MAX;
       }
       /* Parse normal index. */
       if (p < end && *p == '/') {
         ++p;
         p = parse_int(p, end, INT32_MAX, corner.vertex_normal_index, false);
-        got_normal = corner.vertex_normal_index != INT32_MAX;
+        face_corner.got_normal = corner.vertex_normal_index != INT32_MAX;
       }
     }
+    r_corners.append(face_corner);
+
+    /* Some files contain extra stuff per face (e.g. 4 indices); skip any remainder (T103441). */
+    p = drop_non_whitespace(p, end);
+    /* Skip whitespace to get to the next face corner. */
+    p = drop_whitespace(p, end);
+  }
+}
+
+static void geom_add_polygon(Geometry *geom,
+                             const Span<FaceCorner> corners,
+                             const GlobalVertices &global_vertices,
+                             const int material_index,
+                             const int group_index,
+                             const bool shaded_smooth)
+{
+  PolyElem curr_face;
+  curr_face.shaded_smooth = shaded_smooth;
+  curr_face.material_index = material_index;
+  if (group_index >= 0) {
+    curr_face.vertex_group_index = group_index;
+    geom->has_vertex_groups_ = true;
+  }
+
+  const int orig_corners_size = geom->face_corners_.size();
+  curr_face.start_index_ = orig_corners_size;
+
+  bool face_valid = true;
+  for (int i = 0; i < corners.size() && face_valid; i++) {
+    PolyCorner corner = corners[i].corner;
     /* Always keep stored indices non-negative and zero-based. */
     corner.vert_index += corner.vert_index < 0 ? global_vertices.vertices.size() : -1;
     if (corner.vert_index < 0 || corner.vert_index >= global_vertices.vertices.size()) {
@@ -223,7 +258,7 @@ static void geom_add_polygon(Geometry *geom,
       geom->track_vertex_index(corner.vert_index);
     }
     /* Ignore UV index, if the geometry does not have any UVs (T103212). */
-    if (got_uv && !global_vertices.uv_vertices.is_empty()) {
+    if (corners[i].got_uv && !global_vertices.uv_vertices.is_empty()) {
       corner.uv_vert_index += corner.uv_vert_index < 0 ? global_vertices.uv_vertices.size() : -1;
       if (corner.uv_vert_index < 0 || corner.uv_vert_index >= global_vertices.uv_vertices.size()) {
         fprintf(stderr,
@@ -236,7 +271,7 @@ static void geom_add_polygon(Geometry *geom,
     /* Ignore corner normal index, if the geometry does not have any normals.
      * Some obj files out there do have face definitions that refer to normal indices,
      * without any normals being present (T98782). */
-    if (got_normal && !global_vertices.vertex_normals.is_empty()) {
+    if (corners[i].got_normal && !global_vertices.vertex_normals.is_empty()) {
       corner.vertex_normal_index += corner.vertex_normal_index < 0 ?
                                         global_vertices.vertex_normals.size() :
                                         -1;
@@ -251,11 +286,6 @@ static void geom_add_polygon(Geometry *geom,
     }
     geom->face_corners_.append(corner);
     curr_face.corner_count_++;
-
-    /* Some files contain extra stuff per face (e.g. 4 indices); skip any remainder (T103441). */
-    p = drop_non_whitespace(p, end);
-    /* Skip whitespace to get to the next face corner. */
-    p = drop_whitespace(p, end);
   }
 
   if (face_valid) {
@@ -381,7 +411,7 @@ static void geom_new_object(const char *p,
       r_curr_geom, GEOM_MESH, StringRef(p, end).trim(), r_all_geometries);
 }
 
-OBJParser::OBJParser(const OBJImportParams &import_params, size_t read_buffer_size = 64 * 1024)
+OBJParser::OBJParser(const OBJImportParams &import_params, size_t read_buffer_size)
     : import_params_(import_params), read_buffer_size_(read_buffer_size)
 {
   obj_file_ = BLI_fopen(import_params_.filepath, "rb");
@@ -433,6 +463,103 @@ static void use_all_vertices_if_no_faces(Geometry *geom,
   }
 }
 
+/**
+ * A line that depends on the parser state (current object, material, group etc.),
+ * and thus has to be processed in file order.
+ */
+struct StateLine {
+  StringRef text;
+  /* Amount of chunk-local vertex data that precedes this line. */
+  int vertices_before;
+  int uv_vertices_before;
+  int vertex_normals_before;
+  /* Corners in #ParsedChunk::face_corners, for face lines. */
+  IndexRange face_corners;
+  bool is_face = false;
+};
+
+/**
+ * Result of parsing one line-aligned part of the read buffer. Vertex data and face corners
+ * only depend on the text of their own line, so they are parsed for many chunks in parallel;
+ * everything else is recorded and applied afterwards in file order.
+ */
+struct ParsedChunk {
+  Vector<float3> vertices;
+  /* Chunk-local vertex index and linear color, for vertices with `xyzrgb` colors. */
+  Vector<std::pair<int, float3>> vertex_colors;
+  Vector<float2> uv_vertices;
+  Vector<float3> vertex_normals;
+  Vector<FaceCorner> face_corners;
+  Vector<StateLine> state_lines;
+  size_t line_count = 0;
+};
+
+static void parse_chunk(StringRef buffer_str, ParsedChunk &r_chunk)
+{
+  while (!buffer_str.is_empty()) {
+    StringRef line = read_next_line(buffer_str);
+    const char *p = line.begin(), *end = line.end();
+    p = drop_whitespace(p, end);
+    ++r_chunk.line_count;
+    if (p == end) {
+      continue;
+    }
+    /* Most common things that start with 'v': vertices, normals, UVs. */
+    if (*p == 'v') {
+      if (parse_keyword(p, end, "v")) {
+        float3 vert, linear_color;
+        if (parse_vertex(p, end, vert, linear_color)) {
+          r_chunk.vertex_colors.append({int(r_chunk.vertices.size()), linear_color});
+        }
+        r_chunk.vertices.append(vert);
+      }
+      else if (parse_keyword(p, end, "vn")) {
+        r_chunk.vertex_normals.append(parse_vertex_normal(p, end));
+      }
+      else if (parse_keyword(p, end, "vt")) {
+        r_chunk.uv_vertices.append(parse_uv_vertex(p, end));
+      }
+      continue;
+    }
+    /* Plain comments; `#MRGB` colors are handled in order with the other state lines. */
+    if (*p == '#' && !StringRef(p, end).startswith("#MRGB")) {
+      continue;
+    }
+    StateLine state_line;
+    state_line.text = StringRef(p, end);
+    state_line.vertices_before = int(r_chunk.vertices.size());
+    state_line.uv_vertices_before = int(r_chunk.uv_vertices.size());
+    state_line.vertex_normals_before = int(r_chunk.vertex_normals.size());
+    if (parse_keyword(p, end, "f")) {
+      const int64_t corners_start = r_chunk.face_corners.size();
+      parse_face_corners(p, end, r_chunk.face_corners);
+      state_line.face_corners = IndexRange(corners_start,
+                                           r_chunk.face_corners.size() - corners_start);
+      state_line.is_face = true;
+    }
+    r_chunk.state_lines.append(state_line);
+  }
+}
+
+/**
+ * Split the buffer into parts of roughly the given size, ending at line boundaries.
+ * The buffer is expected to end with a newline.
+ */
+static Vector<StringRef> split_at_line_ends(StringRef buffer_str, const int64_t chunk_size)
+{
+  Vector<StringRef> chunks;
+  while (!buffer_str.is_empty()) {
+    int64_t size = std::min(chunk_size, buffer_str.size());
+    const void *newline = memchr(
+        buffer_str.data() + size - 1, '\n', size_t(buffer_str.size() - size + 1));
+    size = newline ? (static_cast<const char *>(newline) - buffer_str.data() + 1) :
+                     buffer_str.size();
+    chunks.append(buffer_str.substr(0, size));
+    buffer_str = buffer_str.drop_prefix(size);
+  }
+  return chunks;
+}
+
 void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
                       GlobalVertices &r_global_vertices)
 {
@@ -455,9 +582,113 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
   string state_material_name;
   int state_material_index = -1;
 
+  /* Process a line that depends on the parser state, in file order. */
+  auto parse_state_line = [&](const ParsedChunk &chunk, const StateLine &state_line) {
+    const char *p = state_line.text.begin(), *end = state_line.text.end();
+    /* Faces. */
+    if (state_line.is_face) {
+      /* If we don't have a material index assigned yet, get one.
+       * It means "usemtl" state came from the previous object. */
+      if (state_material_index == -1 && !state_material_name.empty() &&
+          curr_geom->material_indices_.is_empty()) {
+        curr_geom->material_indices_.add_new(state_material_name, 0);
+        curr_geom->material_order_.append(state_material_name);
+        state_material_index = 0;
+      }
+
+      geom_add_polygon(curr_geom,
+                       chunk.face_corners.as_span().slice(state_line.face_corners),
+                       r_global_vertices,
+                       state_material_index,
+                       state_group_index,
+                       state_shaded_smooth);
+    }
+    /* Faces. */
+    else if (parse_keyword(p, end, "l")) {
+      geom_add_edge(curr_geom, p, end, r_global_vertices);
+    }
+    /* Objects. */
+    else if (parse_keyword(p, end, "o")) {
+      if (import_params_.use_split_objects) {
+        geom_new_object(p,
+                        end,
+                        state_shaded_smooth,
+                        state_group_name,
+                        state_material_index,
+                        curr_geom,
+                        r_all_geometries);
+      }
+    }
+    /* Groups. */
+    else if (parse_keyword(p, end, "g")) {
+      if (import_params_.use_split_groups) {
+        geom_new_object(p,
+                        end,
+                        state_shaded_smooth,
+                        state_group_name,
+                        state_material_index,
+                        curr_geom,
+                        r_all_geometries);
+      }
+      else {
+        geom_update_group(StringRef(p, end).trim(), state_group_name);
+        int new_index = curr_geom->group_indices_.size();
+        state_group_index = curr_geom->group_indices_.lookup_or_add(state_group_name, new_index);
+        if (new_index == state_group_index) {
+          curr_geom->group_order_.append(state_group_name);
+        }
+      }
+    }
+    /* Smoothing groups. */
+    else if (parse_keyword(p, end, "s")) {
+      geom_update_smooth_group(p, end, state_shaded_smooth);
+    }
+    /* Materials and their libraries. */
+    else if (parse_keyword(p, end, "usemtl")) {
+      state_material_name = StringRef(p, end).trim();
+      int new_mat_index = curr_geom->material_indices_.size();
+      state_material_index = curr_geom->material_indices_.lookup_or_add(state_material_name,
+                                                                        new_mat_index);
+      if (new_mat_index == state_material_index) {
+        curr_geom->material_order_.append(state_material_name);
+      }
+    }
+    else if (parse_keyword(p, end, "mtllib")) {
+      add_mtl_library(StringRef(p, end).trim());
+    }
+    else if (parse_keyword(p, end, "#MRGB")) {
+      geom_add_mrgb_colors(p, end, r_global_vertices);
+    }
+    /* Comments. */
+    else if (*p == '#') {
+      /* Nothing to do. */
+    }
+    /* Curve related things. */
+    else if (parse_keyword(p, end, "cstype")) {
+      curr_geom = geom_set_curve_type(curr_geom, p, end, state_group_name, r_all_geometries);
+    }
+    else if (parse_keyword(p, end, "deg")) {
+      geom_set_curve_degree(curr_geom, p, end);
+    }
+    else if (parse_keyword(p, end, "curv")) {
+      geom_add_curve_vertex_indices(curr_geom, p, end, r_global_vertices);
+    }
+    else if (parse_keyword(p, end, "parm")) {
+      geom_add_curve_parameters(curr_geom, p, end);
+    }
+    else if (StringRef(p, end).startswith("end")) {
+      /* End of curve definition, nothing else to do. */
+    }
+    else {
+      std::cout << "OBJ element not recognized: '" << std::string(p, end) << "'" << std::endl;
+    }
+  };
+
   /* Read the input file in chunks. We need up to twice the possible chunk size,
    * to possibly store remainder of the previous input line that got broken mid-chunk. */
   Array<char> buffer(read_buffer_size_ * 2);
+  /* Each read is split into this many parts that are parsed in parallel. */
+  const int64_t parallel_chunk_size = std::max<int64_t>(read_buffer_size_ / 64, 1);
 
   size_t buffer_offset = 0;
   size_t line_number = 0;
@@ -504,127 +735,62 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
     }
     ++last_nl;
 
-    /* Parse the buffer (until last newline) that we have so far,
-     * line by line. */
+    /* Parse the buffer (until last newline) that we have so far: vertex data and face
+     * corners of all parts in parallel, then everything else line by line in file order. */
     StringRef buffer_str{buffer.data(), int64_t(last_nl)};
-    while (!buffer_str.is_empty()) {
-      StringRef line = read_next_line(buffer_str);
-      const char *p = line.begin(), *end = line.end();
-      p = drop_whitespace(p, end);
-      ++line_number;
-      if (p == end) {
-        continue;
-      }
-      /* Most common things that start with 'v': vertices, normals, UVs. */
-      if (*p == 'v') {
-        if (parse_keyword(p, end, "v")) {
-          geom_add_vertex(p, end, r_global_vertices);
-        }
-        else if (parse_keyword(p, end, "vn")) {
-          geom_add_vertex_normal(p, end, r_global_vertices);
-        }
-        else if (parse_keyword(p, end, "vt")) {
-          geom_add_uv_vertex(p, end, r_global_vertices);
-        }
+    const Vector<StringRef> chunk_strs = split_at_line_ends(buffer_str, parallel_chunk_size);
+    Array<ParsedChunk> chunks(chunk_strs.size());
+    threading::parallel_for(chunks.index_range(), 1, [&](IndexRange range) {
+      for (const int64_t i : range) {
+        parse_chunk(chunk_strs[i], chunks[i]);
       }
-      /* Faces. */
-      else if (parse_keyword(p, end, "f")) {
-        /* If we don't have a material index assigned yet, get one.
-         * It means "usemtl" state came from the previous object. */
-        if (state_material_index == -1 && !state_material_name.empty() &&
-            curr_geom->material_indices_.is_empty()) {
-          curr_geom->material_indices_.add_new(state_material_name, 0);
-          curr_geom->material_order_.append(state_material_name);
-          state_material_index = 0;
-        }
-
-        geom_add_polygon(curr_geom,
-                         p,
-                         end,
-                         r_global_vertices,
-                         state_material_index,
-                         state_group_index,
-                         state_shaded_smooth);
-      }
-      /* Faces. */
-      else if (parse_keyword(p, end, "l")) {
-        geom_add_edge(curr_geom, p, end, r_global_vertices);
-      }
-      /* Objects. */
-      else if (parse_keyword(p, end, "o")) {
-        if (import_params_.use_split_objects) {
-          geom_new_object(p,
-                          end,
-                          state_shaded_smooth,
-                          state_group_name,
-                          state_material_index,
-                          curr_geom,
-                          r_all_geometries);
-        }
-      }
-      /* Groups. */
-      else if (parse_keyword(p, end, "g")) {
-        if (import_params_.use_split_groups) {
-          geom_new_object(p,
-                          end,
-                          state_shaded_smooth,
-                          state_group_name,
-                          state_material_index,
-                          curr_geom,
-                          r_all_geometries);
-        }
-        else {
-          geom_update_group(StringRef(p, end).trim(), state_group_name);
-          int new_index = curr_geom->group_indices_.size();
-          state_group_index = curr_geom->group_indices_.lookup_or_add(state_group_name, new_index);
-          if (new_index == state_group_index) {
-            curr_geom->group_order_.append(state_group_name);
+    });
+
+    for (const ParsedChunk &chunk : chunks) {
+      const int vertices_start = int(r_global_vertices.vertices.size());
+      int vertices_added = 0, uv_vertices_added = 0, vertex_normals_added = 0;
+      int colors_added = 0;
+      /* Move the chunk's vertex data that precedes a state line into the global lists,
+       * so that relative indices and vertex colors refer to the right elements. */
+      auto add_vertex_data = [&](const int vertices_end,
+                                 const int uv_vertices_end,
+                                 const int vertex_normals_end) {
+        while (vertices_added < vertices_end) {
+          int next_colored = vertices_end;
+          if (colors_added < chunk.vertex_colors.size()) {
+            next_colored = std::min(next_colored, chunk.vertex_colors[colors_added].first);
+          }
+          r_global_vertices.vertices.extend(
+              chunk.vertices.as_span().slice(vertices_added, next_colored - vertices_added));
+          vertices_added = next_colored;
+          if (vertices_added < vertices_end) {
+            r_global_vertices.vertices.append(chunk.vertices[vertices_added]);
+            geom_add_last_vertex_color(chunk.vertex_colors[colors_added].second,
+                                       r_global_vertices);
+            vertices_added++;
+            colors_added++;
           }
         }
+        r_global_vertices.uv_vertices.extend(chunk.uv_vertices.as_span().slice(
+            uv_vertices_added, uv_vertices_end - uv_vertices_added));
+        uv_vertices_added = uv_vertices_end;
+        r_global_vertices.vertex_normals.extend(chunk.vertex_normals.as_span().slice(
+            vertex_normals_added, vertex_normals_end - vertex_normals_added));
+        vertex_normals_added = vertex_normals_end;
+      };
+
+      for (const StateLine &state_line : chunk.state_lines) {
+        add_vertex_data(state_line.vertices_before,
+                        state_line.uv_vertices_before,
+                        state_line.vertex_normals_before);
+        parse_state_line(chunk, state_line);
       }
-      /* Smoothing groups. */
-      else if (parse_keyword(p, end, "s")) {
-        geom_update_smooth_group(p, end, state_shaded_smooth);
-      }
-      /* Materials and their libraries. */
-      else if (parse_keyword(p, end, "usemtl")) {
-        state_material_name = StringRef(p, end).trim();
-        int new_mat_index = curr_geom->material_indices_.size();
-        state_material_index = curr_geom->material_indices_.lookup_or_add(state_material_name,
-                                                                          new_mat_index);
-        if (new_mat_index == state_material_index) {
-          curr_geom->material_order_.append(state_material_name);
-        }
-      }
-      else if (parse_keyword(p, end, "mtllib")) {
-        add_mtl_library(StringRef(p, end).trim());
-      }
-      else if (parse_keyword(p, end, "#MRGB")) {
-        geom_add_mrgb_colors(p, end, r_global_vertices);
-      }
-      /* Comments. */
-      else if (*p == '#') {
-        /* Nothing to do. */
-      }
-      /* Curve related things. */
-      else if (parse_keyword(p, end, "cstype")) {
-        curr_geom = geom_set_curve_type(curr_geom, p, end, state_group_name, r_all_geometries);
-      }
-      else if (parse_keyword(p, end, "deg")) {
-        geom_set_curve_degree(curr_geom, p, end);
-      }
-      else if (parse_keyword(p, end, "curv")) {
-        geom_add_curve_vertex_indices(curr_geom, p, end, r_global_vertices);
-      }
-      else if (parse_keyword(p, end, "parm")) {
-        geom_add_curve_parameters(curr_geom, p, end);
-      }
-      else if (StringRef(p, end).startswith("end")) {
-        /* End of curve definition, nothing else to do. */
-      }
-      else {
-        std::cout << "OBJ element not recognized: '" << std::string(p, end) << "'" << std::endl;
-      }
+      add_vertex_data(int(chunk.vertices.size()),
+                      int(chunk.uv_vertices.size()),
+                      int(chunk.vertex_normals.size()));
+      BLI_assert(r_global_vertices.vertices.size() == vertices_start + chunk.vertices.size());
+      UNUSED_VARS_NDEBUG(vertices_start);
+      line_number += chunk.line_count;
     }
 
     /* We might have a line that was cut in the middle by the previous buffer;
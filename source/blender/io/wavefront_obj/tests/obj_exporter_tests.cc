@@ -214,6 +214,21 @@ parm u 0.0
   ASSERT_EQ(got_string, expected);
 }
 
+TEST(obj_exporter_writer, format_handler_reserve)
+{
+  /* Text that fits into the reserved size ends up in one block, even with tiny chunks. */
+  FormatHandler h(16);
+  h.reserve(64);
+  h.write_obj_object("abc");
+  h.write_obj_object("abcdef");
+  h.write_obj_vertex(1.0f, 2.0f, 3.0f);
+
+  ASSERT_EQ(h.get_block_count(), 1);
+  const std::string got_string = h.get_as_string();
+  ASSERT_EQ(got_string, "o abc\no abcdef\nv 1.000000 2.000000 3.000000\n");
+  ASSERT_EQ(h.get_size(), got_string.size());
+}
+
 /* Return true if string #a and string #b are equal after their first newline. */
 static bool strings_equal_after_first_lines(const std::string &a, const std::string &b)
 {
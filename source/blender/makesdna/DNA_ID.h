@@ -347,7 +347,12 @@ typedef struct IDOverrideLibrary {
   IDOverrideLibraryRuntime *runtime;
 
   unsigned int flag;
-  char _pad_1[4];
+  /**
+   * The #ID_Runtime.lib_data_hash of the reference when this override was last updated from it.
+   * When it still matches on file load, the override data stored in the file is up to date and
+   * does not need to be re-generated from the reference.
+   */
+  unsigned int reference_data_hash;
 } IDOverrideLibrary;
 
 /* IDOverrideLibrary->flag */
@@ -398,6 +403,15 @@ typedef struct ID_Runtime_Remap {
 
 typedef struct ID_Runtime {
   ID_Runtime_Remap remap;
+  /**
+   * For linked data-blocks that are the reference of a local library override, hash of their data
+   * as stored in the library file. Zero for all other data-blocks, or if the data-block was
+   * modified since it was read (e.g. linked overrides that were updated).
+   * Used to detect unchanged references of library overrides, see
+   * #IDOverrideLibrary.reference_data_hash.
+   */
+  unsigned int lib_data_hash;
+  char _pad[4];
 } ID_Runtime;
 
 /* There's a nasty circular dependency here.... 'void *' to the rescue! I
@@ -743,6 +757,14 @@ enum {
    * RESET_AFTER_USE
    */
   LIB_TAG_NEED_LINK = 1 << 5,
+  /**
+   * Tag used internally in readfile.c, to mark ID placeholders for linked data-blocks that are the
+   * reference of a local library override. Their data is hashed when they are read, see
+   * #ID_Runtime.lib_data_hash.
+   *
+   * RESET_AFTER_USE
+   */
+  LIB_TAG_NEED_DATA_HASH = 1 << 23,
 
   /**
    * ID is a place-holder, an 'empty shell' (because the real one could not be linked from its
@@ -122,6 +122,26 @@ void *DNA_struct_reconstruct(const struct DNA_ReconstructInfo *reconstruct_info,
                              int old_struct_nr,
                              int blocks,
                              const void *old_blocks);
+/**
+ * \return The size of a reconstructed struct, or zero when the struct doesn't exist in the new
+ * SDNA anymore.
+ */
+int DNA_struct_reconstruct_size(const struct DNA_ReconstructInfo *reconstruct_info,
+                                int old_struct_nr);
+/**
+ * Reconstruct the blocks `[blocks_start, blocks_start + blocks)` only, so that large arrays can
+ * be reconstructed from multiple threads.
+ *
+ * \param old_blocks: Array of all old struct data.
+ * \param new_blocks: Zero initialized array for all reconstructed structs,
+ * see #DNA_struct_reconstruct_size.
+ */
+void DNA_struct_reconstruct_range(const struct DNA_ReconstructInfo *reconstruct_info,
+                                  int old_struct_nr,
+                                  int blocks_start,
+                                  int blocks,
+                                  const void *old_blocks,
+                                  void *new_blocks);
 
 /**
  * Returns the offset of the field with the specified name and type within the specified
@@ -2308,6 +2308,19 @@ typedef struct NodesModifierData {
   struct bNodeTree *node_group;
   struct NodesModifierSettings settings;
 
+  /**
+   * Directory in which the evaluated geometry of every frame is cached, when
+   * #NODES_MODIFIER_USE_CACHE is enabled. FILE_MAX.
+   */
+  char cache_directory[1024];
+  /** #NodesModifierFlag. */
+  int flag;
+  /**
+   * Incremented when the cached geometry becomes invalid, e.g. because the node group changed.
+   * Cache files written for another generation are not used.
+   */
+  int cache_generation;
+
   /**
    * Contains logged information from the last evaluation.
    * This can be used to help the user to debug a node tree.
@@ -2316,6 +2329,11 @@ typedef struct NodesModifierData {
   void *_pad1;
 } NodesModifierData;
 
+/** #NodesModifierData.flag */
+typedef enum NodesModifierFlag {
+  NODES_MODIFIER_USE_CACHE = (1 << 0),
+} NodesModifierFlag;
+
 typedef struct MeshToVolumeModifierData {
   ModifierData modifier;
 
@@ -1113,6 +1113,12 @@ typedef struct ReconstructStep {
   } data;
 } ReconstructStep;
 
+/**
+ * Nested structs are inlined into the steps of the parent struct when this doesn't create more
+ * steps than this, see #inline_substruct_steps.
+ */
+#define RECONSTRUCT_INLINE_MAX_STEPS 64
+
 typedef struct DNA_ReconstructInfo {
   const SDNA *oldsdna;
   const SDNA *newsdna;
@@ -1211,28 +1217,63 @@ static void reconstruct_structs(const DNA_ReconstructInfo *reconstruct_info,
   }
 }
 
-void *DNA_struct_reconstruct(const DNA_ReconstructInfo *reconstruct_info,
-                             int old_struct_nr,
-                             int blocks,
-                             const void *old_blocks)
+/** Find the struct in the new SDNA matching the given old one. */
+static int reconstruct_new_struct_nr(const DNA_ReconstructInfo *reconstruct_info,
+                                     const int old_struct_nr)
 {
   const SDNA *oldsdna = reconstruct_info->oldsdna;
-  const SDNA *newsdna = reconstruct_info->newsdna;
-
   const SDNA_Struct *old_struct = oldsdna->structs[old_struct_nr];
   const char *type_name = oldsdna->types[old_struct->type];
-  const int new_struct_nr = DNA_struct_find_nr(newsdna, type_name);
+  return DNA_struct_find_nr(reconstruct_info->newsdna, type_name);
+}
 
+int DNA_struct_reconstruct_size(const DNA_ReconstructInfo *reconstruct_info, int old_struct_nr)
+{
+  const int new_struct_nr = reconstruct_new_struct_nr(reconstruct_info, old_struct_nr);
   if (new_struct_nr == -1) {
-    return NULL;
+    return 0;
   }
+  const SDNA *newsdna = reconstruct_info->newsdna;
+  return newsdna->types_size[newsdna->structs[new_struct_nr]->type];
+}
 
-  const SDNA_Struct *new_struct = newsdna->structs[new_struct_nr];
-  const int new_block_size = newsdna->types_size[new_struct->type];
+void DNA_struct_reconstruct_range(const DNA_ReconstructInfo *reconstruct_info,
+                                  int old_struct_nr,
+                                  int blocks_start,
+                                  int blocks,
+                                  const void *old_blocks,
+                                  void *new_blocks)
+{
+  const int new_struct_nr = reconstruct_new_struct_nr(reconstruct_info, old_struct_nr);
+  if (new_struct_nr == -1) {
+    return;
+  }
+
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
+  const int old_block_size = oldsdna->types_size[oldsdna->structs[old_struct_nr]->type];
+  const int new_block_size = newsdna->types_size[newsdna->structs[new_struct_nr]->type];
+
+  reconstruct_structs(reconstruct_info,
+                      blocks,
+                      old_struct_nr,
+                      new_struct_nr,
+                      (const char *)old_blocks + (size_t)blocks_start * (size_t)old_block_size,
+                      (char *)new_blocks + (size_t)blocks_start * (size_t)new_block_size);
+}
+
+void *DNA_struct_reconstruct(const DNA_ReconstructInfo *reconstruct_info,
+                             int old_struct_nr,
+                             int blocks,
+                             const void *old_blocks)
+{
+  const int new_block_size = DNA_struct_reconstruct_size(reconstruct_info, old_struct_nr);
+  if (new_block_size == 0) {
+    return NULL;
+  }
 
   char *new_blocks = MEM_callocN(blocks * new_block_size, "reconstruct");
-  reconstruct_structs(
-      reconstruct_info, blocks, old_struct_nr, new_struct_nr, old_blocks, new_blocks);
+  DNA_struct_reconstruct_range(reconstruct_info, old_struct_nr, 0, blocks, old_blocks, new_blocks);
   return new_blocks;
 }
 
@@ -1508,6 +1549,110 @@ static int compress_reconstruct_steps(ReconstructStep *steps, const int old_step
   return new_step_count;
 }
 
+/** Move the offsets of a step that is copied into the steps of a parent struct. */
+static void offset_reconstruct_step(ReconstructStep *step, const int old_ofs, const int new_ofs)
+{
+  switch (step->type) {
+    case RECONSTRUCT_STEP_MEMCPY:
+      step->data.memcpy.old_offset += old_ofs;
+      step->data.memcpy.new_offset += new_ofs;
+      break;
+    case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+      step->data.cast_primitive.old_offset += old_ofs;
+      step->data.cast_primitive.new_offset += new_ofs;
+      break;
+    case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
+    case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
+      step->data.cast_pointer.old_offset += old_ofs;
+      step->data.cast_pointer.new_offset += new_ofs;
+      break;
+    case RECONSTRUCT_STEP_SUBSTRUCT:
+      step->data.substruct.old_offset += old_ofs;
+      step->data.substruct.new_offset += new_ofs;
+      break;
+    case RECONSTRUCT_STEP_INIT_ZERO:
+      break;
+  }
+}
+
+/**
+ * Replace the steps reconstructing nested structs with the steps of those structs, so that
+ * consecutive members of parent and nested structs are merged into a single #memcpy, and no
+ * recursion is necessary for every block. Large nested arrays are kept as a single step.
+ */
+static void inline_substruct_steps(DNA_ReconstructInfo *reconstruct_info,
+                                   const int new_struct_nr,
+                                   bool *is_inlined)
+{
+  if (is_inlined[new_struct_nr]) {
+    return;
+  }
+  is_inlined[new_struct_nr] = true;
+
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
+  ReconstructStep *steps = reconstruct_info->steps[new_struct_nr];
+  const int step_count = reconstruct_info->step_counts[new_struct_nr];
+
+  /* Count the steps after inlining, nested structs are inlined first. */
+  int new_step_count = 0;
+  bool has_inlined = false;
+  for (int a = 0; a < step_count; a++) {
+    const ReconstructStep *step = &steps[a];
+    if (step->type == RECONSTRUCT_STEP_SUBSTRUCT) {
+      const int sub_struct_nr = step->data.substruct.new_struct_nr;
+      inline_substruct_steps(reconstruct_info, sub_struct_nr, is_inlined);
+      const int sub_steps_len = reconstruct_info->step_counts[sub_struct_nr] *
+                                step->data.substruct.array_len;
+      if (sub_steps_len <= RECONSTRUCT_INLINE_MAX_STEPS) {
+        new_step_count += sub_steps_len;
+        has_inlined = true;
+        continue;
+      }
+    }
+    new_step_count++;
+  }
+  if (!has_inlined) {
+    return;
+  }
+
+  ReconstructStep *new_steps = MEM_malloc_arrayN(
+      MAX2(new_step_count, 1), sizeof(ReconstructStep), __func__);
+  int new_step_index = 0;
+  for (int a = 0; a < step_count; a++) {
+    const ReconstructStep *step = &steps[a];
+    if (step->type == RECONSTRUCT_STEP_SUBSTRUCT) {
+      const int sub_struct_nr = step->data.substruct.new_struct_nr;
+      const ReconstructStep *sub_steps = reconstruct_info->steps[sub_struct_nr];
+      const int sub_step_count = reconstruct_info->step_counts[sub_struct_nr];
+      const int array_len = step->data.substruct.array_len;
+      if (sub_step_count * array_len <= RECONSTRUCT_INLINE_MAX_STEPS) {
+        const SDNA_Struct *old_sub_struct = oldsdna->structs[step->data.substruct.old_struct_nr];
+        const SDNA_Struct *new_sub_struct = newsdna->structs[sub_struct_nr];
+        const int old_sub_size = oldsdna->types_size[old_sub_struct->type];
+        const int new_sub_size = newsdna->types_size[new_sub_struct->type];
+        for (int elem = 0; elem < array_len; elem++) {
+          for (int b = 0; b < sub_step_count; b++) {
+            ReconstructStep *new_step = &new_steps[new_step_index++];
+            *new_step = sub_steps[b];
+            offset_reconstruct_step(new_step,
+                                    step->data.substruct.old_offset + elem * old_sub_size,
+                                    step->data.substruct.new_offset + elem * new_sub_size);
+          }
+        }
+        continue;
+      }
+    }
+    new_steps[new_step_index++] = *step;
+  }
+  BLI_assert(new_step_index == new_step_count);
+
+  MEM_freeN(steps);
+  reconstruct_info->steps[new_struct_nr] = new_steps;
+  reconstruct_info->step_counts[new_struct_nr] = compress_reconstruct_steps(new_steps,
+                                                                            new_step_count);
+}
+
 DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
                                                  const SDNA *newsdna,
                                                  const char *compare_flags)
@@ -1552,6 +1697,15 @@ DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
     UNUSED_VARS(print_reconstruct_step);
   }
 
+  /* Inline nested structs once all steps exist. */
+  bool *is_inlined = MEM_callocN(sizeof(bool) * (size_t)newsdna->structs_len, __func__);
+  for (int new_struct_nr = 0; new_struct_nr < newsdna->structs_len; new_struct_nr++) {
+    if (reconstruct_info->steps[new_struct_nr] != NULL) {
+      inline_substruct_steps(reconstruct_info, new_struct_nr, is_inlined);
+    }
+  }
+  MEM_freeN(is_inlined);
+
   return reconstruct_info;
 }
 
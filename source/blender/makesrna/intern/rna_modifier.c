@@ -1679,6 +1679,14 @@ static void rna_NodesModifier_node_group_update(Main *bmain, Scene *scene, Point
   MOD_nodes_update_interface(object, nmd);
 }
 
+static void rna_NodesModifier_cache_update(Main *bmain, Scene *scene, PointerRNA *ptr)
+{
+  Object *object = (Object *)ptr->owner_id;
+  NodesModifierData *nmd = ptr->data;
+  MOD_nodes_cache_invalidate(object, nmd);
+  rna_Modifier_update(bmain, scene, ptr);
+}
+
 static IDProperty **rna_NodesModifier_properties(PointerRNA *ptr)
 {
   NodesModifierData *nmd = ptr->data;
@@ -7033,6 +7041,20 @@ static void rna_def_modifier_nodes(BlenderRNA *brna)
   RNA_def_property_flag(prop, PROP_EDITABLE);
   RNA_def_property_update(prop, 0, "rna_NodesModifier_node_group_update");
 
+  prop = RNA_def_property(srna, "use_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NODES_MODIFIER_USE_CACHE);
+  RNA_def_property_ui_text(
+      prop,
+      "Use Cache",
+      "Store the evaluated geometry of every frame on disk, and read it from there when the "
+      "frame is evaluated again with the same inputs");
+  RNA_def_property_update(prop, 0, "rna_NodesModifier_cache_update");
+
+  prop = RNA_def_property(srna, "cache_directory", PROP_STRING, PROP_DIRPATH);
+  RNA_def_property_string_sdna(prop, NULL, "cache_directory");
+  RNA_def_property_ui_text(prop, "Cache Directory", "Directory to store the cached geometry in");
+  RNA_def_property_update(prop, 0, "rna_NodesModifier_cache_update");
+
   RNA_define_lib_overridable(false);
 }
 
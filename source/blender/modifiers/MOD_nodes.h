@@ -16,6 +16,13 @@ extern "C" {
  */
 void MOD_nodes_update_interface(struct Object *object, struct NodesModifierData *nmd);
 
+/**
+ * Mark the geometry cached on disk for the modifier as outdated, so that it is computed again
+ * (see #NODES_MODIFIER_USE_CACHE). Also tags the object for an update, so that the evaluated
+ * modifier gets the new cache generation.
+ */
+void MOD_nodes_cache_invalidate(struct Object *object, struct NodesModifierData *nmd);
+
 #ifdef __cplusplus
 }
 #endif
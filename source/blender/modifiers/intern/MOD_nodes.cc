@@ -7,14 +7,19 @@
 
 #include <cstring>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include "MEM_guardedalloc.h"
 
 #include "BLI_array.hh"
+#include "BLI_hash.hh"
+#include "BLI_hash_mm2a.h"
 #include "BLI_listbase.h"
 #include "BLI_math_vector_types.hh"
 #include "BLI_multi_value_map.hh"
+#include "BLI_path_util.h"
+#include "BLI_serialize.hh"
 #include "BLI_set.hh"
 #include "BLI_string.h"
 #include "BLI_string_search.h"
@@ -40,6 +45,7 @@
 #include "BKE_compute_contexts.hh"
 #include "BKE_customdata.h"
 #include "BKE_geometry_fields.hh"
+#include "BKE_geometry_set_cache.hh"
 #include "BKE_geometry_set_instances.hh"
 #include "BKE_global.h"
 #include "BKE_idprop.hh"
@@ -1234,6 +1240,120 @@ static GeometrySet compute_geometry(
   return output_geometry_set;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Disk Cache
+ *
+ * When enabled, the evaluated geometry of every frame is written to a file in the cache
+ * directory, and read from there instead of being evaluated again when the frame is evaluated
+ * later. Cache files are only used when they were computed from the same state, see
+ * #cache_key_compute.
+ * \{ */
+
+void MOD_nodes_cache_invalidate(Object *object, NodesModifierData *nmd)
+{
+  nmd->cache_generation++;
+  /* The cache key is computed from the evaluated modifier. Editing a node group does not copy the
+   * objects using it again, so the new generation has to be copied explicitly. */
+  DEG_id_tag_update(&object->id, ID_RECALC_GEOMETRY);
+}
+
+static bool cache_enabled(const NodesModifierData &nmd, const ModifierEvalContext &ctx)
+{
+  if ((nmd.flag & NODES_MODIFIER_USE_CACHE) == 0 || nmd.cache_directory[0] == '\0') {
+    return false;
+  }
+  if ((ctx.flag & MOD_APPLY_ORCO) != 0) {
+    return false;
+  }
+  /* Sub-frames (e.g. for motion blur) are not cached. */
+  const float frame = DEG_get_ctime(ctx.depsgraph);
+  return frame == floorf(frame);
+}
+
+static std::string cache_file_path(const NodesModifierData &nmd, const ModifierEvalContext &ctx)
+{
+  char directory[FILE_MAX];
+  STRNCPY(directory, nmd.cache_directory);
+  BLI_path_abs(directory, BKE_main_blendfile_path(DEG_get_bmain(ctx.depsgraph)));
+
+  /* Every modifier has its own sub-directory, so that the same directory can be used for many
+   * modifiers. */
+  char object_name[MAX_ID_NAME];
+  STRNCPY(object_name, ctx.object->id.name + 2);
+  BLI_filename_make_safe(object_name);
+  char modifier_name[MAX_NAME];
+  STRNCPY(modifier_name, nmd.modifier.name);
+  BLI_filename_make_safe(modifier_name);
+  char file_name[FILE_MAXFILE];
+  SNPRINTF(file_name, "%06d.bgc", int(DEG_get_ctime(ctx.depsgraph)));
+
+  char filepath[FILE_MAX];
+  BLI_path_join(filepath, sizeof(filepath), directory, object_name, modifier_name, file_name);
+  return filepath;
+}
+
+/**
+ * Compute a value that changes when the result of the evaluation may change for reasons other
+ * than the frame: changes of the node group (tracked with #NodesModifierData.cache_generation),
+ * of the modifier inputs, of the input geometry, of the object transform, or of the evaluation
+ * mode (viewport or render). The file path is included, so that copies of the .blend file that
+ * share the same cache directory don't use each other's results.
+ *
+ * Changes of other data-blocks used by the node group are not detected. The cache can be
+ * invalidated manually in that case, by toggling it.
+ */
+static uint64_t cache_key_compute(const NodesModifierData &nmd,
+                                  const ModifierEvalContext &ctx,
+                                  const GeometrySet &input_geometry)
+{
+  const Main *bmain = DEG_get_bmain(ctx.depsgraph);
+  uint64_t key = blender::get_default_hash_4(nmd.cache_generation,
+                                             StringRef(nmd.node_group->id.name),
+                                             int(DEG_get_mode(ctx.depsgraph)),
+                                             StringRef(BKE_main_blendfile_path(bmain)));
+  key = blender::get_default_hash_2(
+      key,
+      BLI_hash_mm2(reinterpret_cast<const uchar *>(ctx.object->object_to_world),
+                   sizeof(ctx.object->object_to_world),
+                   0));
+
+  if (nmd.settings.properties != nullptr && nmd.settings.properties->data.group.first) {
+    const IDProperty *first_property = static_cast<const IDProperty *>(
+        nmd.settings.properties->data.group.first);
+    std::stringstream stream;
+    blender::io::serialize::JsonFormatter formatter;
+    formatter.serialize(stream,
+                        *blender::bke::idprop::convert_to_serialize_values(first_property));
+    key = blender::get_default_hash_2(key, stream.str());
+    /* Data-block properties are not serialized, so add their names separately. */
+    LISTBASE_FOREACH (const IDProperty *, property, &nmd.settings.properties->data.group) {
+      if (property->type == IDP_ID && IDP_Id(property) != nullptr) {
+        key = blender::get_default_hash_2(key, StringRef(IDP_Id(property)->name));
+      }
+    }
+  }
+
+  /* All attributes, topology and instances of the input geometry. */
+  return blender::get_default_hash_2(key, blender::bke::geometry_cache_hash(input_geometry));
+}
+
+static std::optional<GeometrySet> cache_read(const std::string &filepath,
+                                             const uint64_t key,
+                                             const ModifierEvalContext &ctx)
+{
+  Main *bmain = DEG_get_bmain(ctx.depsgraph);
+  return blender::bke::geometry_cache_read(
+      filepath, key, [&](const ID_Type id_type, const StringRef name) -> ID * {
+        ID *id = BKE_libblock_find_name(bmain, short(id_type), std::string(name).c_str());
+        if (id == nullptr) {
+          return nullptr;
+        }
+        return DEG_get_evaluated_id(ctx.depsgraph, id);
+      });
+}
+
+/** \} */
+
 /**
  * \note This could be done in #initialize_group_input, though that would require adding the
  * the object as a parameter, so it's likely better to this check as a separate step.
@@ -1331,8 +1451,26 @@ static void modifyGeometry(ModifierData *md,
     use_orig_index_polys = CustomData_has_layer(&mesh->pdata, CD_ORIGINDEX);
   }
 
-  geometry_set = compute_geometry(
-      tree, *lf_graph_info, *output_node, std::move(geometry_set), nmd, ctx);
+  std::string cache_filepath;
+  uint64_t cache_key = 0;
+  std::optional<GeometrySet> cached_geometry;
+  if (cache_enabled(*nmd, *ctx)) {
+    cache_filepath = cache_file_path(*nmd, *ctx);
+    cache_key = cache_key_compute(*nmd, *ctx, geometry_set);
+    cached_geometry = cache_read(cache_filepath, cache_key, *ctx);
+  }
+
+  if (cached_geometry) {
+    geometry_set = std::move(*cached_geometry);
+  }
+  else {
+    geometry_set = compute_geometry(
+        tree, *lf_graph_info, *output_node, std::move(geometry_set), nmd, ctx);
+    if (!cache_filepath.empty()) {
+      /* Writing the file would slow down evaluation, so it is done in the background. */
+      blender::bke::geometry_cache_write_async(geometry_set, std::move(cache_filepath), cache_key);
+    }
+  }
 
   if (use_orig_index_verts || use_orig_index_edges || use_orig_index_polys) {
     if (Mesh *mesh = geometry_set.get_mesh_for_write()) {
@@ -1830,6 +1968,27 @@ static void internal_dependencies_panel_draw(const bContext * /*C*/, Panel *pane
   }
 }
 
+static void cache_panel_draw_header(const bContext * /*C*/, Panel *panel)
+{
+  uiLayout *layout = panel->layout;
+
+  PointerRNA *ptr = modifier_panel_get_property_pointers(panel, nullptr);
+
+  uiItemR(layout, ptr, "use_cache", 0, IFACE_("Disk Cache"), ICON_NONE);
+}
+
+static void cache_panel_draw(const bContext * /*C*/, Panel *panel)
+{
+  uiLayout *layout = panel->layout;
+
+  PointerRNA *ptr = modifier_panel_get_property_pointers(panel, nullptr);
+
+  uiLayoutSetPropSep(layout, true);
+  uiLayoutSetActive(layout, RNA_boolean_get(ptr, "use_cache"));
+
+  uiItemR(layout, ptr, "cache_directory", 0, nullptr, ICON_NONE);
+}
+
 static void panelRegister(ARegionType *region_type)
 {
   PanelType *panel_type = modifier_panel_register(region_type, eModifierType_Nodes, panel_draw);
@@ -1845,6 +2004,8 @@ static void panelRegister(ARegionType *region_type)
                              nullptr,
                              internal_dependencies_panel_draw,
                              panel_type);
+  modifier_subpanel_register(
+      region_type, "cache", "", cache_panel_draw_header, cache_panel_draw, panel_type);
 }
 
 static void blendWrite(BlendWriter *writer, const ID * /*id_owner*/, const ModifierData *md)
@@ -12,6 +12,12 @@ extern struct bNodeTreeType *ntreeType_Geometry;
 
 void register_node_type_geo_custom_group(bNodeType *ntype);
 
+/**
+ * Collect timings of all geometry node executions and write them to the given file on exit.
+ * See `NOD_geometry_nodes_profile.hh`.
+ */
+void NOD_geometry_nodes_profile_enable(const char *filepath);
+
 #ifdef __cplusplus
 }
 #endif
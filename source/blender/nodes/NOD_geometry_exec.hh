@@ -66,6 +66,8 @@ class GeoNodeExecParams {
   const lf::Context &lf_context_;
   const Map<StringRef, int> &lf_input_for_output_bsocket_usage_;
   const Map<StringRef, int> &lf_input_for_attribute_propagation_to_output_;
+  /** Number of elements in the output geometries, used for profiling. */
+  int64_t output_elements_num_ = 0;
 
  public:
   GeoNodeExecParams(const bNode &node,
@@ -165,12 +167,22 @@ class GeoNodeExecParams {
 #endif
       if constexpr (std::is_same_v<StoredT, GeometrySet>) {
         this->check_output_geometry_set(value);
+        this->count_output_elements(value);
       }
       const int index = this->get_output_index(identifier);
       params_.set_output(index, std::forward<T>(value));
     }
   }
 
+  /**
+   * Number of elements of all geometries that have been output so far. See
+   * #geo_eval_profile::geometry_elements_num.
+   */
+  int64_t output_elements_num() const
+  {
+    return output_elements_num_;
+  }
+
   geo_eval_log::GeoTreeLogger *get_local_tree_logger() const
   {
     GeoNodesLFUserData *user_data = this->user_data();
@@ -321,6 +333,8 @@ class GeoNodeExecParams {
   void check_input_access(StringRef identifier, const CPPType *requested_type = nullptr) const;
   void check_output_access(StringRef identifier, const CPPType &value_type) const;
 
+  void count_output_elements(const GeometrySet &geometry_set);
+
   /* Find the active socket with the input name (not the identifier). */
   const bNodeSocket *find_available_socket(const StringRef name) const;
 
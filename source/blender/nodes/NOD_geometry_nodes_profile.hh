@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/**
+ * Optional profiling of geometry nodes evaluation, used to find the nodes that are the bottleneck
+ * in large node trees.
+ *
+ * Unlike the execution times in #GeoTreeLogger, which only exist for the last evaluation and are
+ * displayed in the node editor, the profile accumulates samples of all evaluations (e.g. all
+ * frames of an animation render) until it is written to a file. Every node execution results in
+ * one sample that contains the wall time, the CPU time and the change in memory usage of the
+ * executing thread and the number of output geometry elements.
+ *
+ * The file uses the Chrome trace event format, so it can be opened in `chrome://tracing`, Perfetto
+ * and similar tools, where every thread that executed nodes is shown on a separate track. In
+ * addition to the trace events, the file contains per-node totals over all samples in a
+ * `nodeStatistics` array.
+ *
+ * Profiling is enabled with the `--profile-geometry-nodes` command line argument. When it is
+ * disabled, the overhead is a single check for every executed node.
+ */
+
+#include <chrono>
+#include <string>
+
+#include "BLI_string_ref.hh"
+
+#include "NOD_geometry_nodes_log.hh"
+
+struct bNode;
+struct GeometrySet;
+
+namespace blender::nodes {
+struct GeoNodesModifierData;
+}
+
+namespace blender::nodes::geo_eval_profile {
+
+using geo_eval_log::Clock;
+using geo_eval_log::TimePoint;
+
+/**
+ * Start collecting samples. The profile is written to the given file when Blender exits.
+ */
+void enable(StringRefNull filepath);
+bool is_enabled();
+/**
+ * Stop collecting samples and discard the samples collected so far, without writing them.
+ */
+void disable();
+
+/** Measurements of a single node execution. */
+struct NodeSample {
+  std::string object_name;
+  std::string tree_name;
+  std::string node_name;
+  float frame = 0.0f;
+  TimePoint start;
+  TimePoint end;
+  /** CPU time of the thread that executed the node. */
+  std::chrono::nanoseconds cpu_time{0};
+  /**
+   * Memory allocated minus memory freed by the thread that executed the node. Allocations of
+   * work that the node hands to other threads are not included. Only available when the
+   * lock-free allocator is used, zero otherwise.
+   */
+  int64_t memory_delta = 0;
+  int64_t elements_num = 0;
+};
+
+/**
+ * Add a sample to the profile of the calling thread. Must only be called when profiling is
+ * enabled.
+ */
+void add_sample(NodeSample sample);
+
+/**
+ * Measurements taken right before a node is executed. The wall time is passed separately, because
+ * it is measured for #GeoTreeLogger anyway.
+ */
+struct NodeExecutionStart {
+  std::chrono::nanoseconds cpu_time{0};
+  int64_t thread_memory_in_use = 0;
+};
+
+NodeExecutionStart node_execution_begin();
+
+/**
+ * Add a sample for a node execution to the profile of the current thread.
+ * \param elements_num: Number of elements in the geometries that are output by the node.
+ */
+void node_execution_end(const NodeExecutionStart &start,
+                        TimePoint start_time,
+                        TimePoint end_time,
+                        const bNode &node,
+                        const GeoNodesModifierData &modifier_data,
+                        int64_t elements_num);
+
+/**
+ * Number of elements that are counted as being processed when the geometry is output by a node.
+ * This is the number of points of the mesh, curves and point cloud components and the number of
+ * instances.
+ */
+int64_t geometry_elements_num(const GeometrySet &geometry);
+
+/**
+ * Write all samples collected so far to a file.
+ * \return False if the file could not be written.
+ */
+bool write(StringRefNull filepath);
+
+}  // namespace blender::nodes::geo_eval_profile
@@ -13,6 +13,7 @@
 
 #include "NOD_geometry_exec.hh"
 #include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_profile.hh"
 #include "NOD_multi_function.hh"
 #include "NOD_node_declaration.hh"
 
@@ -169,10 +170,25 @@ class LazyFunctionForGeometryNode : public LazyFunction {
                                  lf_input_for_output_bsocket_usage_,
                                  lf_input_for_attribute_propagation_to_output_};
 
+    const bool use_profile = geo_eval_profile::is_enabled();
+    geo_eval_profile::NodeExecutionStart profile_start;
+    if (use_profile) {
+      profile_start = geo_eval_profile::node_execution_begin();
+    }
+
     geo_eval_log::TimePoint start_time = geo_eval_log::Clock::now();
     node_.typeinfo->geometry_node_execute(geo_params);
     geo_eval_log::TimePoint end_time = geo_eval_log::Clock::now();
 
+    if (use_profile) {
+      geo_eval_profile::node_execution_end(profile_start,
+                                           start_time,
+                                           end_time,
+                                           node_,
+                                           *user_data->modifier_data,
+                                           geo_params.output_elements_num());
+    }
+
     if (geo_eval_log::GeoModifierLog *modifier_log = user_data->modifier_data->eval_log) {
       geo_eval_log::GeoTreeLogger &tree_logger = modifier_log->get_local_tree_logger(
           *user_data->compute_context);
@@ -0,0 +1,359 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+#ifdef WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <ctime>
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_map.hh"
+#include "BLI_path_util.h"
+#include "BLI_serialize.hh"
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
+
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_blender.h"
+#include "BKE_geometry_set.hh"
+
+#include "DEG_depsgraph_query.h"
+
+#include "NOD_geometry.h"
+#include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_profile.hh"
+
+namespace blender::nodes::geo_eval_profile {
+
+struct ThreadProfile {
+  /** Small number that identifies the thread in the exported trace. */
+  int thread_index;
+  Vector<NodeSample> samples;
+};
+
+struct Profile {
+  std::string filepath;
+  /** Trace timestamps are relative to this time. */
+  TimePoint start_time = Clock::now();
+  std::atomic<int> threads_num = 0;
+  threading::EnumerableThreadSpecific<ThreadProfile> thread_profiles{[&]() {
+    return ThreadProfile{threads_num.fetch_add(1, std::memory_order_relaxed), {}};
+  }};
+};
+
+static std::atomic<bool> profiling_enabled = false;
+static std::unique_ptr<Profile> global_profile;
+static bool atexit_registered = false;
+
+static void write_profile_at_exit(void * /*user_data*/)
+{
+  profiling_enabled = false;
+  if (!global_profile) {
+    return;
+  }
+  if (write(global_profile->filepath)) {
+    printf("Geometry nodes profile written to \"%s\"\n", global_profile->filepath.c_str());
+  }
+  else {
+    printf("Error: could not write geometry nodes profile to \"%s\"\n",
+           global_profile->filepath.c_str());
+  }
+  /* Free the samples before the memory leak detection runs. */
+  global_profile.reset();
+}
+
+void enable(const StringRefNull filepath)
+{
+  if (global_profile) {
+    global_profile->filepath = filepath;
+    return;
+  }
+  global_profile = std::make_unique<Profile>();
+  global_profile->filepath = filepath;
+  if (!atexit_registered) {
+    BKE_blender_atexit_register(write_profile_at_exit, nullptr);
+    atexit_registered = true;
+  }
+  profiling_enabled = true;
+}
+
+bool is_enabled()
+{
+  return profiling_enabled.load(std::memory_order_relaxed);
+}
+
+void disable()
+{
+  profiling_enabled = false;
+  global_profile.reset();
+}
+
+void add_sample(NodeSample sample)
+{
+  BLI_assert(global_profile);
+  global_profile->thread_profiles.local().samples.append(std::move(sample));
+}
+
+/**
+ * CPU time used by the calling thread. Work that a node does in other threads (e.g. in a
+ * #threading::parallel_for) is not included, so comparing it with the wall time gives an idea of
+ * how much the node benefits from multi-threading.
+ */
+static std::chrono::nanoseconds get_thread_cpu_time()
+{
+#ifdef WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    return std::chrono::nanoseconds(0);
+  }
+  /* The times are given in 100 nanosecond intervals. */
+  const uint64_t kernel = (uint64_t(kernel_time.dwHighDateTime) << 32) | kernel_time.dwLowDateTime;
+  const uint64_t user = (uint64_t(user_time.dwHighDateTime) << 32) | user_time.dwLowDateTime;
+  return std::chrono::nanoseconds((kernel + user) * 100);
+#else
+  timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#endif
+}
+
+NodeExecutionStart node_execution_begin()
+{
+  NodeExecutionStart start;
+  start.cpu_time = get_thread_cpu_time();
+  start.thread_memory_in_use = MEM_get_thread_memory_in_use();
+  return start;
+}
+
+void node_execution_end(const NodeExecutionStart &start,
+                        const TimePoint start_time,
+                        const TimePoint end_time,
+                        const bNode &node,
+                        const GeoNodesModifierData &modifier_data,
+                        const int64_t elements_num)
+{
+  const std::chrono::nanoseconds cpu_time = get_thread_cpu_time() - start.cpu_time;
+  /* Only counts the executing thread, so nodes that are evaluated at the same time on other
+   * threads don't affect each other. Reading the counter does not lock. */
+  const int64_t memory_delta = MEM_get_thread_memory_in_use() - start.thread_memory_in_use;
+
+  NodeSample sample;
+  sample.object_name = modifier_data.self_object ? modifier_data.self_object->id.name + 2 : "";
+  sample.tree_name = node.owner_tree().id.name + 2;
+  sample.node_name = node.name;
+  sample.frame = modifier_data.depsgraph ? DEG_get_ctime(modifier_data.depsgraph) : 0.0f;
+  sample.start = start_time;
+  sample.end = end_time;
+  sample.cpu_time = cpu_time;
+  sample.memory_delta = memory_delta;
+  sample.elements_num = elements_num;
+  add_sample(std::move(sample));
+}
+
+int64_t geometry_elements_num(const GeometrySet &geometry)
+{
+  int64_t elements_num = 0;
+  for (const GeometryComponentType type :
+       {GEO_COMPONENT_TYPE_MESH, GEO_COMPONENT_TYPE_CURVE, GEO_COMPONENT_TYPE_POINT_CLOUD}) {
+    if (const GeometryComponent *component = geometry.get_component_for_read(type)) {
+      elements_num += component->attribute_domain_size(ATTR_DOMAIN_POINT);
+    }
+  }
+  if (const InstancesComponent *component =
+          geometry.get_component_for_read<InstancesComponent>()) {
+    elements_num += component->attribute_domain_size(ATTR_DOMAIN_INSTANCE);
+  }
+  return elements_num;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Export
+ * \{ */
+
+using namespace io::serialize;
+
+/** Totals of all samples of a node, used to rank the nodes in the exported file. */
+struct NodeStatistics {
+  StringRefNull tree_name;
+  StringRefNull node_name;
+  int64_t samples_num = 0;
+  std::chrono::nanoseconds wall_time{0};
+  std::chrono::nanoseconds max_wall_time{0};
+  std::chrono::nanoseconds cpu_time{0};
+  int64_t memory_delta = 0;
+  int64_t elements_num = 0;
+  Set<int> thread_indices;
+  Set<float> frames;
+};
+
+static double to_microseconds(const std::chrono::nanoseconds duration)
+{
+  return double(duration.count()) / 1000.0;
+}
+
+static void add_metadata_event(ArrayValue::Items &events,
+                               const StringRefNull name,
+                               const int thread_index,
+                               const StringRefNull value)
+{
+  DictionaryValue *event = new DictionaryValue();
+  DictionaryValue::Items &attributes = event->elements();
+  attributes.append_as(std::pair("name", new StringValue(name)));
+  attributes.append_as(std::pair("ph", new StringValue("M")));
+  attributes.append_as(std::pair("pid", new IntValue(0)));
+  attributes.append_as(std::pair("tid", new IntValue(thread_index)));
+  DictionaryValue *args = new DictionaryValue();
+  args->elements().append_as(std::pair("name", new StringValue(value)));
+  attributes.append_as(std::pair("args", args));
+  events.append_as(event);
+}
+
+static void add_sample_event(ArrayValue::Items &events,
+                             const NodeSample &sample,
+                             const int thread_index,
+                             const TimePoint profile_start_time)
+{
+  DictionaryValue *event = new DictionaryValue();
+  DictionaryValue::Items &attributes = event->elements();
+  attributes.append_as(std::pair("name", new StringValue(sample.node_name)));
+  attributes.append_as(std::pair("cat", new StringValue(sample.tree_name)));
+  attributes.append_as(std::pair("ph", new StringValue("X")));
+  attributes.append_as(std::pair("pid", new IntValue(0)));
+  attributes.append_as(std::pair("tid", new IntValue(thread_index)));
+  attributes.append_as(
+      std::pair("ts", new DoubleValue(to_microseconds(sample.start - profile_start_time))));
+  attributes.append_as(
+      std::pair("dur", new DoubleValue(to_microseconds(sample.end - sample.start))));
+
+  DictionaryValue *args = new DictionaryValue();
+  DictionaryValue::Items &arg_items = args->elements();
+  arg_items.append_as(std::pair("object", new StringValue(sample.object_name)));
+  arg_items.append_as(std::pair("frame", new DoubleValue(sample.frame)));
+  arg_items.append_as(std::pair("cpu_time_us", new DoubleValue(to_microseconds(sample.cpu_time))));
+  arg_items.append_as(std::pair("memory_delta", new IntValue(sample.memory_delta)));
+  arg_items.append_as(std::pair("elements", new IntValue(sample.elements_num)));
+  attributes.append_as(std::pair("args", args));
+  events.append_as(event);
+}
+
+static void add_node_statistics(ArrayValue::Items &items, const NodeStatistics &statistics)
+{
+  DictionaryValue *item = new DictionaryValue();
+  DictionaryValue::Items &attributes = item->elements();
+  attributes.append_as(std::pair("tree", new StringValue(statistics.tree_name)));
+  attributes.append_as(std::pair("node", new StringValue(statistics.node_name)));
+  attributes.append_as(std::pair("samples", new IntValue(statistics.samples_num)));
+  attributes.append_as(std::pair("frames", new IntValue(statistics.frames.size())));
+  attributes.append_as(std::pair("threads", new IntValue(statistics.thread_indices.size())));
+  attributes.append_as(
+      std::pair("wall_time_us", new DoubleValue(to_microseconds(statistics.wall_time))));
+  attributes.append_as(
+      std::pair("max_wall_time_us", new DoubleValue(to_microseconds(statistics.max_wall_time))));
+  attributes.append_as(
+      std::pair("cpu_time_us", new DoubleValue(to_microseconds(statistics.cpu_time))));
+  attributes.append_as(std::pair("memory_delta", new IntValue(statistics.memory_delta)));
+  attributes.append_as(std::pair("elements", new IntValue(statistics.elements_num)));
+  items.append_as(item);
+}
+
+bool write(const StringRefNull filepath)
+{
+  if (!global_profile) {
+    return false;
+  }
+  const Profile &profile = *global_profile;
+
+  DictionaryValue root;
+  DictionaryValue::Items &root_attributes = root.elements();
+
+  ArrayValue *events = new ArrayValue();
+  add_metadata_event(events->elements(), "process_name", 0, "Geometry Nodes");
+
+  /* Nodes with the same name in the same node group are accumulated, even when the group is used
+   * in different places or by different objects. */
+  Map<std::pair<StringRefNull, StringRefNull>, NodeStatistics> statistics_by_node;
+
+  for (const ThreadProfile &thread_profile : global_profile->thread_profiles) {
+    const int thread_index = thread_profile.thread_index;
+    add_metadata_event(events->elements(),
+                       "thread_name",
+                       thread_index,
+                       "Thread " + std::to_string(thread_index));
+
+    for (const NodeSample &sample : thread_profile.samples) {
+      add_sample_event(events->elements(), sample, thread_index, profile.start_time);
+
+      NodeStatistics &statistics = statistics_by_node.lookup_or_add_cb(
+          {sample.tree_name, sample.node_name}, [&]() {
+            NodeStatistics statistics;
+            statistics.tree_name = sample.tree_name;
+            statistics.node_name = sample.node_name;
+            return statistics;
+          });
+      const std::chrono::nanoseconds wall_time = sample.end - sample.start;
+      statistics.samples_num++;
+      statistics.wall_time += wall_time;
+      if (wall_time > statistics.max_wall_time) {
+        statistics.max_wall_time = wall_time;
+      }
+      statistics.cpu_time += sample.cpu_time;
+      statistics.memory_delta += sample.memory_delta;
+      statistics.elements_num += sample.elements_num;
+      statistics.thread_indices.add(thread_index);
+      statistics.frames.add(sample.frame);
+    }
+  }
+  root_attributes.append_as(std::pair("traceEvents", events));
+  root_attributes.append_as(std::pair("displayTimeUnit", new StringValue("ms")));
+
+  /* Sort by total wall time, so that the most expensive nodes come first. */
+  Vector<const NodeStatistics *> sorted_statistics;
+  for (const NodeStatistics &statistics : statistics_by_node.values()) {
+    sorted_statistics.append(&statistics);
+  }
+  std::sort(sorted_statistics.begin(),
+            sorted_statistics.end(),
+            [](const NodeStatistics *a, const NodeStatistics *b) {
+              return a->wall_time > b->wall_time;
+            });
+  ArrayValue *statistics_items = new ArrayValue();
+  for (const NodeStatistics *statistics : sorted_statistics) {
+    add_node_statistics(statistics_items->elements(), *statistics);
+  }
+  root_attributes.append_as(std::pair("nodeStatistics", statistics_items));
+
+  if (!BLI_make_existing_file(filepath.c_str())) {
+    return false;
+  }
+  std::ofstream os;
+  os.open(filepath.c_str(), std::ios::out | std::ios::trunc);
+  if (!os) {
+    return false;
+  }
+  JsonFormatter formatter;
+  formatter.serialize(os, root);
+  os.close();
+  return !os.fail();
+}
+
+/** \} */
+
+}  // namespace blender::nodes::geo_eval_profile
+
+void NOD_geometry_nodes_profile_enable(const char *filepath)
+{
+  blender::nodes::geo_eval_profile::enable(filepath);
+}
@@ -8,6 +8,7 @@
 #include "BKE_type_conversions.hh"
 
 #include "NOD_geometry_exec.hh"
+#include "NOD_geometry_nodes_profile.hh"
 
 #include "BLI_hash_md5.h"
 
@@ -142,6 +143,13 @@ void GeoNodeExecParams::check_output_geometry_set(const GeometrySet &geometry_se
 #endif
 }
 
+void GeoNodeExecParams::count_output_elements(const GeometrySet &geometry_set)
+{
+  if (geo_eval_profile::is_enabled()) {
+    output_elements_num_ += geo_eval_profile::geometry_elements_num(geometry_set);
+  }
+}
+
 const bNodeSocket *GeoNodeExecParams::find_available_socket(const StringRef name) const
 {
   for (const bNodeSocket *socket : node_.input_sockets()) {
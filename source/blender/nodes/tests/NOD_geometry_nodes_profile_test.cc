@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <fstream>
+#include <thread>
+
+#include "testing/testing.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_serialize.hh"
+
+#include "BKE_appdir.h"
+
+#include "NOD_geometry_nodes_profile.hh"
+
+namespace blender::nodes::geo_eval_profile::tests {
+
+using namespace io::serialize;
+using namespace std::chrono_literals;
+
+class geometry_nodes_profile_test : public testing::Test {
+ protected:
+  std::string filepath_;
+
+  static void SetUpTestSuite()
+  {
+    BKE_tempdir_init(nullptr);
+  }
+
+  static void TearDownTestSuite()
+  {
+    BKE_tempdir_session_purge();
+  }
+
+  void SetUp() override
+  {
+    char filepath[FILE_MAX];
+    BLI_path_join(filepath, sizeof(filepath), BKE_tempdir_session(), "profile.json");
+    filepath_ = filepath;
+    enable(filepath_);
+  }
+
+  void TearDown() override
+  {
+    disable();
+    BLI_delete(filepath_.c_str(), false, false);
+  }
+
+  std::unique_ptr<Value> write_and_read()
+  {
+    EXPECT_TRUE(write(filepath_));
+    std::ifstream is(filepath_);
+    JsonFormatter formatter;
+    return formatter.deserialize(is);
+  }
+};
+
+static NodeSample create_sample(const StringRefNull tree_name,
+                                const StringRefNull node_name,
+                                const float frame,
+                                const std::chrono::nanoseconds wall_time,
+                                const int64_t memory_delta,
+                                const int64_t elements_num)
+{
+  NodeSample sample;
+  sample.object_name = "Object";
+  sample.tree_name = tree_name;
+  sample.node_name = node_name;
+  sample.frame = frame;
+  sample.start = Clock::now();
+  sample.end = sample.start + wall_time;
+  sample.cpu_time = wall_time / 2;
+  sample.memory_delta = memory_delta;
+  sample.elements_num = elements_num;
+  return sample;
+}
+
+static const DictionaryValue::Lookup lookup(const Value &value)
+{
+  const DictionaryValue *dictionary = value.as_dictionary_value();
+  EXPECT_NE(dictionary, nullptr);
+  return dictionary->create_lookup();
+}
+
+static int64_t int_value(const DictionaryValue::Lookup &lookup, const StringRef key)
+{
+  return lookup.lookup_as(key)->as_int_value()->value();
+}
+
+static double double_value(const DictionaryValue::Lookup &lookup, const StringRef key)
+{
+  return lookup.lookup_as(key)->as_double_value()->value();
+}
+
+static std::string string_value(const DictionaryValue::Lookup &lookup, const StringRef key)
+{
+  return lookup.lookup_as(key)->as_string_value()->value();
+}
+
+TEST_F(geometry_nodes_profile_test, node_statistics)
+{
+  EXPECT_TRUE(is_enabled());
+  add_sample(create_sample("Tree", "Node A", 1.0f, 3ms, 100, 10));
+  add_sample(create_sample("Tree", "Node A", 2.0f, 1ms, -40, 20));
+  add_sample(create_sample("Other Tree", "Node A", 1.0f, 500us, 0, 0));
+  std::thread thread([]() {
+    add_sample(create_sample("Tree", "Node B", 1.0f, 5ms, 1000, 30));
+    add_sample(create_sample("Tree", "Node A", 1.0f, 2ms, 8, 5));
+  });
+  thread.join();
+
+  const std::unique_ptr<Value> root = this->write_and_read();
+  ASSERT_NE(root, nullptr);
+  const DictionaryValue::Lookup root_lookup = lookup(*root);
+  EXPECT_EQ(string_value(root_lookup, "displayTimeUnit"), "ms");
+
+  /* One process name, two thread names and all samples. */
+  const ArrayValue *events = root_lookup.lookup_as("traceEvents")->as_array_value();
+  ASSERT_NE(events, nullptr);
+  EXPECT_EQ(events->elements().size(), 8);
+  int64_t sample_events_num = 0;
+  for (const std::shared_ptr<Value> &event : events->elements()) {
+    const DictionaryValue::Lookup event_lookup = lookup(*event);
+    if (string_value(event_lookup, "ph") != "X") {
+      continue;
+    }
+    sample_events_num++;
+    if (string_value(event_lookup, "name") == "Node B") {
+      EXPECT_EQ(string_value(event_lookup, "cat"), "Tree");
+      EXPECT_DOUBLE_EQ(double_value(event_lookup, "dur"), 5000.0);
+      const DictionaryValue::Lookup args = lookup(*event_lookup.lookup_as("args"));
+      EXPECT_EQ(string_value(args, "object"), "Object");
+      EXPECT_DOUBLE_EQ(double_value(args, "cpu_time_us"), 2500.0);
+      EXPECT_EQ(int_value(args, "memory_delta"), 1000);
+      EXPECT_EQ(int_value(args, "elements"), 30);
+    }
+  }
+  EXPECT_EQ(sample_events_num, 5);
+
+  /* Nodes are accumulated per node group and sorted by total wall time. */
+  const ArrayValue *statistics = root_lookup.lookup_as("nodeStatistics")->as_array_value();
+  ASSERT_NE(statistics, nullptr);
+  ASSERT_EQ(statistics->elements().size(), 3);
+
+  const DictionaryValue::Lookup node_a = lookup(*statistics->elements()[0]);
+  EXPECT_EQ(string_value(node_a, "tree"), "Tree");
+  EXPECT_EQ(string_value(node_a, "node"), "Node A");
+  EXPECT_EQ(int_value(node_a, "samples"), 3);
+  EXPECT_EQ(int_value(node_a, "frames"), 2);
+  EXPECT_EQ(int_value(node_a, "threads"), 2);
+  EXPECT_DOUBLE_EQ(double_value(node_a, "wall_time_us"), 6000.0);
+  EXPECT_DOUBLE_EQ(double_value(node_a, "max_wall_time_us"), 3000.0);
+  EXPECT_DOUBLE_EQ(double_value(node_a, "cpu_time_us"), 3000.0);
+  EXPECT_EQ(int_value(node_a, "memory_delta"), 68);
+  EXPECT_EQ(int_value(node_a, "elements"), 35);
+
+  const DictionaryValue::Lookup node_b = lookup(*statistics->elements()[1]);
+  EXPECT_EQ(string_value(node_b, "node"), "Node B");
+  EXPECT_EQ(int_value(node_b, "samples"), 1);
+  EXPECT_EQ(int_value(node_b, "threads"), 1);
+  EXPECT_DOUBLE_EQ(double_value(node_b, "wall_time_us"), 5000.0);
+
+  const DictionaryValue::Lookup other_node_a = lookup(*statistics->elements()[2]);
+  EXPECT_EQ(string_value(other_node_a, "tree"), "Other Tree");
+  EXPECT_EQ(string_value(other_node_a, "node"), "Node A");
+  EXPECT_EQ(int_value(other_node_a, "samples"), 1);
+  EXPECT_DOUBLE_EQ(double_value(other_node_a, "wall_time_us"), 500.0);
+}
+
+TEST_F(geometry_nodes_profile_test, empty)
+{
+  const std::unique_ptr<Value> root = this->write_and_read();
+  ASSERT_NE(root, nullptr);
+  const DictionaryValue::Lookup root_lookup = lookup(*root);
+  /* Only the process name. */
+  EXPECT_EQ(root_lookup.lookup_as("traceEvents")->as_array_value()->elements().size(), 1);
+  EXPECT_EQ(root_lookup.lookup_as("nodeStatistics")->as_array_value()->elements().size(), 0);
+}
+
+TEST_F(geometry_nodes_profile_test, disable)
+{
+  add_sample(create_sample("Tree", "Node", 1.0f, 1ms, 0, 0));
+  disable();
+  EXPECT_FALSE(is_enabled());
+  /* The samples are discarded. */
+  EXPECT_FALSE(write(filepath_));
+}
+
+}  // namespace blender::nodes::geo_eval_profile::tests
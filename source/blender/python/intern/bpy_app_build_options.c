@@ -45,6 +45,7 @@ static PyStructSequence_Field app_builtopts_info_fields[] = {
     {"collada", NULL},
     {"io_wavefront_obj", NULL},
     {"io_stl", NULL},
+    {"io_ply", NULL},
     {"io_gpencil", NULL},
     {"opencolorio", NULL},
     {"openmp", NULL},
@@ -266,6 +267,12 @@ static PyObject *make_builtopts_info(void)
   SetObjIncref(Py_False);
 #endif
 
+#ifdef WITH_IO_PLY
+  SetObjIncref(Py_True);
+#else
+  SetObjIncref(Py_False);
+#endif
+
 #ifdef WITH_IO_GPENCIL
   SetObjIncref(Py_True);
 #else
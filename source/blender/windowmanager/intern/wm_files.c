@@ -1957,32 +1957,93 @@ static void wm_autosave_location(char filepath[FILE_MAX])
   BLI_path_join(filepath, FILE_MAX, tempdir_base, path);
 }
 
+/**
+ * When the undo memfile is used, autosave only takes a snapshot of it on the main thread. Writing
+ * it to disk is done on a background thread so editing can continue in the meantime.
+ */
+typedef struct AutosaveWriteJob {
+  char filepath[FILE_MAX];
+  /** Shares the chunk buffers of the undo step, which stay valid when the step is freed. */
+  MemFile memfile;
+  /** Set by the thread when writing finished, protected by #autosave_job_mutex. */
+  bool is_done;
+} AutosaveWriteJob;
+
+static ListBase autosave_threads = {NULL, NULL};
+static AutosaveWriteJob *autosave_job = NULL;
+static ThreadMutex autosave_job_mutex = BLI_MUTEX_INITIALIZER;
+
+static void *wm_autosave_write_thread(void *job_v)
+{
+  AutosaveWriteJob *job = job_v;
+
+  BLO_memfile_write_file(&job->memfile, job->filepath);
+
+  BLI_mutex_lock(&autosave_job_mutex);
+  job->is_done = true;
+  BLI_mutex_unlock(&autosave_job_mutex);
+  return NULL;
+}
+
+static bool wm_autosave_write_is_running(void)
+{
+  if (autosave_job == NULL) {
+    return false;
+  }
+  BLI_mutex_lock(&autosave_job_mutex);
+  const bool is_done = autosave_job->is_done;
+  BLI_mutex_unlock(&autosave_job_mutex);
+  return !is_done;
+}
+
+/** Wait for the background write to finish and free its data. */
+static void wm_autosave_write_wait(void)
+{
+  if (autosave_job == NULL) {
+    return;
+  }
+  BLI_threadpool_end(&autosave_threads);
+  BLO_memfile_free(&autosave_job->memfile);
+  MEM_freeN(autosave_job);
+  autosave_job = NULL;
+}
+
 static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
 {
-  char filepath[FILE_MAX];
+  wm_autosave_write_wait();
 
+  char filepath[FILE_MAX];
   wm_autosave_location(filepath);
 
   /* Fast save of last undo-buffer, now with UI. */
   const bool use_memfile = (U.uiflag & USER_GLOBALUNDO) != 0;
   MemFile *memfile = use_memfile ? ED_undosys_stack_memfile_get_active(wm->undo_stack) : NULL;
   if (memfile != NULL) {
-    BLO_memfile_write_file(memfile, filepath);
+    AutosaveWriteJob *job = MEM_callocN(sizeof(*job), __func__);
+    STRNCPY(job->filepath, filepath);
+    /* Undo steps may be freed while writing, the snapshot keeps its own references to the chunk
+     * buffers instead of copying them. */
+    BLO_memfile_share(memfile, &job->memfile);
+
+    autosave_job = job;
+    BLI_threadpool_init(&autosave_threads, wm_autosave_write_thread, 1);
+    BLI_threadpool_insert(&autosave_threads, job);
+    return;
   }
-  else {
-    if (use_memfile) {
-      /* This is very unlikely, alert developers of this unexpected case. */
-      CLOG_WARN(&LOG, "undo-data not found for writing, fallback to regular file write!");
-    }
 
-    /* Save as regular blend file with recovery information. */
-    const int fileflags = (G.fileflags & ~G_FILE_COMPRESS) | G_FILE_RECOVER_WRITE;
+  if (use_memfile) {
+    /* This is very unlikely, alert developers of this unexpected case. */
+    CLOG_WARN(&LOG, "undo-data not found for writing, fallback to regular file write!");
+  }
 
-    ED_editors_flush_edits(bmain);
+  /* Save as regular blend file with recovery information. This is done on the main thread,
+   * because writing a file (unlike an undo step) modifies Main, e.g. to tag linked IDs. */
+  const int fileflags = (G.fileflags & ~G_FILE_COMPRESS) | G_FILE_RECOVER_WRITE;
 
-    /* Error reporting into console. */
-    BLO_write_file(bmain, filepath, fileflags, &(const struct BlendFileWriteParams){0}, NULL);
-  }
+  ED_editors_flush_edits(bmain);
+
+  /* Error reporting into console. */
+  BLO_write_file(bmain, filepath, fileflags, &(const struct BlendFileWriteParams){0}, NULL);
 }
 
 static void wm_autosave_timer_begin_ex(wmWindowManager *wm, double timestep)
@@ -2030,6 +2091,12 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
     }
   }
 
+  /* The previous autosave is still being written, try again later. */
+  if (wm_autosave_write_is_running()) {
+    wm_autosave_timer_begin_ex(wm, 10.0);
+    return;
+  }
+
   wm_autosave_write(bmain, wm);
 
   /* Restart the timer after file write, just in case file write takes a long time. */
@@ -2040,6 +2107,8 @@ void wm_autosave_delete(void)
 {
   char filepath[FILE_MAX];
 
+  wm_autosave_write_wait();
+
   wm_autosave_location(filepath);
 
   if (BLI_exists(filepath)) {
@@ -44,6 +44,8 @@
 
 #  include "GPU_context.h"
 
+#  include "NOD_geometry.h"
+
 #  ifdef WITH_FFMPEG
 #    include "IMB_imbuf.h"
 #  endif
@@ -592,6 +594,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 
   printf("\n");
   BLI_args_print_arg_doc(ba, "--debug-fpe");
+  BLI_args_print_arg_doc(ba, "--profile-geometry-nodes");
   BLI_args_print_arg_doc(ba, "--debug-exit-on-error");
   BLI_args_print_arg_doc(ba, "--disable-crash-handler");
   BLI_args_print_arg_doc(ba, "--disable-abort-handler");
@@ -1166,6 +1169,24 @@ static int arg_handle_debug_fpe_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_profile_geometry_nodes_set_doc[] =
+    "<filepath>\n"
+    "\tProfile all geometry nodes evaluations and write the timings to a file on exit.\n"
+    "\tThe file uses the Chrome trace format and also contains per-node totals.";
+static int arg_handle_profile_geometry_nodes_set(int argc, const char **argv, void *UNUSED(data))
+{
+  const char *arg_id = "--profile-geometry-nodes";
+  if (argc > 1) {
+    char filepath[FILE_MAX];
+    BLI_strncpy(filepath, argv[1], sizeof(filepath));
+    BLI_path_abs_from_cwd(filepath, sizeof(filepath));
+    NOD_geometry_nodes_profile_enable(filepath);
+    return 1;
+  }
+  printf("\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_app_template_doc[] =
     "<template>\n"
     "\tSet the application template (matching the directory name), use 'default' for none.";
@@ -2207,6 +2228,11 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_args_add(ba, NULL, "--debug-io", CB(arg_handle_debug_mode_io), NULL);
 
   BLI_args_add(ba, NULL, "--debug-fpe", CB(arg_handle_debug_fpe_set), NULL);
+  BLI_args_add(ba,
+               NULL,
+               "--profile-geometry-nodes",
+               CB(arg_handle_profile_geometry_nodes_set),
+               NULL);
 
 #  ifdef WITH_LIBMV
   BLI_args_add(ba, NULL, "--debug-libmv", CB(arg_handle_debug_mode_libmv), NULL);